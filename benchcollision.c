@@ -0,0 +1,179 @@
+/*--------------------------------------------------------------------*/
+/* benchcollision.c                                                   */
+/* Author: Arnold Jiang                                               */
+/*--------------------------------------------------------------------*/
+
+#include "symtable.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*--------------------------------------------------------------------*/
+
+enum {KEY_LENGTH = 5, FIRST_CHAR = '!', LAST_CHAR = '~'};
+
+/* A table grows from SMALLER_BUCKETS to TARGET_BUCKETS buckets when
+   it is about to hold more than SMALLER_BUCKETS bindings. An attacker
+   who knows the growth schedule in symtablehash.c knows both. */
+
+enum {SMALLER_BUCKETS = 16381, TARGET_BUCKETS = 32749};
+
+/*--------------------------------------------------------------------*/
+
+/* Return the hash code that the unseeded polynomial hash function,
+   h = h * 65599 + c, gives the KEY_LENGTH characters at pcKey. This
+   is the attacker's model of SymTable_hashKey(). */
+
+static size_t polynomialHash(const char *pcKey)
+{
+   size_t uHash = 0;
+   int i;
+
+   for (i = 0; i < KEY_LENGTH; i++)
+      uHash = uHash * 65599 + (size_t)pcKey[i];
+   return uHash;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Fill pacKeys with iKeyCount distinct keys of printable characters
+   whose polynomial hash codes are all 0 modulo TARGET_BUCKETS, so
+   that an unseeded table with that many buckets chains every one of
+   them into a single bucket. */
+
+static void craftKeys(char (*pacKeys)[KEY_LENGTH + 1], int iKeyCount)
+{
+   char acKey[KEY_LENGTH + 1];
+   int iFound = 0;
+   int i;
+
+   for (i = 0; i < KEY_LENGTH; i++)
+      acKey[i] = FIRST_CHAR;
+   acKey[KEY_LENGTH] = '\0';
+
+   while (iFound < iKeyCount)
+   {
+      /* The last character alone moves the code by at most
+         LAST_CHAR - FIRST_CHAR, so try every value of it. */
+      for (acKey[KEY_LENGTH - 1] = FIRST_CHAR;
+           acKey[KEY_LENGTH - 1] <= LAST_CHAR && iFound < iKeyCount;
+           acKey[KEY_LENGTH - 1]++)
+         if (polynomialHash(acKey) % TARGET_BUCKETS == 0)
+            strcpy(pacKeys[iFound++], acKey);
+
+      /* Advance the other characters like an odometer. */
+      for (i = KEY_LENGTH - 2; i >= 0 && acKey[i] == LAST_CHAR; i--)
+         acKey[i] = FIRST_CHAR;
+      if (i < 0)
+      {
+         fprintf(stderr, "too many keys requested\n");
+         exit(EXIT_FAILURE);
+      }
+      acKey[i]++;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Fill pacKeys with iKeyCount distinct keys of printable characters
+   chosen without regard to any hash function. */
+
+static void plainKeys(char (*pacKeys)[KEY_LENGTH + 1], int iKeyCount)
+{
+   int i;
+
+   for (i = 0; i < iKeyCount; i++)
+      sprintf(pacKeys[i], "%05d", i);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the CPU time consumed so far, in seconds. */
+
+static double cpuSeconds(void)
+{
+   return (double)clock() / CLOCKS_PER_SEC;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Put the iKeyCount keys in pacKeys into a new SymTable, and then get
+   iGetCount of them in turn. Write the CPU time consumed by each
+   phase to stdout, labelled with pcLabel. */
+
+static void run(const char *pcLabel, char (*pacKeys)[KEY_LENGTH + 1],
+   int iKeyCount, int iGetCount)
+{
+   SymTable_T oSymTable;
+   double dPutSeconds;
+   double dGetSeconds;
+   int iFound = 0;
+   int i;
+
+   oSymTable = SymTable_new();
+   if (oSymTable == NULL)
+   {
+      fprintf(stderr, "insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+
+   dPutSeconds = cpuSeconds();
+   for (i = 0; i < iKeyCount; i++)
+      (void)SymTable_put(oSymTable, pacKeys[i], pacKeys[i]);
+   dPutSeconds = cpuSeconds() - dPutSeconds;
+
+   dGetSeconds = cpuSeconds();
+   for (i = 0; i < iGetCount; i++)
+      if (SymTable_get(oSymTable, pacKeys[i % iKeyCount]) != NULL)
+         iFound++;
+   dGetSeconds = cpuSeconds() - dGetSeconds;
+
+   printf("%s keys: puts %f seconds, gets %f seconds\n", pcLabel,
+      dPutSeconds, dGetSeconds);
+   if (iFound != iGetCount)
+      printf("Only %d of the gets found their key.\n", iFound);
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Compare a SymTable filled with ordinary keys against one filled
+   with keys crafted to collide under an unseeded polynomial hash.
+   With a seeded hash both take about the same time. argv[1] and
+   argv[2], if present, are the number of keys and of gets; the key
+   count must leave the table at TARGET_BUCKETS buckets. */
+
+int main(int argc, char *argv[])
+{
+   char (*pacKeys)[KEY_LENGTH + 1];
+   int iKeyCount = 30000;
+   int iGetCount = 30000;
+
+   if ((argc > 1 && sscanf(argv[1], "%d", &iKeyCount) != 1) ||
+       (argc > 2 && sscanf(argv[2], "%d", &iGetCount) != 1) ||
+       iKeyCount <= SMALLER_BUCKETS || iKeyCount > TARGET_BUCKETS ||
+       iGetCount < 0)
+   {
+      fprintf(stderr, "usage: %s [keys (%d-%d)] [gets]\n", argv[0],
+         SMALLER_BUCKETS + 1, TARGET_BUCKETS);
+      exit(EXIT_FAILURE);
+   }
+
+   pacKeys = (char (*)[KEY_LENGTH + 1])
+      malloc((size_t)iKeyCount * (KEY_LENGTH + 1));
+   if (pacKeys == NULL)
+   {
+      fprintf(stderr, "insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+
+   printf("%d keys, %d gets\n", iKeyCount, iGetCount);
+   plainKeys(pacKeys, iKeyCount);
+   run("ordinary", pacKeys, iKeyCount, iGetCount);
+   craftKeys(pacKeys, iKeyCount);
+   run("colliding", pacKeys, iKeyCount, iGetCount);
+
+   free(pacKeys);
+   return 0;
+}
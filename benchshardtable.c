@@ -0,0 +1,158 @@
+/*--------------------------------------------------------------------*/
+/* benchshardtable.c                                                  */
+/* Author: Arnold Jiang                                               */
+/*--------------------------------------------------------------------*/
+
+/* clock_gettime() is POSIX */
+#define _POSIX_C_SOURCE 199309L
+
+#include "shardtable.h"
+#include "symtable.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+
+/*--------------------------------------------------------------------*/
+
+enum {MAX_WRITERS = 64, MAX_KEY_LENGTH = 24};
+
+/*--------------------------------------------------------------------*/
+
+/* The table that every writer of one run writes to: either a single
+   SymTable behind one mutex, or a ShardTable. */
+
+struct Target
+{
+   SymTable_T oSymTable;
+   pthread_mutex_t lock;
+   ShardTable_T oShardTable;
+};
+
+/* A Writer is one thread of a run. */
+
+struct Writer
+{
+   struct Target *psTarget;
+   int iWriter;
+   int iKeyCount;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return the wall-clock time in seconds. */
+
+static double now(void)
+{
+   struct timespec sTime;
+   (void)clock_gettime(CLOCK_MONOTONIC, &sTime);
+   return (double)sTime.tv_sec + (double)sTime.tv_nsec / 1e9;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Put the keys of the Writer that pvWriter points to into its
+   target. Return NULL. */
+
+static void *putKeys(void *pvWriter)
+{
+   struct Writer *psWriter = (struct Writer*)pvWriter;
+   struct Target *psTarget = psWriter->psTarget;
+   char acKey[MAX_KEY_LENGTH];
+   int i;
+
+   for (i = 0; i < psWriter->iKeyCount; i++)
+   {
+      sprintf(acKey, "%d.%d", psWriter->iWriter, i);
+      if (psTarget->oShardTable != NULL)
+         (void)ShardTable_put(psTarget->oShardTable, acKey, NULL);
+      else
+      {
+         (void)pthread_mutex_lock(&psTarget->lock);
+         (void)SymTable_put(psTarget->oSymTable, acKey, NULL);
+         (void)pthread_mutex_unlock(&psTarget->lock);
+      }
+   }
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Have iWriterCount threads put iKeyCount keys each into psTarget,
+   and return the wall-clock time that took. */
+
+static double run(struct Target *psTarget, int iWriterCount,
+   int iKeyCount)
+{
+   struct Writer asWriters[MAX_WRITERS];
+   pthread_t aThreads[MAX_WRITERS];
+   double dStart;
+   int i;
+
+   dStart = now();
+   for (i = 0; i < iWriterCount; i++)
+   {
+      asWriters[i].psTarget = psTarget;
+      asWriters[i].iWriter = i;
+      asWriters[i].iKeyCount = iKeyCount;
+      if (pthread_create(&aThreads[i], NULL, putKeys, &asWriters[i])
+         != 0)
+      {
+         fprintf(stderr, "cannot create thread\n");
+         exit(EXIT_FAILURE);
+      }
+   }
+   for (i = 0; i < iWriterCount; i++)
+      (void)pthread_join(aThreads[i], NULL);
+   return now() - dStart;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Time concurrent inserts into one mutex-guarded SymTable against a
+   ShardTable. argv[1], argv[2], and argv[3], if present, are the
+   number of writer threads, the number of keys each puts, and the
+   number of shards. */
+
+int main(int argc, char *argv[])
+{
+   struct Target sTarget;
+   int iWriterCount = 4;
+   int iKeyCount = 250000;
+   int iShardCount = 64;
+   double dSeconds;
+
+   if ((argc > 1 && sscanf(argv[1], "%d", &iWriterCount) != 1) ||
+       (argc > 2 && sscanf(argv[2], "%d", &iKeyCount) != 1) ||
+       (argc > 3 && sscanf(argv[3], "%d", &iShardCount) != 1) ||
+       iWriterCount < 1 || iWriterCount > MAX_WRITERS ||
+       iKeyCount < 0 || iShardCount < 1)
+   {
+      fprintf(stderr,
+         "usage: %s [writers (1-%d)] [keys per writer] [shards]\n",
+         argv[0], MAX_WRITERS);
+      exit(EXIT_FAILURE);
+   }
+
+   printf("%d writers putting %d keys each\n", iWriterCount, iKeyCount);
+
+   sTarget.oSymTable = SymTable_new();
+   sTarget.oShardTable = NULL;
+   if (sTarget.oSymTable == NULL ||
+       pthread_mutex_init(&sTarget.lock, NULL) != 0)
+      exit(EXIT_FAILURE);
+   dSeconds = run(&sTarget, iWriterCount, iKeyCount);
+   printf("one SymTable, one mutex: %f seconds\n", dSeconds);
+   (void)pthread_mutex_destroy(&sTarget.lock);
+   SymTable_free(sTarget.oSymTable);
+
+   sTarget.oSymTable = NULL;
+   sTarget.oShardTable = ShardTable_new((size_t)iShardCount);
+   if (sTarget.oShardTable == NULL)
+      exit(EXIT_FAILURE);
+   dSeconds = run(&sTarget, iWriterCount, iKeyCount);
+   printf("ShardTable, %d shards: %f seconds\n", iShardCount, dSeconds);
+   ShardTable_free(sTarget.oShardTable);
+
+   return 0;
+}
@@ -0,0 +1,227 @@
+/*--------------------------------------------------------------------*/
+/* benchsymtable.c                                                    */
+/* Author: Arnold Jiang                                               */
+/*--------------------------------------------------------------------*/
+
+/* sysconf() is not part of C99 */
+#define _POSIX_C_SOURCE 200112L
+
+#include "symtable.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/*--------------------------------------------------------------------*/
+
+enum {MAX_KEY_LENGTH = 48, KEYS_PER_MODULE = 1000,
+   MAX_TIMED_GETS = 1000000};
+
+/*--------------------------------------------------------------------*/
+
+/* Return a pseudo-random number after *puState, and advance
+   *puState. The generator is the same everywhere, unlike rand(), so
+   runs on different machines access keys in the same order. */
+
+static unsigned long nextRandom(unsigned long *puState)
+{
+   *puState = (*puState * 1103515245UL + 12345UL) & 0xFFFFFFFFUL;
+   return *puState >> 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the CPU time consumed so far, in seconds. */
+
+static double cpuSeconds(void)
+{
+   return (double)clock() / CLOCKS_PER_SEC;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the time on a clock that only moves forward, in
+   nanoseconds. */
+
+static long nanoseconds(void)
+{
+   struct timespec sTime;
+
+   (void)clock_gettime(CLOCK_MONOTONIC, &sTime);
+   return (long)sTime.tv_sec * 1000000000L + sTime.tv_nsec;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Compare the longs that pv1 and pv2 point to, for qsort(). */
+
+static int compareLongs(const void *pv1, const void *pv2)
+{
+   long l1 = *(const long*)pv1;
+   long l2 = *(const long*)pv2;
+
+   return (l1 > l2) - (l1 < l2);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of bytes of memory that the process has resident,
+   or 0 if the system does not say. */
+
+static double residentBytes(void)
+{
+   FILE *psFile;
+   unsigned long ulSize;
+   unsigned long ulResident;
+   int iRead;
+
+   psFile = fopen("/proc/self/statm", "r");
+   if (psFile == NULL)
+      return 0.0;
+   iRead = fscanf(psFile, "%lu %lu", &ulSize, &ulResident);
+   fclose(psFile);
+   if (iRead != 2)
+      return 0.0;
+   return (double)ulResident * (double)sysconf(_SC_PAGESIZE);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Put iBindingCount bindings into a SymTable, then get iGetCount
+   keys chosen at random among them, so that almost every get misses
+   the cache on a table much larger than it, then time up to
+   MAX_TIMED_GETS more gets one at a time, and then look for as many
+   keys that are not there. Write the CPU time consumed by each phase,
+   the median, 99.9th percentile and worst latency of the timed gets,
+   and the memory that the table takes per binding, to stdout.
+   argv[1] and argv[2], if present, are iBindingCount and iGetCount.
+   argv[3], if present, is "plain" for keys like "symbol42", or
+   "qualified" for keys like "org.example.shop.module0.Item42", which
+   share a prefix a thousand at a time. argv[4], if present, is
+   "compact" to build the table with SymTable_newCompact() rather than
+   SymTable_new(), or "filtered" to give it a filter with
+   SymTable_addFilter(). */
+
+int main(int argc, char *argv[])
+{
+   SymTable_T oSymTable;
+   char (*pacKeys)[MAX_KEY_LENGTH];
+   long *plLatencies;
+   long lStart;
+   unsigned long uState = 1;
+   unsigned long uFound = 0;
+   int iBindingCount = 1000000;
+   int iGetCount = 10000000;
+   int iQualified = 0;
+   int iCompact = 0;
+   int iFiltered = 0;
+   int iTimedCount;
+   double dStart;
+   double dBaseline;
+   double dResident;
+   int i;
+
+   if ((argc > 1 && sscanf(argv[1], "%d", &iBindingCount) != 1) ||
+       (argc > 2 && sscanf(argv[2], "%d", &iGetCount) != 1) ||
+       iBindingCount < 1 || iGetCount < 0 ||
+       (argc > 3 && strcmp(argv[3], "plain") != 0 &&
+          ! (iQualified = strcmp(argv[3], "qualified") == 0)) ||
+       (argc > 4 && ! (iCompact = strcmp(argv[4], "compact") == 0) &&
+          ! (iFiltered = strcmp(argv[4], "filtered") == 0)))
+   {
+      fprintf(stderr, "usage: %s [bindings] [gets] [plain|qualified] "
+         "[compact|filtered]\n", argv[0]);
+      exit(EXIT_FAILURE);
+   }
+
+   iTimedCount = iGetCount < MAX_TIMED_GETS ? iGetCount : MAX_TIMED_GETS;
+   pacKeys = (char (*)[MAX_KEY_LENGTH])
+      malloc((size_t)iBindingCount * MAX_KEY_LENGTH);
+   plLatencies = (long*)malloc(((size_t)iTimedCount + 1) * sizeof(long));
+   if (pacKeys == NULL || plLatencies == NULL)
+   {
+      fprintf(stderr, "insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+   for (i = 0; i < iBindingCount; i++)
+      if (iQualified)
+         sprintf(pacKeys[i], "org.example.shop.module%d.Item%d",
+            i / KEYS_PER_MODULE, i);
+      else
+         sprintf(pacKeys[i], "symbol%d", i);
+
+   /* The keys are resident before the table is made, so that only the
+      table's own memory is counted. */
+   dBaseline = residentBytes();
+   oSymTable = iCompact ? SymTable_newCompact() : SymTable_new();
+   if (oSymTable == NULL ||
+       (iFiltered && ! SymTable_addFilter(oSymTable)))
+   {
+      fprintf(stderr, "insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+
+   dStart = cpuSeconds();
+   for (i = 0; i < iBindingCount; i++)
+      (void)SymTable_put(oSymTable, pacKeys[i], pacKeys[i]);
+   printf("%d puts consumed %f seconds.\n", iBindingCount,
+      cpuSeconds() - dStart);
+   dResident = residentBytes();
+   if (dBaseline > 0.0 && dResident > 0.0)
+      printf("The table takes %.1f bytes per binding.\n",
+         (dResident - dBaseline) / iBindingCount);
+
+   dStart = cpuSeconds();
+   for (i = 0; i < iGetCount; i++)
+      if (SymTable_get(oSymTable,
+             pacKeys[nextRandom(&uState) % (unsigned long)iBindingCount])
+          != NULL)
+         uFound++;
+   printf("%d random gets consumed %f seconds.\n", iGetCount,
+      cpuSeconds() - dStart);
+
+   if (uFound != (unsigned long)iGetCount)
+      printf("Only %lu of the gets found their key.\n", uFound);
+
+   /* The tail, not the mean, is what a caller with a deadline sees. */
+   for (i = 0; i < iTimedCount; i++)
+   {
+      lStart = nanoseconds();
+      (void)SymTable_get(oSymTable,
+         pacKeys[nextRandom(&uState) % (unsigned long)iBindingCount]);
+      plLatencies[i] = nanoseconds() - lStart;
+   }
+   if (iTimedCount > 0)
+   {
+      qsort(plLatencies, (size_t)iTimedCount, sizeof(long),
+         compareLongs);
+      printf("%d timed gets took %ld ns at the median, %ld ns at the "
+         "99.9th percentile, and %ld ns at worst.\n", iTimedCount,
+         plLatencies[iTimedCount / 2],
+         plLatencies[(int)((double)iTimedCount * 0.999)],
+         plLatencies[iTimedCount - 1]);
+   }
+
+   /* No key ends in '#'. */
+   for (i = 0; i < iBindingCount; i++)
+      strcat(pacKeys[i], "#");
+   uFound = 0;
+   dStart = cpuSeconds();
+   for (i = 0; i < iGetCount; i++)
+      if (SymTable_contains(oSymTable,
+             pacKeys[nextRandom(&uState) % (unsigned long)iBindingCount]))
+         uFound++;
+   printf("%d random misses consumed %f seconds.\n", iGetCount,
+      cpuSeconds() - dStart);
+   if (uFound != 0)
+      printf("%lu of the misses found a key.\n", uFound);
+
+   /* What each call cost, when built with SYMTABLE_PROFILE. */
+   SymTable_dumpProfile(stdout);
+
+   SymTable_free(oSymTable);
+   free(plLatencies);
+   free(pacKeys);
+   return 0;
+}
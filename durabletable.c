@@ -0,0 +1,714 @@
+/*-------------------------------------------------------------------*/
+/* durabletable.c                                                    */
+/* Author: Arnold Jiang                                              */
+/*-------------------------------------------------------------------*/
+
+/* fsync() and ftruncate() are POSIX */
+#define _POSIX_C_SOURCE 200112L
+
+#include "durabletable.h"
+#include "symtable.h"
+#include <assert.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+/*defines FALSE (0) and TRUE (1)*/
+enum {FALSE, TRUE};
+
+/*bytes of changes that are gathered before they are written out with
+one write and one fsync, which is what makes logging cheap*/
+enum {GROUP_COMMIT_BYTES = 64 * 1024};
+
+/*bytes of the header that starts the log & the snapshot: the magic
+string, then the value size as 8 little-endian bytes*/
+enum {MAGIC_SIZE = 8, HEADER_SIZE = MAGIC_SIZE + 8};
+static const char acMagic[MAGIC_SIZE] = {'S', 'Y', 'M', 'T', 'L', 'O',
+    'G', '1'};
+
+/*first byte of a record that sets a key's value, or removes the key*/
+enum {RECORD_SET = 'S', RECORD_REMOVE = 'R'};
+
+/*most bytes a record takes besides its key & value: the type, the
+key length in up to 10 bytes of 7 bits each, and the checksum*/
+enum {MAX_VARINT_SIZE = 10, CHECKSUM_SIZE = 4,
+    RECORD_OVERHEAD = 1 + MAX_VARINT_SIZE + CHECKSUM_SIZE};
+
+/*what reading a record found*/
+enum {READ_RECORD, READ_END, READ_DAMAGED, READ_NO_MEMORY};
+
+/* A DurableTable structure is a "manager" structure that holds the
+SymTable with the bindings, the open log, and the changes that have
+not been written to the log yet. Both files are a header followed
+by records, each of which sets or removes one key, so that a snapshot
+is just a log with one record per binding*/
+struct DurableTable {
+    /*holds the bindings, with their values inline*/
+    SymTable_T table;
+    /*bytes in each value*/
+    size_t valueSize;
+    /*file descriptor of the log, open for appending*/
+    int logFd;
+    /*names of the log, the snapshot & the snapshot being written*/
+    char *logPath;
+    char *snapshotPath;
+    char *snapshotTempPath;
+    /*holds records that are not written yet, in used of capacity
+    bytes*/
+    unsigned char *buffer;
+    size_t used;
+    size_t capacity;
+    /*TRUE once writing the log has failed*/
+    int failed;
+};
+
+/* Returns the FNV-1a checksum of the uLength bytes at pucBytes. */
+static unsigned long DurableTable_checksum(const unsigned char *pucBytes,
+    size_t uLength) {
+    unsigned long uHash = 2166136261UL;
+    size_t i;
+    assert(pucBytes != NULL || uLength == 0);
+    for (i = 0; i < uLength; i++) {
+        uHash = ((uHash ^ pucBytes[i]) * 16777619UL) & 0xFFFFFFFFUL;
+    }
+    return uHash;
+}
+
+/* Writes the uLength bytes at pvBytes to the file descriptor iFd.
+   Returns TRUE if all of them were written and FALSE otherwise. */
+static int DurableTable_writeAll(int iFd, const void *pvBytes,
+    size_t uLength) {
+    const char *pcBytes = (const char*)pvBytes;
+    ssize_t iWritten;
+    while (uLength > 0) {
+        iWritten = write(iFd, pcBytes, uLength);
+        if (iWritten < 0 && errno == EINTR) {
+            continue;
+        }
+        if (iWritten <= 0) {
+            return FALSE;
+        }
+        pcBytes += iWritten;
+        uLength -= (size_t)iWritten;
+    }
+    return TRUE;
+}
+
+/* Stores the header of a file of a table whose values are uValueSize
+   bytes in the HEADER_SIZE bytes at pucHeader. */
+static void DurableTable_makeHeader(unsigned char *pucHeader,
+    size_t uValueSize) {
+    size_t i;
+    assert(pucHeader != NULL);
+    memcpy(pucHeader, acMagic, MAGIC_SIZE);
+    for (i = 0; i < 8; i++) {
+        pucHeader[MAGIC_SIZE + i] = (unsigned char)
+            (i < sizeof(size_t) ? (uValueSize >> (8 * i)) & 0xFF : 0);
+    }
+}
+
+/* Makes sure that the buffer of oDurableTable has room for uBytes
+   more bytes. Returns FALSE if insufficient memory is available and
+   TRUE otherwise. */
+static int DurableTable_grow(DurableTable_T oDurableTable,
+    size_t uBytes) {
+    unsigned char *pucBuffer;
+    size_t uCapacity;
+    assert(oDurableTable != NULL);
+    if (oDurableTable->used + uBytes <= oDurableTable->capacity) {
+        return TRUE;
+    }
+    uCapacity = 2 * oDurableTable->capacity;
+    if (uCapacity < oDurableTable->used + uBytes) {
+        uCapacity = oDurableTable->used + uBytes;
+    }
+    pucBuffer = (unsigned char*)realloc(oDurableTable->buffer, uCapacity);
+    if (pucBuffer == NULL) {
+        return FALSE;
+    }
+    oDurableTable->buffer = pucBuffer;
+    oDurableTable->capacity = uCapacity;
+    return TRUE;
+}
+
+/* Appends the record of type iType for the key made of the uLength
+   characters at pcKey, with the valueSize bytes at pvValue, or
+   zeroes if pvValue is NULL, to the buffer of oDurableTable, which
+   must have room for it. A remove record has no value. */
+static void DurableTable_encode(DurableTable_T oDurableTable, int iType,
+    const char *pcKey, size_t uLength, const void *pvValue) {
+    unsigned char *pucRecord;
+    unsigned char *pucNext;
+    unsigned long uChecksum;
+    size_t u;
+    int i;
+    assert(oDurableTable != NULL);
+    assert(pcKey != NULL);
+
+    pucRecord = oDurableTable->buffer + oDurableTable->used;
+    pucNext = pucRecord;
+    *pucNext++ = (unsigned char)iType;
+
+    /*the key length takes 7 bits per byte, so short keys cost one*/
+    for (u = uLength; u >= 0x80; u >>= 7) {
+        *pucNext++ = (unsigned char)((u & 0x7F) | 0x80);
+    }
+    *pucNext++ = (unsigned char)u;
+    memcpy(pucNext, pcKey, uLength);
+    pucNext += uLength;
+    if (iType == RECORD_SET) {
+        if (pvValue == NULL) {
+            memset(pucNext, 0, oDurableTable->valueSize);
+        }
+        else {
+            memcpy(pucNext, pvValue, oDurableTable->valueSize);
+        }
+        pucNext += oDurableTable->valueSize;
+    }
+
+    uChecksum = DurableTable_checksum(pucRecord,
+        (size_t)(pucNext - pucRecord));
+    for (i = 0; i < CHECKSUM_SIZE; i++) {
+        *pucNext++ = (unsigned char)((uChecksum >> (8 * i)) & 0xFF);
+    }
+    oDurableTable->used += (size_t)(pucNext - pucRecord);
+}
+
+/* Writes the buffered records of oDurableTable to the log and waits
+   until they are on disk. Returns FALSE, and marks oDurableTable
+   failed, if that failed, and TRUE otherwise. */
+static int DurableTable_flush(DurableTable_T oDurableTable) {
+    assert(oDurableTable != NULL);
+    if (oDurableTable->failed) {
+        return FALSE;
+    }
+    if (oDurableTable->used == 0) {
+        return TRUE;
+    }
+    if (!DurableTable_writeAll(oDurableTable->logFd,
+        oDurableTable->buffer, oDurableTable->used) ||
+        fsync(oDurableTable->logFd) != 0) {
+        oDurableTable->failed = TRUE;
+        return FALSE;
+    }
+    oDurableTable->used = 0;
+    return TRUE;
+}
+
+/* Makes room in the buffer of oDurableTable for a record with a key
+   of uLength characters, writing out the group of records it holds
+   if the record would overfill it. A change to the table is only
+   made once this succeeds, so that its record always fits. Returns
+   FALSE if the log cannot be written or insufficient memory is
+   available, and TRUE otherwise. */
+static int DurableTable_reserve(DurableTable_T oDurableTable,
+    size_t uLength) {
+    size_t uBytes;
+    assert(oDurableTable != NULL);
+    if (oDurableTable->failed) {
+        return FALSE;
+    }
+    uBytes = RECORD_OVERHEAD + uLength + oDurableTable->valueSize;
+    if (oDurableTable->used > 0 &&
+        oDurableTable->used + uBytes > GROUP_COMMIT_BYTES &&
+        !DurableTable_flush(oDurableTable)) {
+        return FALSE;
+    }
+    return DurableTable_grow(oDurableTable, uBytes);
+}
+
+/* Reads the next record of psFile, which has uRemaining bytes left,
+   into the buffer of oDurableTable. Sets *piType to its type, and
+   *puLength and *puKey to the length and offset in the buffer of
+   its key, whose value follows it. Returns READ_RECORD if a whole
+   record was read, READ_END at the end of the file, READ_DAMAGED if
+   the record is cut short or does not match its checksum, and
+   READ_NO_MEMORY if insufficient memory is available. */
+static int DurableTable_readRecord(DurableTable_T oDurableTable,
+    FILE *psFile, size_t uRemaining, int *piType, size_t *puLength,
+    size_t *puKey) {
+    unsigned char *pucRecord;
+    unsigned long uChecksum;
+    size_t uLength;
+    size_t uBody;
+    size_t uSize;
+    int iShift;
+    int iChar;
+    int i;
+    assert(oDurableTable != NULL);
+    assert(psFile != NULL);
+
+    iChar = getc(psFile);
+    if (iChar == EOF) {
+        return READ_END;
+    }
+    if (iChar != RECORD_SET && iChar != RECORD_REMOVE) {
+        return READ_DAMAGED;
+    }
+    *piType = iChar;
+    oDurableTable->used = 0;
+    oDurableTable->buffer[oDurableTable->used++] = (unsigned char)iChar;
+
+    /*a length that does not fit in what is left of the file can only
+    come from damage, so it is never allocated*/
+    uLength = 0;
+    for (iShift = 0; ; iShift += 7) {
+        iChar = getc(psFile);
+        if (iChar == EOF || oDurableTable->used > MAX_VARINT_SIZE) {
+            return READ_DAMAGED;
+        }
+        oDurableTable->buffer[oDurableTable->used++] =
+            (unsigned char)iChar;
+        if (iShift < (int)(8 * sizeof(size_t))) {
+            uLength |= (size_t)(iChar & 0x7F) << iShift;
+        }
+        if ((iChar & 0x80) == 0) {
+            break;
+        }
+    }
+    uBody = uLength + (*piType == RECORD_SET ?
+        oDurableTable->valueSize : 0);
+    if (uLength > uRemaining || oDurableTable->used > uRemaining ||
+        uBody + CHECKSUM_SIZE > uRemaining - oDurableTable->used) {
+        return READ_DAMAGED;
+    }
+    uSize = uBody + CHECKSUM_SIZE;
+    if (!DurableTable_grow(oDurableTable, uSize)) {
+        return READ_NO_MEMORY;
+    }
+    pucRecord = oDurableTable->buffer;
+    if (fread(pucRecord + oDurableTable->used, 1, uSize, psFile) !=
+        uSize) {
+        return READ_DAMAGED;
+    }
+
+    uChecksum = 0;
+    for (i = 0; i < CHECKSUM_SIZE; i++) {
+        uChecksum |= (unsigned long)pucRecord[oDurableTable->used + uBody
+            + (size_t)i] << (8 * i);
+    }
+    if (uChecksum != DurableTable_checksum(pucRecord,
+        oDurableTable->used + uBody) ||
+        memchr(pucRecord + oDurableTable->used, '\0', uLength) != NULL) {
+        return READ_DAMAGED;
+    }
+    *puLength = uLength;
+    *puKey = oDurableTable->used;
+    oDurableTable->used += uSize;
+    return READ_RECORD;
+}
+
+/* Applies the records of the file pcPath to the table of
+   oDurableTable. A file that does not exist holds no records. Stores
+   in *puGood the number of bytes at the start of the file that hold
+   its header and whole records, which is 0 if there is no whole
+   header. A damaged record ends a log, whose last records may have
+   been cut short by a crash, but makes a snapshot, which is only
+   ever renamed into place whole, unreadable. Returns FALSE if the
+   file cannot be read, holds a table of another value size, or is
+   unreadable, or if insufficient memory is available, and TRUE
+   otherwise. */
+static int DurableTable_replay(DurableTable_T oDurableTable,
+    const char *pcPath, int iIsLog, size_t *puGood) {
+    FILE *psFile;
+    struct stat sStat;
+    unsigned char aucHeader[HEADER_SIZE];
+    unsigned char aucExpected[HEADER_SIZE];
+    size_t uSize;
+    size_t uLength;
+    size_t uKey;
+    char *pcKey;
+    char *pcValue;
+    int iType;
+    int iRead;
+    int iSuccessful = TRUE;
+    assert(oDurableTable != NULL);
+    assert(pcPath != NULL);
+    assert(puGood != NULL);
+    *puGood = 0;
+
+    psFile = fopen(pcPath, "rb");
+    if (psFile == NULL) {
+        return errno == ENOENT;
+    }
+    if (fstat(fileno(psFile), &sStat) != 0) {
+        (void)fclose(psFile);
+        return FALSE;
+    }
+    uSize = (size_t)sStat.st_size;
+
+    /*a log whose header was cut short has no records yet*/
+    if (fread(aucHeader, 1, HEADER_SIZE, psFile) != HEADER_SIZE) {
+        (void)fclose(psFile);
+        return iIsLog;
+    }
+    DurableTable_makeHeader(aucExpected, oDurableTable->valueSize);
+    if (memcmp(aucHeader, aucExpected, HEADER_SIZE) != 0) {
+        (void)fclose(psFile);
+        return FALSE;
+    }
+    *puGood = HEADER_SIZE;
+
+    for (;;) {
+        iRead = DurableTable_readRecord(oDurableTable, psFile,
+            uSize - *puGood, &iType, &uLength, &uKey);
+        if (iRead == READ_END) {
+            break;
+        }
+        if (iRead != READ_RECORD) {
+            iSuccessful = iIsLog && iRead == READ_DAMAGED;
+            break;
+        }
+
+        /*the key is ended in place by moving the value one byte up,
+        over the checksum that has been checked already*/
+        pcKey = (char*)oDurableTable->buffer + uKey;
+        pcValue = pcKey + uLength + 1;
+        if (iType == RECORD_SET) {
+            memmove(pcValue, pcKey + uLength, oDurableTable->valueSize);
+        }
+        pcKey[uLength] = '\0';
+        if (iType == RECORD_REMOVE) {
+            (void)SymTable_remove(oDurableTable->table, pcKey);
+        }
+        else if (!SymTable_upsert(oDurableTable->table, pcKey,
+            pcValue)) {
+            iSuccessful = FALSE;
+            break;
+        }
+        *puGood += oDurableTable->used;
+    }
+    oDurableTable->used = 0;
+    (void)fclose(psFile);
+    return iSuccessful;
+}
+
+/* Waits until the directory that holds the file pcPath is on disk,
+   so that a file just created or renamed in it survives a crash.
+   Returns TRUE if that succeeded and FALSE otherwise. */
+static int DurableTable_syncDirectory(const char *pcPath) {
+    char *pcDirectory;
+    char *pcSlash;
+    int iFd;
+    int iSuccessful;
+    assert(pcPath != NULL);
+
+    pcDirectory = (char*)malloc(strlen(pcPath) + 2);
+    if (pcDirectory == NULL) {
+        return FALSE;
+    }
+    strcpy(pcDirectory, pcPath);
+    pcSlash = strrchr(pcDirectory, '/');
+    if (pcSlash == NULL) {
+        strcpy(pcDirectory, ".");
+    }
+    else {
+        pcSlash[pcSlash == pcDirectory ? 1 : 0] = '\0';
+    }
+
+    iFd = open(pcDirectory, O_RDONLY);
+    free(pcDirectory);
+    if (iFd < 0) {
+        return FALSE;
+    }
+    iSuccessful = fsync(iFd) == 0;
+    (void)close(iFd);
+    return iSuccessful;
+}
+
+/* Returns a new string that is pcPath followed by pcSuffix, or NULL
+   if insufficient memory is available. */
+static char *DurableTable_path(const char *pcPath, const char *pcSuffix) {
+    char *pcResult;
+    assert(pcPath != NULL);
+    assert(pcSuffix != NULL);
+    pcResult = (char*)malloc(strlen(pcPath) + strlen(pcSuffix) + 1);
+    if (pcResult != NULL) {
+        strcpy(pcResult, pcPath);
+        strcat(pcResult, pcSuffix);
+    }
+    return pcResult;
+}
+
+/* Frees all memory occupied by oDurableTable and closes its log if
+   it is open. */
+static void DurableTable_destroy(DurableTable_T oDurableTable) {
+    assert(oDurableTable != NULL);
+    if (oDurableTable->logFd >= 0) {
+        (void)close(oDurableTable->logFd);
+    }
+    if (oDurableTable->table != NULL) {
+        SymTable_free(oDurableTable->table);
+    }
+    free(oDurableTable->logPath);
+    free(oDurableTable->snapshotPath);
+    free(oDurableTable->snapshotTempPath);
+    free(oDurableTable->buffer);
+    free(oDurableTable);
+}
+
+DurableTable_T DurableTable_open(const char *pcPath, size_t uValueSize) {
+    DurableTable_T oDurableTable;
+    unsigned char aucHeader[HEADER_SIZE];
+    size_t uGood;
+    int iSuccessful;
+    assert(pcPath != NULL);
+    assert(uValueSize > 0);
+
+    /*allocates memory for a new DurableTable*/
+    oDurableTable = (DurableTable_T)malloc(sizeof(struct DurableTable));
+    if (oDurableTable == NULL) {
+        return NULL;
+    }
+    oDurableTable->valueSize = uValueSize;
+    oDurableTable->logFd = -1;
+    oDurableTable->used = 0;
+    oDurableTable->capacity = GROUP_COMMIT_BYTES;
+    oDurableTable->failed = FALSE;
+    oDurableTable->table = SymTable_newInline(uValueSize);
+    oDurableTable->logPath = DurableTable_path(pcPath, ".log");
+    oDurableTable->snapshotPath = DurableTable_path(pcPath, ".snapshot");
+    oDurableTable->snapshotTempPath = DurableTable_path(pcPath,
+        ".snapshot.tmp");
+    oDurableTable->buffer = (unsigned char*)malloc(GROUP_COMMIT_BYTES);
+    if (oDurableTable->table == NULL || oDurableTable->logPath == NULL ||
+        oDurableTable->snapshotPath == NULL ||
+        oDurableTable->snapshotTempPath == NULL ||
+        oDurableTable->buffer == NULL) {
+        DurableTable_destroy(oDurableTable);
+        return NULL;
+    }
+
+    /*rebuilds the table from the snapshot, then the changes since*/
+    if (!DurableTable_replay(oDurableTable, oDurableTable->snapshotPath,
+        FALSE, &uGood) ||
+        !DurableTable_replay(oDurableTable, oDurableTable->logPath, TRUE,
+        &uGood)) {
+        DurableTable_destroy(oDurableTable);
+        return NULL;
+    }
+
+    /*cuts off whatever a crash left after the last whole record, so
+    that new records follow it directly, and starts a log that has
+    no header yet*/
+    oDurableTable->logFd = open(oDurableTable->logPath,
+        O_WRONLY | O_CREAT, 0666);
+    if (oDurableTable->logFd < 0) {
+        DurableTable_destroy(oDurableTable);
+        return NULL;
+    }
+    iSuccessful = ftruncate(oDurableTable->logFd, (off_t)uGood) == 0;
+    if (iSuccessful && uGood == 0) {
+        DurableTable_makeHeader(aucHeader, uValueSize);
+        iSuccessful = DurableTable_writeAll(oDurableTable->logFd,
+            aucHeader, HEADER_SIZE) &&
+            fsync(oDurableTable->logFd) == 0 &&
+            DurableTable_syncDirectory(oDurableTable->logPath);
+    }
+    if (!iSuccessful ||
+        lseek(oDurableTable->logFd, 0, SEEK_END) == (off_t)-1) {
+        DurableTable_destroy(oDurableTable);
+        return NULL;
+    }
+    return oDurableTable;
+}
+
+int DurableTable_close(DurableTable_T oDurableTable) {
+    int iSuccessful;
+    assert(oDurableTable != NULL);
+    iSuccessful = DurableTable_flush(oDurableTable);
+    DurableTable_destroy(oDurableTable);
+    return iSuccessful;
+}
+
+int DurableTable_sync(DurableTable_T oDurableTable) {
+    assert(oDurableTable != NULL);
+    return DurableTable_flush(oDurableTable);
+}
+
+/* A Snapshot is the state of DurableTable_checkpoint that
+DurableTable_writeBinding sees*/
+struct Snapshot {
+    /*the table being saved*/
+    DurableTable_T oDurableTable;
+    /*file descriptor of the snapshot being written*/
+    int fd;
+    /*TRUE once writing the snapshot has failed*/
+    int failed;
+};
+
+/* Appends a record that sets the key pcKey to the value at pvValue
+   to the snapshot that pvSnapshot points to, writing out the records
+   gathered so far when there are enough of them. */
+static void DurableTable_writeBinding(const char *pcKey, void *pvValue,
+    void *pvSnapshot) {
+    struct Snapshot *psSnapshot = (struct Snapshot*)pvSnapshot;
+    DurableTable_T oDurableTable;
+    size_t uLength;
+    assert(pcKey != NULL);
+    assert(psSnapshot != NULL);
+    oDurableTable = psSnapshot->oDurableTable;
+    if (psSnapshot->failed) {
+        return;
+    }
+
+    uLength = strlen(pcKey);
+    if (oDurableTable->used >= GROUP_COMMIT_BYTES) {
+        if (!DurableTable_writeAll(psSnapshot->fd, oDurableTable->buffer,
+            oDurableTable->used)) {
+            psSnapshot->failed = TRUE;
+            return;
+        }
+        oDurableTable->used = 0;
+    }
+    if (!DurableTable_grow(oDurableTable, RECORD_OVERHEAD + uLength +
+        oDurableTable->valueSize)) {
+        psSnapshot->failed = TRUE;
+        return;
+    }
+    DurableTable_encode(oDurableTable, RECORD_SET, pcKey, uLength,
+        pvValue);
+}
+
+int DurableTable_checkpoint(DurableTable_T oDurableTable) {
+    struct Snapshot sSnapshot;
+    unsigned char aucHeader[HEADER_SIZE];
+    assert(oDurableTable != NULL);
+
+    /*the log must be whole before the snapshot can replace it*/
+    if (!DurableTable_flush(oDurableTable)) {
+        return FALSE;
+    }
+
+    sSnapshot.oDurableTable = oDurableTable;
+    sSnapshot.failed = FALSE;
+    sSnapshot.fd = open(oDurableTable->snapshotTempPath,
+        O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (sSnapshot.fd < 0) {
+        return FALSE;
+    }
+    DurableTable_makeHeader(aucHeader, oDurableTable->valueSize);
+    sSnapshot.failed = !DurableTable_writeAll(sSnapshot.fd, aucHeader,
+        HEADER_SIZE);
+    SymTable_map(oDurableTable->table, DurableTable_writeBinding,
+        &sSnapshot);
+    if (!sSnapshot.failed) {
+        sSnapshot.failed = !DurableTable_writeAll(sSnapshot.fd,
+            oDurableTable->buffer, oDurableTable->used) ||
+            fsync(sSnapshot.fd) != 0;
+    }
+    oDurableTable->used = 0;
+    if (close(sSnapshot.fd) != 0 || sSnapshot.failed) {
+        (void)remove(oDurableTable->snapshotTempPath);
+        return FALSE;
+    }
+
+    /*the rename is the moment the new snapshot takes over. A crash
+    before the log is emptied only replays changes the snapshot
+    already holds, which leaves every binding as it was*/
+    if (rename(oDurableTable->snapshotTempPath,
+        oDurableTable->snapshotPath) != 0) {
+        (void)remove(oDurableTable->snapshotTempPath);
+        return FALSE;
+    }
+    if (!DurableTable_syncDirectory(oDurableTable->snapshotPath)) {
+        return FALSE;
+    }
+    if (ftruncate(oDurableTable->logFd, HEADER_SIZE) != 0 ||
+        lseek(oDurableTable->logFd, 0, SEEK_END) == (off_t)-1 ||
+        fsync(oDurableTable->logFd) != 0) {
+        oDurableTable->failed = TRUE;
+        return FALSE;
+    }
+    return TRUE;
+}
+
+size_t DurableTable_getLength(DurableTable_T oDurableTable) {
+    assert(oDurableTable != NULL);
+    return SymTable_getLength(oDurableTable->table);
+}
+
+int DurableTable_put(DurableTable_T oDurableTable,
+    const char *pcKey, const void *pvValue) {
+    size_t uLength;
+    assert(oDurableTable != NULL);
+    assert(pcKey != NULL);
+
+    /*only changes are logged, and room for the record is made first so 
+    that a change is never left unlogged*/
+    uLength = strlen(pcKey);
+    if (!DurableTable_reserve(oDurableTable, uLength) ||
+        !SymTable_put(oDurableTable->table, pcKey, pvValue)) {
+        return FALSE;
+    }
+    DurableTable_encode(oDurableTable, RECORD_SET, pcKey, uLength,
+        pvValue);
+    return TRUE;
+}
+
+void *DurableTable_replace(DurableTable_T oDurableTable,
+    const char *pcKey, const void *pvValue) {
+    size_t uLength;
+    void *pvOldValue;
+    assert(oDurableTable != NULL);
+    assert(pcKey != NULL);
+
+    /*the table is inline, so a replace that made a change returns 
+    a copy of the old value, never NULL*/
+    uLength = strlen(pcKey);
+    if (!DurableTable_reserve(oDurableTable, uLength)) {
+        return NULL;
+    }
+    pvOldValue = SymTable_replace(oDurableTable->table, pcKey, pvValue);
+    if (pvOldValue == NULL) {
+        return NULL;
+    }
+    DurableTable_encode(oDurableTable, RECORD_SET, pcKey, uLength,
+        pvValue);
+    return pvOldValue;
+}
+
+int DurableTable_contains(DurableTable_T oDurableTable,
+    const char *pcKey) {
+    assert(oDurableTable != NULL);
+    assert(pcKey != NULL);
+    return SymTable_contains(oDurableTable->table, pcKey);
+}
+
+void *DurableTable_get(DurableTable_T oDurableTable, const char *pcKey) {
+    assert(oDurableTable != NULL);
+    assert(pcKey != NULL);
+    return SymTable_get(oDurableTable->table, pcKey);
+}
+
+void *DurableTable_remove(DurableTable_T oDurableTable,
+    const char *pcKey) {
+    size_t uLength;
+    void *pvOldValue;
+    assert(oDurableTable != NULL);
+    assert(pcKey != NULL);
+
+    uLength = strlen(pcKey);
+    if (!DurableTable_reserve(oDurableTable, uLength)) {
+        return NULL;
+    }
+    pvOldValue = SymTable_remove(oDurableTable->table, pcKey);
+    if (pvOldValue == NULL) {
+        return NULL;
+    }
+    DurableTable_encode(oDurableTable, RECORD_REMOVE, pcKey, uLength,
+        NULL);
+    return pvOldValue;
+}
+
+void DurableTable_map(DurableTable_T oDurableTable, void (*pfApply)
+    (const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra) {
+    assert(oDurableTable != NULL);
+    assert(pfApply != NULL);
+    SymTable_map(oDurableTable->table, pfApply, pvExtra);
+}
@@ -0,0 +1,98 @@
+/*-------------------------------------------------------------------*/
+/* durabletable.h                                                    */
+/* Author: Arnold Jiang                                              */
+/*-------------------------------------------------------------------*/
+
+#ifndef DURABLETABLE_INCLUDED
+#define DURABLETABLE_INCLUDED
+#include <stddef.h>
+
+/* A DurableTable_T object is a collection of bindings with unique
+string keys and values of a fixed number of bytes, like a SymTable_T
+made by SymTable_newInline, that survives the program. Every change
+is appended to a log file, and opening the table again replays the
+log on top of the latest snapshot. Changes are written out in groups:
+a change is on disk once DurableTable_sync, DurableTable_checkpoint
+or DurableTable_close returns TRUE, or once enough later changes have
+been made to fill a group. A crash loses at most the changes made
+since then, never the ones before, and never leaves the table half
+changed.*/
+typedef struct DurableTable *DurableTable_T;
+
+/* returns a DurableTable object whose values are uValueSize bytes
+each, holding the bindings that were saved under pcPath, or no
+bindings if nothing was. The table is kept in the files pcPath.log
+and pcPath.snapshot, which are created if need be. Returns NULL if
+the files cannot be read or created, if they hold a table with
+another value size or are damaged other than by a crash, or if
+insufficient memory is available. uValueSize must not be 0, and no
+two open DurableTables may use the same pcPath.*/
+DurableTable_T DurableTable_open(const char *pcPath, size_t uValueSize);
+
+/* writes out the changes to oDurableTable that are not yet on disk,
+frees all memory occupied by oDurableTable and closes its files.
+Returns 1 (TRUE) if every change made to oDurableTable is on disk,
+and 0 (FALSE) otherwise.*/
+int DurableTable_close(DurableTable_T oDurableTable);
+
+/* writes out the changes to oDurableTable that are not yet on disk,
+and waits until they are. Returns 1 (TRUE) if every change made to
+oDurableTable is on disk, and 0 (FALSE) if writing failed, after
+which every call that would change oDurableTable fails.*/
+int DurableTable_sync(DurableTable_T oDurableTable);
+
+/* writes every binding of oDurableTable to a new snapshot, which
+replaces the old one, and empties the log, so that opening the table
+again need not replay the changes made until now. Returns 1 (TRUE)
+if that succeeded, and 0 (FALSE) otherwise, in which case the old
+snapshot and the log still hold the table.*/
+int DurableTable_checkpoint(DurableTable_T oDurableTable);
+
+/* Returns the number of bindings in oDurableTable.*/
+size_t DurableTable_getLength(DurableTable_T oDurableTable);
+
+/* Adds a binding to oDurableTable with key pcKey and a copy of the
+value at pvValue, or a value of zeroes if pvValue is NULL, and
+returns 1 (TRUE) if oDurableTable does not contain a binding with
+key pcKey. Otherwise, or if insufficient memory is available or
+writing the log failed, leaves oDurableTable unchanged and returns
+0 (FALSE).*/
+int DurableTable_put(DurableTable_T oDurableTable,
+    const char *pcKey, const void *pvValue);
+
+/* If oDurableTable contains a binding with key pcKey, copies the
+value at pvValue, or zeroes if pvValue is NULL, over the binding's
+value and returns a pointer to a copy of the old value that stays
+valid until the next call that changes oDurableTable. Otherwise, or
+if insufficient memory is available or writing the log failed,
+leaves oDurableTable unchanged and returns NULL.*/
+void *DurableTable_replace(DurableTable_T oDurableTable,
+    const char *pcKey, const void *pvValue);
+
+/* Returns 1 (TRUE) if oDurableTable contains a binding whose key is
+pcKey, and 0 (FALSE) otherwise.*/
+int DurableTable_contains(DurableTable_T oDurableTable,
+    const char *pcKey);
+
+/* Returns a pointer to the value of the binding within oDurableTable
+whose key is pcKey, or NULL if no such binding exists. The value must
+not be changed through the pointer, which stays valid until the next
+call that changes oDurableTable.*/
+void *DurableTable_get(DurableTable_T oDurableTable, const char *pcKey);
+
+/* If oDurableTable contains a binding with key pcKey, removes that
+binding and returns a pointer to a copy of its value that stays valid
+until the next call that changes oDurableTable. Otherwise, or if
+insufficient memory is available or writing the log failed, leaves
+oDurableTable unchanged and returns NULL.*/
+void *DurableTable_remove(DurableTable_T oDurableTable,
+    const char *pcKey);
+
+/* Applies function *pfApply to each binding in oDurableTable,
+passing pvExtra as an extra parameter. *pfApply must not change the
+value that pvValue points to.*/
+void DurableTable_map(DurableTable_T oDurableTable, void (*pfApply)
+(const char *pcKey, void *pvValue, void *pvExtra),
+const void *pvExtra);
+
+#endif
@@ -0,0 +1,219 @@
+/*-------------------------------------------------------------------*/
+/* scopetable.c                                                      */
+/* Author: Arnold Jiang                                              */
+/*-------------------------------------------------------------------*/
+
+#include "scopetable.h"
+#include "symtable.h"
+#include <assert.h>
+#include <string.h>
+#include <stdlib.h>
+
+/*defines FALSE (0) and TRUE (1)*/
+enum {FALSE, TRUE};
+
+/*number of scopes the scope stack initially has room for*/
+enum {INITIAL_SCOPE_CAPACITY = 8};
+
+/* A Binding holds one key's value in one scope. The SymTable maps
+each key to its innermost Binding, which links to the Binding it
+shadows. The Bindings of a scope are also linked together so that
+the scope can be closed without searching for them*/
+struct Binding {
+    /*points to a copy of the key*/
+    char *key;
+    /*points to a value*/
+    const void *value;
+    /*depth of the scope that holds the binding*/
+    size_t depth;
+    /*points to the binding of the same key in an outer scope*/
+    struct Binding *shadowed;
+    /*points to the next binding in the same scope*/
+    struct Binding *nextInScope;
+};
+
+/* A ScopeTable structure is a "manager" structure that holds the
+shared SymTable and a stack with the first Binding of each open
+scope*/
+struct ScopeTable {
+    /*maps each key to its innermost Binding*/
+    SymTable_T bindings;
+    /*points to the first binding of each open scope*/
+    struct Binding **scopes;
+    /*depth of the innermost scope*/
+    size_t depth;
+    /*number of scopes that scopes has room for*/
+    size_t capacity;
+};
+
+ScopeTable_T ScopeTable_new(void) {
+    ScopeTable_T oScopeTable;
+
+    /*allocates memory for a new ScopeTable*/
+    oScopeTable = (ScopeTable_T)malloc(sizeof(struct ScopeTable));
+    if (oScopeTable == NULL) {
+        return NULL;
+    }
+
+    oScopeTable->bindings = SymTable_new();
+    if (oScopeTable->bindings == NULL) {
+        free(oScopeTable);
+        return NULL;
+    }
+
+    oScopeTable->scopes = (struct Binding**)calloc
+        (INITIAL_SCOPE_CAPACITY, sizeof(struct Binding*));
+    if (oScopeTable->scopes == NULL) {
+        SymTable_free(oScopeTable->bindings);
+        free(oScopeTable);
+        return NULL;
+    }
+
+    /*starts in the outermost scope*/
+    oScopeTable->depth = 0;
+    oScopeTable->capacity = INITIAL_SCOPE_CAPACITY;
+    return oScopeTable;
+}
+
+void ScopeTable_free(ScopeTable_T oScopeTable) {
+    size_t i;
+    struct Binding *binding;
+    struct Binding *next;
+    assert(oScopeTable != NULL);
+
+    /*frees every binding of every open scope*/
+    for (i = 0; i <= oScopeTable->depth; i++) {
+        for (binding = oScopeTable->scopes[i]; binding != NULL;
+            binding = next) {
+            next = binding->nextInScope;
+            free(binding->key);
+            free(binding);
+        }
+    }
+
+    SymTable_free(oScopeTable->bindings);
+    free(oScopeTable->scopes);
+    free(oScopeTable);
+}
+
+size_t ScopeTable_getDepth(ScopeTable_T oScopeTable) {
+    assert(oScopeTable != NULL);
+    return oScopeTable->depth;
+}
+
+int ScopeTable_enterScope(ScopeTable_T oScopeTable) {
+    struct Binding **tmp;
+    size_t newCapacity;
+    assert(oScopeTable != NULL);
+
+    /*doubles the scope stack when it is full*/
+    if (oScopeTable->depth + 1 == oScopeTable->capacity) {
+        newCapacity = 2 * oScopeTable->capacity;
+        tmp = (struct Binding**)realloc(oScopeTable->scopes,
+            newCapacity * sizeof(struct Binding*));
+        if (tmp == NULL) {
+            return FALSE;
+        }
+        oScopeTable->scopes = tmp;
+        oScopeTable->capacity = newCapacity;
+    }
+
+    oScopeTable->depth++;
+    oScopeTable->scopes[oScopeTable->depth] = NULL;
+    return TRUE;
+}
+
+void ScopeTable_exitScope(ScopeTable_T oScopeTable) {
+    struct Binding *binding;
+    struct Binding *next;
+    assert(oScopeTable != NULL);
+    assert(oScopeTable->depth > 0);
+
+    /*uncovers the binding each closed binding shadowed, or removes
+    the key when nothing was shadowed*/
+    for (binding = oScopeTable->scopes[oScopeTable->depth];
+        binding != NULL; binding = next) {
+        next = binding->nextInScope;
+        if (binding->shadowed != NULL) {
+            (void)SymTable_replace(oScopeTable->bindings, binding->key,
+                binding->shadowed);
+        }
+        else {
+            (void)SymTable_remove(oScopeTable->bindings, binding->key);
+        }
+        free(binding->key);
+        free(binding);
+    }
+
+    oScopeTable->scopes[oScopeTable->depth] = NULL;
+    oScopeTable->depth--;
+}
+
+int ScopeTable_bind(ScopeTable_T oScopeTable,
+    const char *pcKey, const void *pvValue) {
+    struct Binding *binding;
+    struct Binding *innermost;
+    void **slot;
+    assert(oScopeTable != NULL);
+    assert(pcKey != NULL);
+
+    /*finds the slot for pcKey's innermost binding with one lookup,
+    adding an empty slot if pcKey is not bound at all*/
+    slot = SymTable_getOrInsert(oScopeTable->bindings, pcKey, NULL);
+    if (slot == NULL) {
+        return FALSE;
+    }
+    innermost = (struct Binding*)*slot;
+
+    /*checks if the innermost scope binds pcKey already*/
+    if (innermost != NULL && innermost->depth == oScopeTable->depth) {
+        return FALSE;
+    }
+
+    /*allocates memory for the binding & a defensive copy of pcKey*/
+    binding = (struct Binding*)malloc(sizeof(struct Binding));
+    if (binding != NULL) {
+        binding->key = malloc(strlen(pcKey) + 1);
+        if (binding->key == NULL) {
+            free(binding);
+            binding = NULL;
+        }
+    }
+    if (binding == NULL) {
+        /*drops the empty slot added above*/
+        if (innermost == NULL) {
+            (void)SymTable_remove(oScopeTable->bindings, pcKey);
+        }
+        return FALSE;
+    }
+    strcpy(binding->key, pcKey);
+    binding->value = pvValue;
+    binding->depth = oScopeTable->depth;
+    binding->shadowed = innermost;
+
+    /*makes the binding the innermost one for pcKey*/
+    *slot = binding;
+
+    /*adds the binding to the innermost scope*/
+    binding->nextInScope = oScopeTable->scopes[oScopeTable->depth];
+    oScopeTable->scopes[oScopeTable->depth] = binding;
+    return TRUE;
+}
+
+int ScopeTable_contains(ScopeTable_T oScopeTable, const char *pcKey) {
+    assert(oScopeTable != NULL);
+    assert(pcKey != NULL);
+    return SymTable_contains(oScopeTable->bindings, pcKey);
+}
+
+void *ScopeTable_lookup(ScopeTable_T oScopeTable, const char *pcKey) {
+    struct Binding *innermost;
+    assert(oScopeTable != NULL);
+    assert(pcKey != NULL);
+    innermost = (struct Binding*)SymTable_get(oScopeTable->bindings,
+        pcKey);
+    if (innermost == NULL) {
+        return NULL;
+    }
+    return (void*)innermost->value;
+}
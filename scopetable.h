@@ -0,0 +1,54 @@
+/*-------------------------------------------------------------------*/
+/* scopetable.h                                                      */
+/* Author: Arnold Jiang                                              */
+/*-------------------------------------------------------------------*/
+
+#ifndef SCOPETABLE_INCLUDED
+#define SCOPETABLE_INCLUDED
+#include <stddef.h>
+
+/* A ScopeTable_T object is a stack of nested scopes, each holding
+bindings with unique string keys. A binding in an inner scope shadows
+bindings with the same key in the scopes around it. All scopes share
+one SymTable, so a lookup is a single probe however deep the nesting
+is. A new ScopeTable_T starts in the outermost scope, at depth 0.*/
+typedef struct ScopeTable *ScopeTable_T;
+
+/* returns a new ScopeTable object that holds only the empty 
+outermost scope, or NULL if insufficient memory is available.*/
+ScopeTable_T ScopeTable_new(void);
+
+/* frees all memory occupied by oScopeTable. */
+void ScopeTable_free(ScopeTable_T oScopeTable);
+
+/* Returns the depth of the innermost scope of oScopeTable, which is 
+0 for the outermost scope.*/
+size_t ScopeTable_getDepth(ScopeTable_T oScopeTable);
+
+/* Opens a new innermost scope in oScopeTable and returns 1 (TRUE), 
+or returns 0 (FALSE) and leaves oScopeTable unchanged if insufficient
+memory is available.*/
+int ScopeTable_enterScope(ScopeTable_T oScopeTable);
+
+/* Closes the innermost scope of oScopeTable, which must not be the 
+outermost one, removing its bindings and uncovering the bindings 
+they shadowed. Takes time proportional to the number of bindings 
+in the closed scope.*/
+void ScopeTable_exitScope(ScopeTable_T oScopeTable);
+
+/* Adds a binding with key pcKey and value pvValue to the innermost 
+scope of oScopeTable and returns 1 (TRUE). Returns 0 (FALSE) and 
+leaves oScopeTable unchanged if that scope already binds pcKey or 
+if insufficient memory is available.*/
+int ScopeTable_bind(ScopeTable_T oScopeTable,
+    const char *pcKey, const void *pvValue);
+
+/* Returns 1 (TRUE) if any open scope of oScopeTable binds pcKey, 
+and 0 (FALSE) otherwise.*/
+int ScopeTable_contains(ScopeTable_T oScopeTable, const char *pcKey);
+
+/* Returns the value of the innermost binding of pcKey in oScopeTable,
+or NULL if no open scope binds pcKey.*/
+void *ScopeTable_lookup(ScopeTable_T oScopeTable, const char *pcKey);
+
+#endif
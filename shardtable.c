@@ -0,0 +1,224 @@
+/*-------------------------------------------------------------------*/
+/* shardtable.c                                                      */
+/* Author: Arnold Jiang                                              */
+/*-------------------------------------------------------------------*/
+
+#include "shardtable.h"
+#include "symtable.h"
+#include <assert.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+/*most shards a ShardTable may have*/
+enum {MAX_SHARDS = 256};
+
+/*bytes in a cache line; pads shards apart so that threads locking
+neighbouring shards do not fight over one line*/
+enum {CACHE_LINE_SIZE = 64};
+
+/*number of bits in a size_t*/
+#define SIZE_BITS (sizeof(size_t) * CHAR_BIT)
+
+/*2^64 divided by the golden ratio, truncated to a size_t. Multiplying
+by it spreads every bit of a hash code into the high bits*/
+static const size_t GOLDEN_MULTIPLIER = (size_t)0x9E3779B97F4A7C15ULL;
+
+/* A Shard is one SymTable together with the lock that guards it*/
+struct Shard {
+    /*guards table*/
+    pthread_mutex_t lock;
+    /*holds the bindings whose keys route to this shard*/
+    SymTable_T table;
+    /*keeps the next shard's lock off this cache line*/
+    char padding[CACHE_LINE_SIZE];
+};
+
+/* A ShardTable structure is a "manager" structure that holds an
+array of shards, whose count is a power of two*/
+struct ShardTable {
+    /*points to the shards*/
+    struct Shard *shards;
+    /*number of shards*/
+    size_t shardCount;
+    /*number of high bits of a mixed hash code that pick a shard*/
+    size_t shardBits;
+};
+
+/* Returns the shard of oShardTable that holds the key whose hash
+   code is uHash. The shard comes from the high bits of the mixed
+   code, while each SymTable picks buckets from the code modulo its
+   bucket count, so the two choices stay independent. */
+static struct Shard *ShardTable_route(ShardTable_T oShardTable,
+    size_t uHash) {
+    assert(oShardTable != NULL);
+    if (oShardTable->shardBits == 0) {
+        return &oShardTable->shards[0];
+    }
+    return &oShardTable->shards[(uHash * GOLDEN_MULTIPLIER) >>
+        (SIZE_BITS - oShardTable->shardBits)];
+}
+
+ShardTable_T ShardTable_new(size_t uShardCount) {
+    ShardTable_T oShardTable;
+    size_t i;
+
+    /*allocates memory for a new ShardTable*/
+    oShardTable = (ShardTable_T)malloc(sizeof(struct ShardTable));
+    if (oShardTable == NULL) {
+        return NULL;
+    }
+
+    /*rounds the shard count up to a power of two*/
+    oShardTable->shardCount = 1;
+    oShardTable->shardBits = 0;
+    while (oShardTable->shardCount < uShardCount &&
+        oShardTable->shardCount < MAX_SHARDS) {
+        oShardTable->shardCount *= 2;
+        oShardTable->shardBits++;
+    }
+
+    oShardTable->shards = (struct Shard*)malloc
+        (oShardTable->shardCount * sizeof(struct Shard));
+    if (oShardTable->shards == NULL) {
+        free(oShardTable);
+        return NULL;
+    }
+
+    for (i = 0; i < oShardTable->shardCount; i++) {
+        oShardTable->shards[i].table = SymTable_new();
+        if (oShardTable->shards[i].table == NULL ||
+            pthread_mutex_init(&oShardTable->shards[i].lock, NULL)
+            != 0) {
+            /*undoes the shards made so far*/
+            if (oShardTable->shards[i].table != NULL) {
+                SymTable_free(oShardTable->shards[i].table);
+            }
+            while (i > 0) {
+                i--;
+                (void)pthread_mutex_destroy
+                    (&oShardTable->shards[i].lock);
+                SymTable_free(oShardTable->shards[i].table);
+            }
+            free(oShardTable->shards);
+            free(oShardTable);
+            return NULL;
+        }
+    }
+    return oShardTable;
+}
+
+void ShardTable_free(ShardTable_T oShardTable) {
+    size_t i;
+    assert(oShardTable != NULL);
+
+    for (i = 0; i < oShardTable->shardCount; i++) {
+        (void)pthread_mutex_destroy(&oShardTable->shards[i].lock);
+        SymTable_free(oShardTable->shards[i].table);
+    }
+    free(oShardTable->shards);
+    free(oShardTable);
+}
+
+size_t ShardTable_getLength(ShardTable_T oShardTable) {
+    size_t i;
+    size_t uLength = 0;
+    assert(oShardTable != NULL);
+
+    /*sums the shards one at a time, so no writer waits on the others*/
+    for (i = 0; i < oShardTable->shardCount; i++) {
+        (void)pthread_mutex_lock(&oShardTable->shards[i].lock);
+        uLength += SymTable_getLength(oShardTable->shards[i].table);
+        (void)pthread_mutex_unlock(&oShardTable->shards[i].lock);
+    }
+    return uLength;
+}
+
+int ShardTable_put(ShardTable_T oShardTable,
+    const char *pcKey, const void *pvValue) {
+    struct Shard *shard;
+    size_t uHash;
+    int iSuccessful;
+    assert(oShardTable != NULL);
+    assert(pcKey != NULL);
+
+    /*hashes outside the lock, and only once*/
+    uHash = SymTable_hashKey(pcKey);
+    shard = ShardTable_route(oShardTable, uHash);
+    (void)pthread_mutex_lock(&shard->lock);
+    iSuccessful = SymTable_putWithHash(shard->table, pcKey, uHash,
+        pvValue);
+    (void)pthread_mutex_unlock(&shard->lock);
+    return iSuccessful;
+}
+
+void *ShardTable_replace(ShardTable_T oShardTable,
+    const char *pcKey, const void *pvValue) {
+    struct Shard *shard;
+    void *pvOldValue;
+    assert(oShardTable != NULL);
+    assert(pcKey != NULL);
+
+    shard = ShardTable_route(oShardTable, SymTable_hashKey(pcKey));
+    (void)pthread_mutex_lock(&shard->lock);
+    pvOldValue = SymTable_replace(shard->table, pcKey, pvValue);
+    (void)pthread_mutex_unlock(&shard->lock);
+    return pvOldValue;
+}
+
+int ShardTable_contains(ShardTable_T oShardTable, const char *pcKey) {
+    struct Shard *shard;
+    size_t uHash;
+    int iFound;
+    assert(oShardTable != NULL);
+    assert(pcKey != NULL);
+
+    uHash = SymTable_hashKey(pcKey);
+    shard = ShardTable_route(oShardTable, uHash);
+    (void)pthread_mutex_lock(&shard->lock);
+    iFound = SymTable_containsWithHash(shard->table, pcKey, uHash);
+    (void)pthread_mutex_unlock(&shard->lock);
+    return iFound;
+}
+
+void *ShardTable_get(ShardTable_T oShardTable, const char *pcKey) {
+    struct Shard *shard;
+    size_t uHash;
+    void *pvValue;
+    assert(oShardTable != NULL);
+    assert(pcKey != NULL);
+
+    uHash = SymTable_hashKey(pcKey);
+    shard = ShardTable_route(oShardTable, uHash);
+    (void)pthread_mutex_lock(&shard->lock);
+    pvValue = SymTable_getWithHash(shard->table, pcKey, uHash);
+    (void)pthread_mutex_unlock(&shard->lock);
+    return pvValue;
+}
+
+void *ShardTable_remove(ShardTable_T oShardTable, const char *pcKey) {
+    struct Shard *shard;
+    void *pvValue;
+    assert(oShardTable != NULL);
+    assert(pcKey != NULL);
+
+    shard = ShardTable_route(oShardTable, SymTable_hashKey(pcKey));
+    (void)pthread_mutex_lock(&shard->lock);
+    pvValue = SymTable_remove(shard->table, pcKey);
+    (void)pthread_mutex_unlock(&shard->lock);
+    return pvValue;
+}
+
+void ShardTable_map(ShardTable_T oShardTable, void (*pfApply)
+    (const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra) {
+    size_t i;
+    assert(oShardTable != NULL);
+    assert(pfApply != NULL);
+
+    for (i = 0; i < oShardTable->shardCount; i++) {
+        (void)pthread_mutex_lock(&oShardTable->shards[i].lock);
+        SymTable_map(oShardTable->shards[i].table, pfApply, pvExtra);
+        (void)pthread_mutex_unlock(&oShardTable->shards[i].lock);
+    }
+}
@@ -0,0 +1,65 @@
+/*-------------------------------------------------------------------*/
+/* shardtable.h                                                      */
+/* Author: Arnold Jiang                                              */
+/*-------------------------------------------------------------------*/
+
+#ifndef SHARDTABLE_INCLUDED
+#define SHARDTABLE_INCLUDED
+#include <stddef.h>
+
+/* A ShardTable_T object is a collection of bindings with unique
+string keys, like a SymTable_T, that many threads may use at once.
+The keys are split among independent SymTables, the shards, each
+with its own lock, so threads that touch different shards never wait
+for each other and one shard growing does not stall the rest.*/
+typedef struct ShardTable *ShardTable_T;
+
+/* returns a new empty ShardTable object with uShardCount shards,
+rounded up to a power of two no larger than 256, or NULL if
+insufficient memory is available.*/
+ShardTable_T ShardTable_new(size_t uShardCount);
+
+/* frees all memory occupied by oShardTable. No other thread may be
+using oShardTable.*/
+void ShardTable_free(ShardTable_T oShardTable);
+
+/* Returns the number of bindings in oShardTable. Bindings that other
+threads add or remove during the call may or may not be counted.*/
+size_t ShardTable_getLength(ShardTable_T oShardTable);
+
+/* Adds a new binding to oShardTable consisting of key pcKey and
+value pvValue and returns 1 (TRUE) if oShardTable does not contain
+a binding with key pcKey. Otherwise leaves oShardTable unchanged
+and returns 0 (FALSE). Also returns 0 (FALSE) if insufficient
+memory is available.*/
+int ShardTable_put(ShardTable_T oShardTable,
+    const char *pcKey, const void *pvValue);
+
+/* If oShardTable contains a binding with key pcKey, replaces the
+binding's value with pvValue and returns the old value. Otherwise
+leaves oShardTable unchanged and returns NULL.*/
+void *ShardTable_replace(ShardTable_T oShardTable,
+    const char *pcKey, const void *pvValue);
+
+/* Returns 1 (TRUE) if oShardTable contains a binding whose key is
+pcKey, and 0 (FALSE) otherwise.*/
+int ShardTable_contains(ShardTable_T oShardTable, const char *pcKey);
+
+/* Returns the value of the binding within oShardTable whose key is
+pcKey, or NULL if no such binding exists.*/
+void *ShardTable_get(ShardTable_T oShardTable, const char *pcKey);
+
+/* If oShardTable contains a binding with key pcKey, removes that
+binding from oShardTable and returns the binding's value. Otherwise
+leaves oShardTable unchanged and returns NULL.*/
+void *ShardTable_remove(ShardTable_T oShardTable, const char *pcKey);
+
+/* Applies function *pfApply to each binding in oShardTable, passing
+pvExtra as an extra parameter. The shards are visited one at a time,
+each locked while it is visited, so *pfApply must not call other
+ShardTable functions on oShardTable.*/
+void ShardTable_map(ShardTable_T oShardTable, void (*pfApply)
+(const char *pcKey, void *pvValue, void *pvExtra),
+const void *pvExtra);
+
+#endif
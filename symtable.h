@@ -6,6 +6,7 @@
 #ifndef SYMTABLE_INCLUDED
 #define SYMTABLE_INCLUDED
 #include <stddef.h>
+#include <stdio.h>
 
 /* A SymTable_T object is a an unordered collection of bindings that
 hold a unique key that is a char * (string) and a size_t value*/
@@ -15,6 +16,91 @@ typedef struct SymTable *SymTable_T;
 , or NULL if insufficient memory is available.*/
 SymTable_T SymTable_new(void);
 
+/* returns a new SymTable object like SymTable_new, except that every 
+block of memory it ever holds comes from (*pfAlloc)(uSize, 
+pvContext) and goes back through (*pfFree)(pvBlock, pvContext), 
+instead of malloc and free. pfAlloc must return NULL when it cannot 
+provide uSize bytes. The callbacks must stay usable until 
+SymTable_free(oSymTable) returns, and are called only from the 
+thread that is calling into the SymTable.*/
+SymTable_T SymTable_newWithAllocator(
+    void *(*pfAlloc)(size_t uSize, void *pvContext),
+    void (*pfFree)(void *pvBlock, void *pvContext), void *pvContext);
+
+/* returns a new SymTable object with no bindings whose values are 
+uValueSize bytes each, stored in the bindings themselves rather than 
+pointed to, or NULL if insufficient memory is available. uValueSize 
+must not be 0. Every function that takes a pvValue copies uValueSize 
+bytes from it into the table, or zeroes the value if pvValue is 
+NULL. SymTable_get and SymTable_map pass out a pointer to the stored 
+value, and the slot from SymTable_getOrInsert points to a pointer to 
+it that must not be changed; both stay valid until the next call 
+that adds or removes a binding. SymTable_replace and SymTable_remove 
+return a pointer to a copy of the old value that stays valid until 
+the next call to either of them.*/
+SymTable_T SymTable_newInline(size_t uValueSize);
+
+/* returns a new SymTable object like SymTable_new, except that it 
+packs its keys into a few large blocks instead of allocating each 
+one, and stores the part of a key up to its last '.', ':' or '/' only 
+once however many keys begin with it, or NULL if insufficient memory 
+is available. That saves memory on large tables of qualified names, 
+e.g. "com.shop.Cart.total", at some cost to lookups. The key that 
+SymTable_map, SymTable_mapParallel, SymTable_rangeMap and 
+SymTable_prefixMap pass to pfApply is valid only during the call. 
+Implementations that cannot store keys that way behave like 
+SymTable_new.*/
+SymTable_T SymTable_newCompact(void);
+
+/* returns a new SymTable object holding a binding for each of the 
+uCount keys in ppcKeys, with the value at the same index in 
+ppvValues, or NULL if insufficient memory is available. When a key 
+appears more than once, its first occurrence is kept. Up to 
+uThreadCount threads share the work; implementations that cannot 
+split it build the table with SymTable_put on the calling thread.*/
+SymTable_T SymTable_buildParallel(const char *const *ppcKeys,
+    const void *const *ppvValues, size_t uCount, size_t uThreadCount);
+
+/* returns a new SymTable object holding a binding for each line of
+the text file pcPath, or NULL if the file cannot be read, holds a
+'\0' character, or insufficient memory is available. A line holds a
+key, then cSeparator, then the value, which runs to the end of the
+line; a line without cSeparator is a key whose value is empty. A '\r'
+before the '\n' is dropped, empty lines are skipped, and nothing is
+quoted. When a key appears more than once, its first occurrence is
+kept. Each value is a string (char *) that stays valid until the
+table and all of its clones have been freed. Implementations that
+can keep the keys in the file's text instead of copying each one,
+and size the table for the file up front, do. cSeparator must not be
+'\n', '\r' or '\0'.*/
+SymTable_T SymTable_load(const char *pcPath, char cSeparator);
+
+/* returns a new SymTable object holding the same bindings as
+oSymTable, of the same kind and from the same allocator, or NULL if
+insufficient memory is available. The two tables are independent: a
+change to either is not seen by the other. They share their memory
+until one of them changes it, so a clone takes constant time & space,
+and a later change copies only the part of the table it touches.
+Because of that, a call that changes a table that shares memory may
+fail for lack of memory where it otherwise could not, in which case
+SymTable_replace and SymTable_remove return NULL and leave the table
+unchanged. A table and its clones must not be used from different
+threads at the same time. In a SymTable_newInline table, a value
+must not be changed through a pointer from SymTable_get or
+SymTable_map, which may point into memory shared with a clone; the
+slot from SymTable_getOrInsert points into memory of the table's
+own.*/
+SymTable_T SymTable_clone(SymTable_T oSymTable);
+
+/* Gives oSymTable a filter that answers most lookups of keys it does 
+not hold, such as SymTable_contains calls that fail, without 
+searching the table, at the cost of a few bits per binding and a 
+little time for every other call. Its clones keep the filter. Returns 1 
+(TRUE), or returns 0 (FALSE) and leaves oSymTable unchanged if 
+insufficient memory is available. Implementations that have no use 
+for a filter return 1 (TRUE) and do nothing.*/
+int SymTable_addFilter(SymTable_T oSymTable);
+
 /* frees all memory occupied by oSymTable. */
 void SymTable_free(SymTable_T oSymTable);
 
@@ -34,6 +120,23 @@ unchanged and returns NULL. */
 void *SymTable_replace(SymTable_T oSymTable,
     const char *pcKey, const void *pvValue);
 
+/* If oSymTable contains a binding with key pcKey, replaces the 
+binding's value with pvValue; otherwise adds a binding with key 
+pcKey and value pvValue. Either way only one lookup is made. Returns 
+1 (TRUE), or returns 0 (FALSE) and leaves oSymTable unchanged if 
+insufficient memory is available.*/
+int SymTable_upsert(SymTable_T oSymTable,
+    const char *pcKey, const void *pvValue);
+
+/* Returns a pointer to the slot that holds the value of the binding 
+in oSymTable whose key is pcKey, first adding a binding with key 
+pcKey and value pvValue if there is none, so that the value can be 
+read and updated in place with one lookup. The pointer is valid 
+until the next call that adds or removes a binding of oSymTable. 
+Returns NULL if insufficient memory is available.*/
+void **SymTable_getOrInsert(SymTable_T oSymTable,
+    const char *pcKey, const void *pvValue);
+
 /* Takes in an oSymtable and a binding whose key is pcKey. Returns 1 
 (TRUE) if there exists a oSymTable that contains a binding whose key 
 is pcKey, and returns 0 (FALSE) otherwise.*/
@@ -44,12 +147,109 @@ Returns the value of the binding within oSymTable whose key
 is pcKey, or returns NULL if no such binding exists.*/
 void *SymTable_get(SymTable_T oSymTable, const char *pcKey);
 
+/* Returns the value of the binding with key pcKey in the first of 
+the uCount tables at poSymTables that has one, and sets *puWhich to 
+that table's index, or returns NULL and sets *puWhich to uCount if 
+none of them has one. puWhich may be NULL. Behaves like SymTable_get 
+on each table in turn, except that implementations that can hash 
+pcKey once for all the tables, and fetch the memory of the next table 
+while searching the current one, do.*/
+void *SymTable_getFirst(SymTable_T *poSymTables, size_t uCount,
+    const char *pcKey, size_t *puWhich);
+
 /* If oSymTable contains a binding with key pcKey, then 
 the function removes that binding from oSymTable and 
 return the binding's value. Otherwise the function doesn't 
 change oSymTable and returns NULL.*/
 void *SymTable_remove(SymTable_T oSymTable, const char *pcKey);
 
+/* Opens a transaction on oSymTable, which must not have one open. 
+Until SymTable_commit or SymTable_rollback ends it, the table changes 
+as usual and its lookups see those changes, but the table must not be 
+cloned. Returns 1 (TRUE), or returns 0 (FALSE) and opens no 
+transaction if insufficient memory is available. A call that changes 
+the table during a transaction may fail for lack of memory where it 
+otherwise could not, in which case it leaves the table unchanged. 
+Implementations may put off work such as growing the table until the 
+transaction ends.*/
+int SymTable_beginTxn(SymTable_T oSymTable);
+
+/* Ends the open transaction of oSymTable, keeping every change made 
+since SymTable_beginTxn.*/
+void SymTable_commit(SymTable_T oSymTable);
+
+/* Ends the open transaction of oSymTable, taking back every change 
+made through its functions since SymTable_beginTxn, so that it holds 
+the same bindings as before. Values pointed to by the table are not 
+restored, nor are those of a SymTable_newInline table that were 
+changed through a pointer from SymTable_get or SymTable_map. Never 
+fails for lack of memory.*/
+void SymTable_rollback(SymTable_T oSymTable);
+
+/* Writes to psFile what calls into every table of the program have 
+cost so far: for each operation, how often it was called and, of the 
+calls that were timed, the median, 99th & 99.9th percentile and 
+longest latencies, followed by the most recent resizes and how long 
+they took. Implementations record this only when compiled with 
+SYMTABLE_PROFILE defined, and otherwise write a line that says so.*/
+void SymTable_dumpProfile(FILE *psFile);
+
+/* Returns the hash code of pcKey. The same key always has the same 
+hash code, so callers that already hashed a key, such as a lexer, 
+can pass the code to the WithHash functions below instead of having 
+it recomputed. Codes may be keyed with a secret chosen when the 
+program starts, so they differ from one run to the next and must not 
+be saved or sent elsewhere.*/
+size_t SymTable_hashKey(const char *pcKey);
+
+/* Behaves like SymTable_put, where uHash must be 
+SymTable_hashKey(pcKey).*/
+int SymTable_putWithHash(SymTable_T oSymTable,
+    const char *pcKey, size_t uHash, const void *pvValue);
+
+/* Behaves like SymTable_contains, where uHash must be 
+SymTable_hashKey(pcKey).*/
+int SymTable_containsWithHash(SymTable_T oSymTable,
+    const char *pcKey, size_t uHash);
+
+/* Behaves like SymTable_get, where uHash must be 
+SymTable_hashKey(pcKey).*/
+void *SymTable_getWithHash(SymTable_T oSymTable,
+    const char *pcKey, size_t uHash);
+
+/* The N functions below take a key as the uLength characters at 
+pcKey instead of as a string, so that a key can be looked up in 
+place, e.g. in a source buffer, without copying it. Those characters 
+must not include '\0'; such a key is the same key as the string 
+holding the same characters.*/
+
+/* Returns the hash code of the uLength characters at pcKey, which 
+equals SymTable_hashKey of the same key as a string.*/
+size_t SymTable_hashKeyN(const char *pcKey, size_t uLength);
+
+/* Behaves like SymTable_put for the uLength characters at pcKey.*/
+int SymTable_putN(SymTable_T oSymTable, const char *pcKey,
+    size_t uLength, const void *pvValue);
+
+/* Behaves like SymTable_replace for the uLength characters at 
+pcKey.*/
+void *SymTable_replaceN(SymTable_T oSymTable, const char *pcKey,
+    size_t uLength, const void *pvValue);
+
+/* Behaves like SymTable_contains for the uLength characters at 
+pcKey.*/
+int SymTable_containsN(SymTable_T oSymTable, const char *pcKey,
+    size_t uLength);
+
+/* Behaves like SymTable_get for the uLength characters at pcKey.*/
+void *SymTable_getN(SymTable_T oSymTable, const char *pcKey,
+    size_t uLength);
+
+/* Behaves like SymTable_remove for the uLength characters at 
+pcKey.*/
+void *SymTable_removeN(SymTable_T oSymTable, const char *pcKey,
+    size_t uLength);
+
 /* Apply function *pfApply to each binding in oSymTable, 
 passing pvExtra as an extra parameter. That is, the function 
 calls (*pfApply)(pcKey, pvValue, pvExtra) for each pcKey/pvValue 
@@ -58,4 +258,33 @@ void SymTable_map(SymTable_T oSymTable, void (*pfApply)
 (const char *pcKey, void *pvValue, void *pvExtra), 
 const void *pvExtra);
 
+/* Behaves like SymTable_map, but may apply *pfApply from up to 
+uThreadCount threads at once, each to different bindings, and in no 
+particular order. *pfApply must therefore be safe to call 
+concurrently, and oSymTable must not change until the call returns. 
+Implementations that cannot split the work behave like 
+SymTable_map.*/
+void SymTable_mapParallel(SymTable_T oSymTable, void (*pfApply)
+(const char *pcKey, void *pvValue, void *pvExtra), 
+const void *pvExtra, size_t uThreadCount);
+
+/* Apply function *pfApply to each binding in oSymTable whose key 
+is greater than or equal to pcLo and less than pcHi (as ordered by 
+strcmp), passing pvExtra as an extra parameter. A NULL pcLo or pcHi 
+leaves that end of the range unbounded. Ordered implementations 
+visit the bindings in ascending key order; others visit them in no 
+particular order.*/
+void SymTable_rangeMap(SymTable_T oSymTable, const char *pcLo,
+const char *pcHi, void (*pfApply)
+(const char *pcKey, void *pvValue, void *pvExtra), 
+const void *pvExtra);
+
+/* Apply function *pfApply to each binding in oSymTable whose key 
+begins with pcPrefix, passing pvExtra as an extra parameter. Ordered 
+implementations visit the bindings in ascending key order; others 
+visit them in no particular order.*/
+void SymTable_prefixMap(SymTable_T oSymTable, const char *pcPrefix,
+void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra), 
+const void *pvExtra);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,1369 @@
+/*-------------------------------------------------------------------*/
+/* symtablebtree.c                                                   */
+/* Author: Arnold Jiang                                              */
+/*-------------------------------------------------------------------*/
+
+#include "symtable.h"
+#include <assert.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/*defines FALSE (0) and TRUE (1)*/
+enum {FALSE, TRUE};
+
+/*minimum degree of the B-tree: every node other than the root holds
+between MIN_DEGREE - 1 and MAX_KEYS keys*/
+enum {MIN_DEGREE = 16, MAX_KEYS = 2 * MIN_DEGREE - 1};
+
+/* A Node of the B-tree holds keyCount sorted keys together with
+their values. An internal node also holds keyCount + 1 children,
+where every key in children[i] sorts between keys[i-1] and keys[i].
+Leaves are allocated without the children array. A table and its 
+clones share nodes, and a table copies a shared node before it 
+changes it*/
+struct Node {
+    /*tracks the number of tables & nodes that point to the node*/
+    size_t refCount;
+    /*tracks the number of keys in the node*/
+    size_t keyCount;
+    /*TRUE if the node has no children*/
+    int isLeaf;
+    /*points to strings that represent the keys, in ascending order*/
+    char *keys[MAX_KEYS];
+    /*points to the value of each key*/
+    const void *values[MAX_KEYS];
+    /*points to the children of an internal node*/
+    struct Node *children[MAX_KEYS + 1];
+};
+
+/* A SymTable structure is a "manager" structure that points to the
+root of a B-tree and contains a counter that maintains the number
+of binds, along with the allocator that all its memory comes from.
+The root is not allocated until the first binding is put. A table 
+made by SymTable_load keeps the values from its file in a pool*/
+struct SymTable {
+    /*points to the root node, NULL while the table is empty*/
+    struct Node *root;
+    /*tracks the number of binds*/
+    size_t counter;
+    /*allocates & frees memory, given pvContext*/
+    void *(*pfAlloc)(size_t uSize, void *pvContext);
+    void (*pfFree)(void *pvBlock, void *pvContext);
+    void *pvContext;
+    /*bytes in each value stored by the table, or 0 if the table 
+    holds pointers to values. A stored value shares one block with 
+    its key, which follows the value padded to valueRoom bytes*/
+    size_t valueSize;
+    size_t valueRoom;
+    /*holds a copy of the value that the last replace or remove took
+    out of an inline table, or is NULL*/
+    void *oldValue;
+    /*points to the text of the file that the table was loaded from, 
+    or is NULL*/
+    struct Pool *pool;
+    /*points to a clone taken when the open transaction began, or is
+    NULL while no transaction is open*/
+    struct SymTable *snapshot;
+};
+
+/* A Pool holds the text of a file that SymTable_load read, which the 
+values of its lines point into. The text follows the header in the 
+same block, with its lines ended in place. A table and its clones 
+share the pool, so it is freed by the last of them to be freed*/
+struct Pool {
+    /*number of tables that read the pool*/
+    size_t refCount;
+};
+
+/* Bounds of an in-order walk: keys from pcLo (inclusive) up to pcHi
+(exclusive), or only keys that begin with the first uPrefixLength
+characters of pcLo when uPrefixLength is nonzero*/
+struct Bounds {
+    /*lowest key to visit, or NULL to start at the smallest key*/
+    const char *pcLo;
+    /*length of pcLo*/
+    size_t uLoLength;
+    /*key at which to stop, or NULL to run to the largest key*/
+    const char *pcHi;
+    /*length of the prefix in pcLo that every key must share*/
+    size_t uPrefixLength;
+};
+
+/* Returns uSize bytes from malloc. pvContext is unused. */
+static void *SymTable_defaultAlloc(size_t uSize, void *pvContext) {
+    (void)pvContext;
+    return malloc(uSize);
+}
+
+/* Returns pvBlock to free. pvContext is unused. */
+static void SymTable_defaultFree(void *pvBlock, void *pvContext) {
+    (void)pvContext;
+    free(pvBlock);
+}
+
+/* Returns uSize bytes from the allocator of oSymTable, or NULL if 
+   insufficient memory is available. */
+static void *SymTable_alloc(SymTable_T oSymTable, size_t uSize) {
+    assert(oSymTable != NULL);
+    return (*oSymTable->pfAlloc)(uSize, oSymTable->pvContext);
+}
+
+/* Returns pvBlock to the allocator of oSymTable. */
+static void SymTable_release(SymTable_T oSymTable, void *pvBlock) {
+    assert(oSymTable != NULL);
+    (*oSymTable->pfFree)(pvBlock, oSymTable->pvContext);
+}
+
+/* Returns a new node of oSymTable with no keys that is a leaf if 
+   iIsLeaf is TRUE, or NULL if insufficient memory is available. */
+static struct Node *SymTable_newNode(SymTable_T oSymTable,
+    int iIsLeaf) {
+    struct Node *node;
+
+    /*leaves never use their children, so that part is not allocated*/
+    if (iIsLeaf) {
+        node = (struct Node*)SymTable_alloc(oSymTable,
+            offsetof(struct Node, children));
+    }
+    else {
+        node = (struct Node*)SymTable_alloc(oSymTable,
+            sizeof(struct Node));
+    }
+    if (node == NULL) {
+        return NULL;
+    }
+    node->refCount = 1;
+    node->keyCount = 0;
+    node->isLeaf = iIsLeaf;
+    return node;
+}
+
+/* Frees the key pcKey of oSymTable and, in an inline table, the 
+   value pvValue that shares its block. */
+static void SymTable_freeBinding(SymTable_T oSymTable, char *pcKey,
+    const void *pvValue) {
+    assert(oSymTable != NULL);
+    if (oSymTable->valueSize == 0) {
+        SymTable_release(oSymTable, pcKey);
+    }
+    else {
+        SymTable_release(oSymTable, (void*)pvValue);
+    }
+}
+
+/* Stores pvValue in *ppvSlot, the value slot of a binding of 
+   oSymTable. An inline table copies the value into the storage that 
+   *ppvSlot points to, or zeroes it if pvValue is NULL. */
+static void SymTable_setValue(SymTable_T oSymTable,
+    const void **ppvSlot, const void *pvValue) {
+    assert(oSymTable != NULL);
+    assert(ppvSlot != NULL);
+    if (oSymTable->valueSize == 0) {
+        *ppvSlot = pvValue;
+    }
+    else if (pvValue == NULL) {
+        memset((void*)*ppvSlot, 0, oSymTable->valueSize);
+    }
+    else {
+        memcpy((void*)*ppvSlot, pvValue, oSymTable->valueSize);
+    }
+}
+
+/* Returns the value pvValue of oSymTable as a replace or remove 
+   hands it back: the pointer itself, or in an inline table a copy 
+   in the table's old value. */
+static void *SymTable_saveValue(SymTable_T oSymTable,
+    const void *pvValue) {
+    assert(oSymTable != NULL);
+    if (oSymTable->valueSize == 0) {
+        return (void*)pvValue;
+    }
+    memcpy(oSymTable->oldValue, pvValue, oSymTable->valueSize);
+    return oSymTable->oldValue;
+}
+
+/* Drops a reference to node of oSymTable and, once nothing else 
+   points to it, frees it, every node below it that nothing else 
+   points to, and all of their keys. */
+static void SymTable_freeNode(SymTable_T oSymTable, struct Node *node) {
+    size_t i;
+    assert(node != NULL);
+    assert(node->refCount > 0);
+    node->refCount--;
+    if (node->refCount > 0) {
+        return;
+    }
+    for (i = 0; i < node->keyCount; i++) {
+        SymTable_freeBinding(oSymTable, node->keys[i],
+            node->values[i]);
+    }
+    if (!node->isLeaf) {
+        for (i = 0; i <= node->keyCount; i++) {
+            SymTable_freeNode(oSymTable, node->children[i]);
+        }
+    }
+    SymTable_release(oSymTable, node);
+}
+
+/* Returns a new node of oSymTable that holds copies of the keys & 
+   values of node and points to the same children, or NULL if 
+   insufficient memory is available. */
+static struct Node *SymTable_copyNode(SymTable_T oSymTable,
+    struct Node *node) {
+    struct Node *copy;
+    char *block;
+    size_t uSize;
+    size_t i;
+    assert(node != NULL);
+
+    copy = SymTable_newNode(oSymTable, node->isLeaf);
+    if (copy == NULL) {
+        return NULL;
+    }
+
+    /*a key shares its block with an inline value, which comes first*/
+    for (i = 0; i < node->keyCount; i++) {
+        uSize = oSymTable->valueRoom + strlen(node->keys[i]) + 1;
+        block = SymTable_alloc(oSymTable, uSize);
+        if (block == NULL) {
+            while (i > 0) {
+                i--;
+                SymTable_freeBinding(oSymTable, copy->keys[i],
+                    copy->values[i]);
+            }
+            SymTable_release(oSymTable, copy);
+            return NULL;
+        }
+        memcpy(block, node->keys[i] - oSymTable->valueRoom, uSize);
+        copy->keys[i] = block + oSymTable->valueRoom;
+        copy->values[i] = oSymTable->valueSize == 0 ? node->values[i] :
+            block;
+    }
+    copy->keyCount = node->keyCount;
+    if (!node->isLeaf) {
+        for (i = 0; i <= node->keyCount; i++) {
+            copy->children[i] = node->children[i];
+            copy->children[i]->refCount++;
+        }
+    }
+    return copy;
+}
+
+/* Returns the child at index i of parent, a node of oSymTable that 
+   the table owns alone, after replacing it with a copy if a clone 
+   shares it, so that it can be changed. Returns NULL if insufficient 
+   memory is available. */
+static struct Node *SymTable_ownChild(SymTable_T oSymTable,
+    struct Node *parent, size_t i) {
+    struct Node *child;
+    struct Node *copy;
+    assert(parent != NULL);
+    assert(parent->refCount == 1);
+    child = parent->children[i];
+    if (child->refCount == 1) {
+        return child;
+    }
+    copy = SymTable_copyNode(oSymTable, child);
+    if (copy == NULL) {
+        return NULL;
+    }
+    child->refCount--;
+    parent->children[i] = copy;
+    return copy;
+}
+
+/* Replaces the root of oSymTable with a copy if a clone shares it, 
+   so that it can be changed. Returns FALSE if insufficient memory is 
+   available and TRUE otherwise. */
+static int SymTable_ownRoot(SymTable_T oSymTable) {
+    struct Node *copy;
+    assert(oSymTable != NULL);
+    if (oSymTable->root == NULL || oSymTable->root->refCount == 1) {
+        return TRUE;
+    }
+    copy = SymTable_copyNode(oSymTable, oSymTable->root);
+    if (copy == NULL) {
+        return FALSE;
+    }
+    oSymTable->root->refCount--;
+    oSymTable->root = copy;
+    return TRUE;
+}
+
+/* Compares the string pcStored with the key made of the uLength
+   characters at pcKey, which contain no '\0', in strcmp order.
+   Returns a negative number, 0, or a positive number if pcStored is
+   less than, equal to, or greater than the key. */
+static int SymTable_compare(const char *pcStored, const char *pcKey,
+    size_t uLength) {
+    int cmp;
+    assert(pcStored != NULL);
+    assert(pcKey != NULL);
+    cmp = strncmp(pcStored, pcKey, uLength);
+    if (cmp != 0) {
+        return cmp;
+    }
+
+    /*pcStored matches the whole key, so it is either the key itself
+    or a longer string that the key is a prefix of*/
+    return pcStored[uLength] != '\0';
+}
+
+/* Returns the index of the first key in node that is greater than or
+   equal to the uLength characters at pcKey, or node->keyCount if
+   there is none. Sets *piFound to TRUE if that key is equal to the
+   characters at pcKey and FALSE otherwise. */
+static size_t SymTable_search(struct Node *node, const char *pcKey,
+    size_t uLength, int *piFound) {
+    size_t lo;
+    size_t hi;
+    size_t mid;
+    int cmp;
+    assert(node != NULL);
+    assert(pcKey != NULL);
+    assert(piFound != NULL);
+    lo = 0;
+    hi = node->keyCount;
+    *piFound = FALSE;
+
+    /*binary search over the sorted keys*/
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        cmp = SymTable_compare(node->keys[mid], pcKey, uLength);
+        if (cmp == 0) {
+            *piFound = TRUE;
+            return mid;
+        }
+        if (cmp < 0) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/* Returns the node of oSymTable that holds the key made of the
+   uLength characters at pcKey and sets *puIndex to the key's index in
+   it, or returns NULL if there is no such key. */
+static struct Node *SymTable_find(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength, size_t *puIndex) {
+    struct Node *node;
+    size_t i;
+    int iFound;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    assert(puIndex != NULL);
+    for (node = oSymTable->root; node != NULL;
+        node = node->children[i]) {
+        i = SymTable_search(node, pcKey, uLength, &iFound);
+        if (iFound) {
+            *puIndex = i;
+            return node;
+        }
+        if (node->isLeaf) {
+            return NULL;
+        }
+    }
+    return NULL;
+}
+
+/* Returns the node of oSymTable that holds the key made of the
+   uLength characters at pcKey and sets *puIndex to the key's index in
+   it, like SymTable_find, but first copies every node on the way 
+   that a clone shares, so that the binding can be changed. Returns 
+   NULL if there is no such key or if insufficient memory is 
+   available. */
+static struct Node *SymTable_findOwned(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength, size_t *puIndex) {
+    struct Node *node;
+    size_t i;
+    int iFound;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    assert(puIndex != NULL);
+    if (oSymTable->root == NULL || !SymTable_ownRoot(oSymTable)) {
+        return NULL;
+    }
+    node = oSymTable->root;
+    for (;;) {
+        i = SymTable_search(node, pcKey, uLength, &iFound);
+        if (iFound) {
+            *puIndex = i;
+            return node;
+        }
+        if (node->isLeaf) {
+            return NULL;
+        }
+        node = SymTable_ownChild(oSymTable, node, i);
+        if (node == NULL) {
+            return NULL;
+        }
+    }
+}
+
+/* Splits the full child at index i of parent, a node of oSymTable, 
+   into two nodes holding MIN_DEGREE - 1 keys each, and moves the 
+   median key up into parent, which must not be full. Returns FALSE, 
+   leaving parent unchanged, if insufficient memory is available, 
+   and TRUE otherwise. */
+static int SymTable_splitChild(SymTable_T oSymTable,
+    struct Node *parent, size_t i) {
+    struct Node *full;
+    struct Node *right;
+    size_t j;
+    assert(parent != NULL);
+    assert(parent->keyCount < MAX_KEYS);
+    full = parent->children[i];
+    assert(full->keyCount == MAX_KEYS);
+
+    right = SymTable_newNode(oSymTable, full->isLeaf);
+    if (right == NULL) {
+        return FALSE;
+    }
+
+    /*moves the upper half of the keys & children into right*/
+    for (j = 0; j < MIN_DEGREE - 1; j++) {
+        right->keys[j] = full->keys[j + MIN_DEGREE];
+        right->values[j] = full->values[j + MIN_DEGREE];
+    }
+    if (!full->isLeaf) {
+        for (j = 0; j < MIN_DEGREE; j++) {
+            right->children[j] = full->children[j + MIN_DEGREE];
+        }
+    }
+    right->keyCount = MIN_DEGREE - 1;
+    full->keyCount = MIN_DEGREE - 1;
+
+    /*makes room in parent for the median key & the new child*/
+    for (j = parent->keyCount; j > i; j--) {
+        parent->keys[j] = parent->keys[j - 1];
+        parent->values[j] = parent->values[j - 1];
+        parent->children[j + 1] = parent->children[j];
+    }
+    parent->keys[i] = full->keys[MIN_DEGREE - 1];
+    parent->values[i] = full->values[MIN_DEGREE - 1];
+    parent->children[i + 1] = right;
+    parent->keyCount++;
+    return TRUE;
+}
+
+/* Merges the child at index i + 1 of parent, a node of oSymTable, 
+   and the key at index i of parent into the child at index i, and 
+   frees the emptied child. */
+static void SymTable_mergeChildren(SymTable_T oSymTable,
+    struct Node *parent, size_t i) {
+    struct Node *left;
+    struct Node *right;
+    size_t j;
+    assert(parent != NULL);
+    assert(i < parent->keyCount);
+    left = parent->children[i];
+    right = parent->children[i + 1];
+    assert(left->keyCount + right->keyCount < MAX_KEYS);
+
+    /*pulls the separating key down, then appends right's contents*/
+    left->keys[left->keyCount] = parent->keys[i];
+    left->values[left->keyCount] = parent->values[i];
+    for (j = 0; j < right->keyCount; j++) {
+        left->keys[left->keyCount + 1 + j] = right->keys[j];
+        left->values[left->keyCount + 1 + j] = right->values[j];
+    }
+    if (!left->isLeaf) {
+        for (j = 0; j <= right->keyCount; j++) {
+            left->children[left->keyCount + 1 + j] =
+                right->children[j];
+        }
+    }
+    left->keyCount += right->keyCount + 1;
+
+    /*closes the gap in parent*/
+    for (j = i; j + 1 < parent->keyCount; j++) {
+        parent->keys[j] = parent->keys[j + 1];
+        parent->values[j] = parent->values[j + 1];
+        parent->children[j + 1] = parent->children[j + 2];
+    }
+    parent->keyCount--;
+    SymTable_release(oSymTable, right);
+}
+
+/* Makes sure that the child at index i of parent, a node of 
+   oSymTable, holds at least MIN_DEGREE keys by borrowing a key from 
+   a sibling or merging with one. Returns the index in parent of the 
+   child that now covers the keys the original child covered. */
+static size_t SymTable_fillChild(SymTable_T oSymTable,
+    struct Node *parent, size_t i) {
+    struct Node *child;
+    struct Node *sibling;
+    size_t j;
+    assert(parent != NULL);
+    child = parent->children[i];
+
+    /*borrows the last key of the left sibling through parent*/
+    if (i > 0 && parent->children[i - 1]->keyCount >= MIN_DEGREE) {
+        sibling = parent->children[i - 1];
+        for (j = child->keyCount; j > 0; j--) {
+            child->keys[j] = child->keys[j - 1];
+            child->values[j] = child->values[j - 1];
+        }
+        if (!child->isLeaf) {
+            for (j = child->keyCount + 1; j > 0; j--) {
+                child->children[j] = child->children[j - 1];
+            }
+            child->children[0] = sibling->children[sibling->keyCount];
+        }
+        child->keys[0] = parent->keys[i - 1];
+        child->values[0] = parent->values[i - 1];
+        child->keyCount++;
+        parent->keys[i - 1] = sibling->keys[sibling->keyCount - 1];
+        parent->values[i - 1] = sibling->values[sibling->keyCount - 1];
+        sibling->keyCount--;
+        return i;
+    }
+
+    /*borrows the first key of the right sibling through parent*/
+    if (i < parent->keyCount &&
+        parent->children[i + 1]->keyCount >= MIN_DEGREE) {
+        sibling = parent->children[i + 1];
+        child->keys[child->keyCount] = parent->keys[i];
+        child->values[child->keyCount] = parent->values[i];
+        if (!child->isLeaf) {
+            child->children[child->keyCount + 1] =
+                sibling->children[0];
+            for (j = 0; j < sibling->keyCount; j++) {
+                sibling->children[j] = sibling->children[j + 1];
+            }
+        }
+        child->keyCount++;
+        parent->keys[i] = sibling->keys[0];
+        parent->values[i] = sibling->values[0];
+        for (j = 0; j + 1 < sibling->keyCount; j++) {
+            sibling->keys[j] = sibling->keys[j + 1];
+            sibling->values[j] = sibling->values[j + 1];
+        }
+        sibling->keyCount--;
+        return i;
+    }
+
+    /*neither sibling can spare a key, so merges with one of them*/
+    if (i < parent->keyCount) {
+        SymTable_mergeChildren(oSymTable, parent, i);
+        return i;
+    }
+    SymTable_mergeChildren(oSymTable, parent, i - 1);
+    return i - 1;
+}
+
+/* Removes the key made of the uLength characters at pcKey from the
+   subtree of oSymTable rooted at node, which the table must own 
+   alone and which must hold at least MIN_DEGREE keys unless it is 
+   the root. If found, stores the removed key's string in *ppcKey 
+   and its value in *ppvValue without freeing either, and returns 
+   TRUE. Otherwise, or if there is not enough memory to copy a node 
+   shared with a clone, returns FALSE; the subtree may have been 
+   rebalanced either way. */
+static int SymTable_delete(SymTable_T oSymTable, struct Node *node,
+    const char *pcKey, size_t uLength, char **ppcKey,
+    const void **ppvValue) {
+    struct Node *child;
+    size_t i;
+    size_t j;
+    int iFound;
+    assert(node != NULL);
+    assert(pcKey != NULL);
+    assert(ppcKey != NULL);
+    assert(ppvValue != NULL);
+
+    for (;;) {
+        i = SymTable_search(node, pcKey, uLength, &iFound);
+
+        /*handles the key being in a leaf*/
+        if (iFound && node->isLeaf) {
+            *ppcKey = node->keys[i];
+            *ppvValue = node->values[i];
+            for (j = i; j + 1 < node->keyCount; j++) {
+                node->keys[j] = node->keys[j + 1];
+                node->values[j] = node->values[j + 1];
+            }
+            node->keyCount--;
+            return TRUE;
+        }
+
+        /*handles the key being in an internal node: it is swapped
+        with its predecessor or successor, which lives in a leaf*/
+        if (iFound) {
+            if (SymTable_ownChild(oSymTable, node, i) == NULL ||
+                SymTable_ownChild(oSymTable, node, i + 1) == NULL) {
+                return FALSE;
+            }
+            *ppcKey = node->keys[i];
+            *ppvValue = node->values[i];
+            if (node->children[i]->keyCount >= MIN_DEGREE) {
+                child = node->children[i];
+                while (!child->isLeaf) {
+                    child = child->children[child->keyCount];
+                }
+                return SymTable_delete(oSymTable, node->children[i],
+                    child->keys[child->keyCount - 1],
+                    strlen(child->keys[child->keyCount - 1]),
+                    &node->keys[i], &node->values[i]);
+            }
+            if (node->children[i + 1]->keyCount >= MIN_DEGREE) {
+                child = node->children[i + 1];
+                while (!child->isLeaf) {
+                    child = child->children[0];
+                }
+                return SymTable_delete(oSymTable, node->children[i + 1],
+                    child->keys[0], strlen(child->keys[0]),
+                    &node->keys[i], &node->values[i]);
+            }
+
+            /*both neighbours are minimal: merge them around the key
+            and keep descending into the merged node*/
+            SymTable_mergeChildren(oSymTable, node, i);
+            node = node->children[i];
+            continue;
+        }
+
+        if (node->isLeaf) {
+            return FALSE;
+        }
+
+        /*descends only into a child that can afford to lose a key,
+        after copying whichever nodes a clone shares and this step
+        changes*/
+        if (SymTable_ownChild(oSymTable, node, i) == NULL) {
+            return FALSE;
+        }
+        if (node->children[i]->keyCount < MIN_DEGREE) {
+            if ((i > 0 &&
+                SymTable_ownChild(oSymTable, node, i - 1) == NULL) ||
+                (i < node->keyCount &&
+                SymTable_ownChild(oSymTable, node, i + 1) == NULL)) {
+                return FALSE;
+            }
+            i = SymTable_fillChild(oSymTable, node, i);
+        }
+        node = node->children[i];
+    }
+}
+
+/* Visits, in ascending order, the keys of the subtree rooted at node
+   that lie within *psBounds, applying *pfApply to each. Returns FALSE
+   once a key beyond the bounds is reached and TRUE otherwise. */
+static int SymTable_walk(struct Node *node,
+    const struct Bounds *psBounds, void (*pfApply)
+    (const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra) {
+    size_t i;
+    int iFound;
+    assert(node != NULL);
+    assert(psBounds != NULL);
+    assert(pfApply != NULL);
+
+    /*skips every key & child that sorts before the lower bound*/
+    if (psBounds->pcLo != NULL) {
+        i = SymTable_search(node, psBounds->pcLo, psBounds->uLoLength,
+            &iFound);
+    }
+    else {
+        i = 0;
+    }
+
+    for (;; i++) {
+        if (!node->isLeaf &&
+            !SymTable_walk(node->children[i], psBounds, pfApply,
+            pvExtra)) {
+            return FALSE;
+        }
+        if (i == node->keyCount) {
+            return TRUE;
+        }
+        if (psBounds->pcHi != NULL &&
+            strcmp(node->keys[i], psBounds->pcHi) >= 0) {
+            return FALSE;
+        }
+        if (psBounds->uPrefixLength != 0 &&
+            strncmp(node->keys[i], psBounds->pcLo,
+            psBounds->uPrefixLength) != 0) {
+            return FALSE;
+        }
+        (*pfApply)((void*)node->keys[i], (void*)node->values[i],
+            (void*)pvExtra);
+    }
+}
+
+/* Returns a new SymTable with no bindings whose memory comes from 
+   pfAlloc & pfFree with pvContext, and that stores values of 
+   uValueSize bytes, or pointers to values if uValueSize is 0. 
+   Returns NULL if insufficient memory is available. */
+static SymTable_T SymTable_create(
+    void *(*pfAlloc)(size_t uSize, void *pvContext),
+    void (*pfFree)(void *pvBlock, void *pvContext), void *pvContext,
+    size_t uValueSize) {
+    SymTable_T oSymTable;
+    assert(pfAlloc != NULL);
+    assert(pfFree != NULL);
+
+    /*allocates memory for a new SymTable*/
+    oSymTable = (SymTable_T)(*pfAlloc)(sizeof(struct SymTable),
+        pvContext);
+    if (oSymTable == NULL) {
+        return NULL;
+    }
+
+    /*the root is allocated lazily by the first SymTable_put*/
+    oSymTable->root = NULL;
+    oSymTable->pool = NULL;
+    oSymTable->snapshot = NULL;
+    oSymTable->counter = 0;
+    oSymTable->pfAlloc = pfAlloc;
+    oSymTable->pfFree = pfFree;
+    oSymTable->pvContext = pvContext;
+    oSymTable->valueSize = uValueSize;
+    oSymTable->valueRoom = (uValueSize + sizeof(void*) - 1) /
+        sizeof(void*) * sizeof(void*);
+    oSymTable->oldValue = NULL;
+    if (uValueSize > 0) {
+        oSymTable->oldValue = (*pfAlloc)(uValueSize, pvContext);
+        if (oSymTable->oldValue == NULL) {
+            (*pfFree)(oSymTable, pvContext);
+            return NULL;
+        }
+    }
+    return oSymTable;
+}
+
+SymTable_T SymTable_new(void) {
+    return SymTable_create(SymTable_defaultAlloc, SymTable_defaultFree,
+        NULL, 0);
+}
+
+SymTable_T SymTable_newWithAllocator(
+    void *(*pfAlloc)(size_t uSize, void *pvContext),
+    void (*pfFree)(void *pvBlock, void *pvContext), void *pvContext) {
+    return SymTable_create(pfAlloc, pfFree, pvContext, 0);
+}
+
+SymTable_T SymTable_newInline(size_t uValueSize) {
+    assert(uValueSize > 0);
+    return SymTable_create(SymTable_defaultAlloc, SymTable_defaultFree,
+        NULL, uValueSize);
+}
+
+/* A B-tree keeps every key whole, so a compact table is an ordinary 
+   one. */
+SymTable_T SymTable_newCompact(void) {
+    return SymTable_new();
+}
+
+/* A B-tree finds a missing key in a few node visits, so it goes 
+   without a filter. */
+int SymTable_addFilter(SymTable_T oSymTable) {
+    assert(oSymTable != NULL);
+    return TRUE;
+}
+
+void SymTable_free(SymTable_T oSymTable) {
+    assert(oSymTable != NULL);
+    if (oSymTable->snapshot != NULL) {
+        SymTable_free(oSymTable->snapshot);
+    }
+    if (oSymTable->root != NULL) {
+        SymTable_freeNode(oSymTable, oSymTable->root);
+    }
+    if (oSymTable->pool != NULL) {
+        oSymTable->pool->refCount--;
+        if (oSymTable->pool->refCount == 0) {
+            SymTable_release(oSymTable, oSymTable->pool);
+        }
+    }
+    SymTable_release(oSymTable, oSymTable->oldValue);
+    SymTable_release(oSymTable, oSymTable);
+}
+
+SymTable_T SymTable_clone(SymTable_T oSymTable) {
+    SymTable_T copy;
+    assert(oSymTable != NULL);
+    assert(oSymTable->snapshot == NULL);
+    copy = SymTable_create(oSymTable->pfAlloc, oSymTable->pfFree,
+        oSymTable->pvContext, oSymTable->valueSize);
+    if (copy == NULL) {
+        return NULL;
+    }
+
+    /*the clone points to the same root, and either table copies the
+    nodes it changes from then on*/
+    copy->root = oSymTable->root;
+    if (copy->root != NULL) {
+        copy->root->refCount++;
+    }
+    copy->counter = oSymTable->counter;
+
+    /*values in the pool must outlive every table that holds them*/
+    copy->pool = oSymTable->pool;
+    if (copy->pool != NULL) {
+        copy->pool->refCount++;
+    }
+    return copy;
+}
+
+size_t SymTable_getLength(SymTable_T oSymTable) {
+    assert(oSymTable != NULL);
+    return oSymTable->counter;
+}
+
+/* Returns the slot that holds the value of the binding of oSymTable
+   whose key is the uLength characters at pcKey. If there is no such
+   binding, first adds one whose value is pvValue. Sets *piAdded to
+   TRUE if the binding was added and FALSE otherwise. Returns NULL if
+   insufficient memory is available, in which case the tree may have
+   been rebalanced but no binding was added. */
+static const void **SymTable_findOrAdd(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength, const void *pvValue,
+    int *piAdded) {
+    struct Node *node;
+    struct Node *newRoot;
+    char *block;
+    char *copy;
+    size_t i;
+    size_t j;
+    int iFound;
+    int cmp;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    assert(piAdded != NULL);
+    *piAdded = FALSE;
+
+    /*allocates the root for the first binding*/
+    if (oSymTable->root == NULL) {
+        oSymTable->root = SymTable_newNode(oSymTable, TRUE);
+        if (oSymTable->root == NULL) {
+            return NULL;
+        }
+    }
+
+    /*copies the nodes on the way down that a clone shares, since the
+    binding's node & maybe others on its path change*/
+    if (!SymTable_ownRoot(oSymTable)) {
+        return NULL;
+    }
+
+    /*grows the tree by one level when the root is full*/
+    if (oSymTable->root->keyCount == MAX_KEYS) {
+        newRoot = SymTable_newNode(oSymTable, FALSE);
+        if (newRoot == NULL) {
+            return NULL;
+        }
+        newRoot->children[0] = oSymTable->root;
+        if (!SymTable_splitChild(oSymTable, newRoot, 0)) {
+            SymTable_release(oSymTable, newRoot);
+            return NULL;
+        }
+        oSymTable->root = newRoot;
+    }
+
+    /*descends to a leaf, splitting full children on the way down so
+    that the leaf always has room for the new key*/
+    node = oSymTable->root;
+    for (;;) {
+        i = SymTable_search(node, pcKey, uLength, &iFound);
+        if (iFound) {
+            return &node->values[i];
+        }
+        if (node->isLeaf) {
+            break;
+        }
+        if (SymTable_ownChild(oSymTable, node, i) == NULL) {
+            return NULL;
+        }
+        if (node->children[i]->keyCount == MAX_KEYS) {
+            if (!SymTable_splitChild(oSymTable, node, i)) {
+                return NULL;
+            }
+            cmp = SymTable_compare(node->keys[i], pcKey, uLength);
+            if (cmp == 0) {
+                return &node->values[i];
+            }
+            if (cmp < 0) {
+                i++;
+            }
+        }
+        node = node->children[i];
+    }
+
+    /*Makes a Defensive Copy of the string that pcKey points to, after
+    the value in an inline table*/
+    block = SymTable_alloc(oSymTable, oSymTable->valueRoom + uLength + 1);
+    if (block == NULL) {
+        return NULL;
+    }
+    copy = block + oSymTable->valueRoom;
+    memcpy(copy, pcKey, uLength);
+    copy[uLength] = '\0';
+
+    /*inserts the key into the leaf, keeping it sorted*/
+    for (j = node->keyCount; j > i; j--) {
+        node->keys[j] = node->keys[j - 1];
+        node->values[j] = node->values[j - 1];
+    }
+    node->keys[i] = copy;
+    node->values[i] = block;
+    SymTable_setValue(oSymTable, &node->values[i], pvValue);
+    node->keyCount++;
+    oSymTable->counter++;
+    *piAdded = TRUE;
+    return &node->values[i];
+}
+
+/* Adds a binding whose key is the uLength characters at pcKey and
+   whose value is pvValue to oSymTable and returns TRUE, or returns
+   FALSE if the key is already bound or if insufficient memory is
+   available. */
+static int SymTable_insert(SymTable_T oSymTable, const char *pcKey,
+    size_t uLength, const void *pvValue) {
+    int iAdded;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    (void)SymTable_findOrAdd(oSymTable, pcKey, uLength, pvValue,
+        &iAdded);
+    return iAdded;
+}
+
+int SymTable_put(SymTable_T oSymTable,
+    const char *pcKey, const void *pvValue) {
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    return SymTable_insert(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+int SymTable_putN(SymTable_T oSymTable, const char *pcKey,
+    size_t uLength, const void *pvValue) {
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    assert(memchr(pcKey, '\0', uLength) == NULL);
+    return SymTable_insert(oSymTable, pcKey, uLength, pvValue);
+}
+
+void *SymTable_replace(SymTable_T oSymTable,
+    const char *pcKey, const void *pvValue) {
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    return SymTable_replaceN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+void *SymTable_replaceN(SymTable_T oSymTable, const char *pcKey,
+    size_t uLength, const void *pvValue) {
+    struct Node *node;
+    size_t i;
+    void *val;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    node = SymTable_findOwned(oSymTable, pcKey, uLength, &i);
+    if (node == NULL) {
+        return NULL;
+    }
+
+    /* replaces the value with a given value */
+    val = SymTable_saveValue(oSymTable, node->values[i]);
+    SymTable_setValue(oSymTable, &node->values[i], pvValue);
+    return val;
+}
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey) {
+    size_t i;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    return SymTable_find(oSymTable, pcKey, strlen(pcKey), &i) != NULL;
+}
+
+int SymTable_containsN(SymTable_T oSymTable, const char *pcKey,
+    size_t uLength) {
+    size_t i;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    assert(memchr(pcKey, '\0', uLength) == NULL);
+    return SymTable_find(oSymTable, pcKey, uLength, &i) != NULL;
+}
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey) {
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    return SymTable_getN(oSymTable, pcKey, strlen(pcKey));
+}
+
+void *SymTable_getN(SymTable_T oSymTable, const char *pcKey,
+    size_t uLength) {
+    struct Node *node;
+    size_t i;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    node = SymTable_find(oSymTable, pcKey, uLength, &i);
+    if (node == NULL) {
+        return NULL;
+    }
+    return (void*)node->values[i];
+}
+
+void *SymTable_getFirst(SymTable_T *poSymTables, size_t uCount,
+    const char *pcKey, size_t *puWhich) {
+    struct Node *node;
+    size_t uLength;
+    size_t uIndex;
+    size_t i;
+    assert(poSymTables != NULL || uCount == 0);
+    assert(pcKey != NULL);
+
+    /*the key is measured once for all the tables*/
+    uLength = strlen(pcKey);
+    for (i = 0; i < uCount; i++) {
+        node = SymTable_find(poSymTables[i], pcKey, uLength, &uIndex);
+        if (node != NULL) {
+            if (puWhich != NULL) {
+                *puWhich = i;
+            }
+            return (void*)node->values[uIndex];
+        }
+    }
+    if (puWhich != NULL) {
+        *puWhich = uCount;
+    }
+    return NULL;
+}
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    return SymTable_removeN(oSymTable, pcKey, strlen(pcKey));
+}
+
+void *SymTable_removeN(SymTable_T oSymTable, const char *pcKey,
+    size_t uLength) {
+    struct Node *oldRoot;
+    char *key;
+    const void *val;
+    void *pvOldValue;
+    int iFound;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    if (oSymTable->root == NULL || !SymTable_ownRoot(oSymTable)) {
+        return NULL;
+    }
+
+    iFound = SymTable_delete(oSymTable, oSymTable->root, pcKey, uLength,
+        &key, &val);
+
+    /*shrinks the tree by one level when the root runs out of keys*/
+    oldRoot = oSymTable->root;
+    if (oldRoot->keyCount == 0) {
+        if (oldRoot->isLeaf) {
+            oSymTable->root = NULL;
+        }
+        else {
+            oSymTable->root = oldRoot->children[0];
+        }
+        SymTable_release(oSymTable, oldRoot);
+    }
+
+    if (!iFound) {
+        return NULL;
+    }
+
+    /* frees the key, decrements counter, returns val*/
+    pvOldValue = SymTable_saveValue(oSymTable, val);
+    SymTable_freeBinding(oSymTable, key, val);
+    oSymTable->counter--;
+    return pvOldValue;
+}
+
+/* A transaction keeps a clone of the table as it was when the
+   transaction began, which costs little since the two share their
+   memory until the table changes; rolling back swaps it in. */
+int SymTable_beginTxn(SymTable_T oSymTable) {
+    assert(oSymTable != NULL);
+    assert(oSymTable->snapshot == NULL);
+    oSymTable->snapshot = SymTable_clone(oSymTable);
+    return oSymTable->snapshot != NULL;
+}
+
+void SymTable_commit(SymTable_T oSymTable) {
+    assert(oSymTable != NULL);
+    assert(oSymTable->snapshot != NULL);
+    SymTable_free(oSymTable->snapshot);
+    oSymTable->snapshot = NULL;
+}
+
+void SymTable_rollback(SymTable_T oSymTable) {
+    struct SymTable changed;
+    SymTable_T snapshot;
+    assert(oSymTable != NULL);
+    assert(oSymTable->snapshot != NULL);
+
+    /*the table takes the snapshot's contents, and the snapshot the
+    changed ones, which are freed with it*/
+    snapshot = oSymTable->snapshot;
+    changed = *oSymTable;
+    *oSymTable = *snapshot;
+    *snapshot = changed;
+    snapshot->snapshot = NULL;
+    SymTable_free(snapshot);
+}
+
+/* A tree has no resizes or chains to profile, so nothing is kept. */
+void SymTable_dumpProfile(FILE *psFile) {
+    assert(psFile != NULL);
+    fprintf(psFile,
+        "SymTable profile not kept by this implementation\n");
+}
+
+int SymTable_upsert(SymTable_T oSymTable,
+    const char *pcKey, const void *pvValue) {
+    const void **slot;
+    int iAdded;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    slot = SymTable_findOrAdd(oSymTable, pcKey, strlen(pcKey), pvValue,
+        &iAdded);
+    if (slot == NULL) {
+        return FALSE;
+    }
+    SymTable_setValue(oSymTable, slot, pvValue);
+    return TRUE;
+}
+
+void **SymTable_getOrInsert(SymTable_T oSymTable,
+    const char *pcKey, const void *pvValue) {
+    int iAdded;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    return (void**)SymTable_findOrAdd(oSymTable, pcKey, strlen(pcKey),
+        pvValue, &iAdded);
+}
+
+void SymTable_map(SymTable_T oSymTable, void (*pfApply)
+    (const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra) {
+    struct Bounds sBounds;
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+    if (oSymTable->root == NULL) {
+        return;
+    }
+    sBounds.pcLo = NULL;
+    sBounds.uLoLength = 0;
+    sBounds.pcHi = NULL;
+    sBounds.uPrefixLength = 0;
+    (void)SymTable_walk(oSymTable->root, &sBounds, pfApply, pvExtra);
+}
+
+void SymTable_rangeMap(SymTable_T oSymTable, const char *pcLo,
+    const char *pcHi, void (*pfApply)
+    (const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra) {
+    struct Bounds sBounds;
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+    if (oSymTable->root == NULL) {
+        return;
+    }
+    sBounds.pcLo = pcLo;
+    sBounds.uLoLength = pcLo != NULL ? strlen(pcLo) : 0;
+    sBounds.pcHi = pcHi;
+    sBounds.uPrefixLength = 0;
+    (void)SymTable_walk(oSymTable->root, &sBounds, pfApply, pvExtra);
+}
+
+void SymTable_prefixMap(SymTable_T oSymTable, const char *pcPrefix,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra) {
+    struct Bounds sBounds;
+    assert(oSymTable != NULL);
+    assert(pcPrefix != NULL);
+    assert(pfApply != NULL);
+    if (oSymTable->root == NULL) {
+        return;
+    }
+
+    /*every key with the prefix sorts at or after the prefix itself,
+    and the walk stops at the first one that does not share it*/
+    sBounds.pcLo = pcPrefix;
+    sBounds.uLoLength = strlen(pcPrefix);
+    sBounds.pcHi = NULL;
+    sBounds.uPrefixLength = sBounds.uLoLength;
+    (void)SymTable_walk(oSymTable->root, &sBounds, pfApply, pvExtra);
+}
+
+size_t SymTable_hashKey(const char *pcKey)
+{
+   assert(pcKey != NULL);
+   return SymTable_hashKeyN(pcKey, strlen(pcKey));
+}
+
+size_t SymTable_hashKeyN(const char *pcKey, size_t uLength)
+{
+   const size_t HASH_MULTIPLIER = 65599;
+   size_t u;
+   size_t uHash = 0;
+   assert(pcKey != NULL);
+   for (u = 0; u < uLength; u++)
+      uHash = uHash * HASH_MULTIPLIER + (size_t)pcKey[u];
+   return uHash;
+}
+
+/* the B-tree orders keys by strcmp and never uses hash codes, so the
+   WithHash functions only check them */
+
+int SymTable_putWithHash(SymTable_T oSymTable,
+    const char *pcKey, size_t uHash, const void *pvValue) {
+    assert(uHash == SymTable_hashKey(pcKey));
+    (void)uHash;
+    return SymTable_put(oSymTable, pcKey, pvValue);
+}
+
+int SymTable_containsWithHash(SymTable_T oSymTable,
+    const char *pcKey, size_t uHash) {
+    assert(uHash == SymTable_hashKey(pcKey));
+    (void)uHash;
+    return SymTable_contains(oSymTable, pcKey);
+}
+
+void *SymTable_getWithHash(SymTable_T oSymTable,
+    const char *pcKey, size_t uHash) {
+    assert(uHash == SymTable_hashKey(pcKey));
+    (void)uHash;
+    return SymTable_get(oSymTable, pcKey);
+}
+
+SymTable_T SymTable_buildParallel(const char *const *ppcKeys,
+    const void *const *ppvValues, size_t uCount, size_t uThreadCount) {
+    SymTable_T oSymTable;
+    size_t i;
+    assert(uCount == 0 || ppcKeys != NULL);
+    assert(uCount == 0 || ppvValues != NULL);
+
+    /*every insert may restructure the path from the root, so the 
+    tree is built by the calling thread alone*/
+    (void)uThreadCount;
+    oSymTable = SymTable_new();
+    if (oSymTable == NULL) {
+        return NULL;
+    }
+    for (i = 0; i < uCount; i++) {
+        assert(ppcKeys[i] != NULL);
+        if (!SymTable_put(oSymTable, ppcKeys[i], ppvValues[i]) &&
+            !SymTable_contains(oSymTable, ppcKeys[i])) {
+            SymTable_free(oSymTable);
+            return NULL;
+        }
+    }
+    return oSymTable;
+}
+
+/* Adds a binding to oSymTable for each line of the uLength bytes of 
+   text at pcText, which is followed by a zero byte, ending each key & 
+   value in place. Returns FALSE if the text holds a '\0' or 
+   insufficient memory is available, and TRUE otherwise. */
+static int SymTable_addLines(SymTable_T oSymTable, char *pcText,
+    size_t uLength, char cSeparator) {
+    char *pcLine;
+    char *pcNext;
+    char *pcEnd;
+    char *pcSeparator;
+    char *pcValue;
+    size_t uLineLength;
+    assert(oSymTable != NULL);
+    assert(pcText != NULL);
+
+    pcEnd = pcText + uLength;
+    for (pcLine = pcText; pcLine < pcEnd; pcLine = pcNext + 1) {
+        pcNext = memchr(pcLine, '\n', (size_t)(pcEnd - pcLine));
+        if (pcNext == NULL) {
+            pcNext = pcEnd;
+        }
+        uLineLength = (size_t)(pcNext - pcLine);
+        if (uLineLength > 0 && pcLine[uLineLength - 1] == '\r') {
+            uLineLength--;
+        }
+        if (uLineLength == 0) {
+            continue;
+        }
+        if (memchr(pcLine, '\0', uLineLength) != NULL) {
+            return FALSE;
+        }
+
+        /*the key ends at the separator and the value at the end of 
+        the line; without a separator both end there*/
+        pcLine[uLineLength] = '\0';
+        pcSeparator = memchr(pcLine, cSeparator, uLineLength);
+        pcValue = pcLine + uLineLength;
+        if (pcSeparator != NULL) {
+            *pcSeparator = '\0';
+            pcValue = pcSeparator + 1;
+        }
+        if (!SymTable_put(oSymTable, pcLine, pcValue) &&
+            !SymTable_contains(oSymTable, pcLine)) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+SymTable_T SymTable_load(const char *pcPath, char cSeparator) {
+    SymTable_T oSymTable;
+    FILE *psFile;
+    char *pcText;
+    long lLength;
+    assert(pcPath != NULL);
+    assert(cSeparator != '\n' && cSeparator != '\r' &&
+        cSeparator != '\0');
+
+    oSymTable = SymTable_new();
+    if (oSymTable == NULL) {
+        return NULL;
+    }
+    psFile = fopen(pcPath, "rb");
+    if (psFile == NULL) {
+        SymTable_free(oSymTable);
+        return NULL;
+    }
+
+    /*the whole file is read into the pool, followed by a zero byte 
+    that ends a last line without a newline*/
+    lLength = -1;
+    if (fseek(psFile, 0, SEEK_END) == 0) {
+        lLength = ftell(psFile);
+    }
+    if (lLength >= 0 && fseek(psFile, 0, SEEK_SET) == 0) {
+        oSymTable->pool = (struct Pool*)SymTable_alloc(oSymTable,
+            sizeof(struct Pool) + (size_t)lLength + 1);
+    }
+    if (oSymTable->pool != NULL) {
+        oSymTable->pool->refCount = 1;
+        pcText = (char*)(oSymTable->pool + 1);
+        pcText[lLength] = '\0';
+        if (fread(pcText, 1, (size_t)lLength, psFile) !=
+            (size_t)lLength || !SymTable_addLines(oSymTable, pcText,
+            (size_t)lLength, cSeparator)) {
+            (void)fclose(psFile);
+            SymTable_free(oSymTable);
+            return NULL;
+        }
+    }
+    (void)fclose(psFile);
+    if (oSymTable->pool == NULL) {
+        SymTable_free(oSymTable);
+        return NULL;
+    }
+    return oSymTable;
+}
+
+void SymTable_mapParallel(SymTable_T oSymTable, void (*pfApply)
+    (const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra, size_t uThreadCount) {
+    /*the tree is walked in order by the calling thread alone*/
+    (void)uThreadCount;
+    SymTable_map(oSymTable, pfApply, pvExtra);
+}
@@ -0,0 +1,1454 @@
+/*-------------------------------------------------------------------*/
+/* symtablecuckoo.c                                                  */
+/* Author: Arnold Jiang                                              */
+/*-------------------------------------------------------------------*/
+
+#include "symtable.h"
+#include <assert.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+
+/*defines FALSE (0) and TRUE (1)*/
+enum {FALSE, TRUE};
+
+/*slots in a bucket, and bytes in the cache line that a bucket is
+aligned to*/
+enum {SLOT_COUNT = 4, LINE_SIZE = 64};
+
+/*a table starts with 1 << MIN_BUCKET_BITS buckets and allocates them
+in blocks of at most 1 << MAX_BLOCK_BITS buckets. It doubles once a
+put would fill more than LOAD_EIGHTHS eighths of its slots, or when
+no free slot is within QUEUE_SIZE steps of a search for one*/
+enum {MIN_BUCKET_BITS = 1, MAX_BLOCK_BITS = 10, LOAD_EIGHTHS = 7,
+    QUEUE_SIZE = 256};
+
+/* A Bind holds a binding. Its key follows it in the same block, after
+the value of an inline table padded to valueRoom bytes, and is ended
+with '\0'*/
+struct Bind {
+    /*points to the value, or to the stored value of an inline table*/
+    const void *value;
+    /*number of characters in the key*/
+    size_t length;
+};
+
+/* A Bucket holds up to SLOT_COUNT bindings, each next to the hash code
+of its key, so that a lookup compares codes without reading the
+bindings. On 64-bit machines a bucket fills one cache line*/
+struct Bucket {
+    /*hash code of the key of each slot that is in use*/
+    size_t hashes[SLOT_COUNT];
+    /*binding of each slot, or NULL if the slot is free*/
+    struct Bind *binds[SLOT_COUNT];
+};
+
+/* A Block heads an allocation that holds a run of buckets, which
+starts at the first cache line after the Block. A table and its clones
+share blocks, and a table copies a shared block, with its bindings,
+before it changes it*/
+struct Block {
+    /*number of tables that point to the block*/
+    size_t refCount;
+    /*points to the start of the allocation*/
+    void *pvRaw;
+};
+
+/* The Buckets of a table are 1 << bucketBits buckets split into
+blocks of 1 << blockBits buckets each. Every key has two buckets,
+chosen by two hash functions, and its binding is in one of them*/
+struct Buckets {
+    /*points to the first bucket of each block, or is NULL while the
+    table has no buckets*/
+    struct Bucket **blocks;
+    size_t bucketBits;
+    size_t blockBits;
+};
+
+/* A SymTable structure is a "manager" structure that points to the
+buckets of a cuckoo hash table and contains a counter that maintains
+the number of binds, along with the allocator that all its memory
+comes from. A lookup reads the two buckets of its key and nothing
+else until the codes match, so its cost does not depend on how the
+other keys fell. A table made by SymTable_load keeps the values from
+its file in a pool*/
+struct SymTable {
+    /*the buckets, allocated by the first SymTable_put*/
+    struct Buckets buckets;
+    /*tracks the number of binds*/
+    size_t counter;
+    /*mixed into each hash code to pick buckets, so that tables differ
+    in which keys meet*/
+    size_t seed;
+    /*allocates & frees memory, given pvContext*/
+    void *(*pfAlloc)(size_t uSize, void *pvContext);
+    void (*pfFree)(void *pvBlock, void *pvContext);
+    void *pvContext;
+    /*bytes in each value stored by the table, or 0 if the table
+    holds pointers to values, and the room that a stored value takes
+    in its binding*/
+    size_t valueSize;
+    size_t valueRoom;
+    /*holds a copy of the value that the last replace or remove took
+    out of an inline table, or is NULL*/
+    void *oldValue;
+    /*points to the text of the file that the table was loaded from,
+    or is NULL*/
+    struct Pool *pool;
+    /*points to a clone taken when the open transaction began, or is
+    NULL while no transaction is open*/
+    struct SymTable *snapshot;
+};
+
+/* A Pool holds the text of a file that SymTable_load read, which the
+values of its lines point into. The text follows the header in the
+same block, with its lines ended in place. A table and its clones
+share the pool, so it is freed by the last of them to be freed*/
+struct Pool {
+    /*number of tables that read the pool*/
+    size_t refCount;
+};
+
+/* A Step of the search for a free slot is a bucket that the search
+reached by moving the binding in slot of the bucket at step parent*/
+struct Step {
+    size_t bucket;
+    size_t parent;
+    size_t slot;
+};
+
+/*secret key of SipHash, chosen once per run of the program*/
+static uint64_t auSipKey[2];
+static pthread_once_t sSipKeyOnce = PTHREAD_ONCE_INIT;
+
+/* Chooses auSipKey from /dev/urandom or, where that cannot be read,
+   from the clock and the addresses that the program was loaded at. */
+static void SymTable_chooseKey(void) {
+    FILE *psFile;
+    int iLocal;
+    psFile = fopen("/dev/urandom", "rb");
+    if (psFile != NULL) {
+        if (fread(auSipKey, sizeof(auSipKey), 1, psFile) == 1) {
+            (void)fclose(psFile);
+            return;
+        }
+        (void)fclose(psFile);
+    }
+    auSipKey[0] = (uint64_t)time(NULL) ^ (uint64_t)(uintptr_t)&iLocal;
+    auSipKey[1] = (uint64_t)clock() ^
+        (uint64_t)(uintptr_t)&SymTable_chooseKey;
+}
+
+/*rotates the 64 bits of x left by b*/
+#define SIP_ROTATE(x, b) (((x) << (b)) | ((x) >> (64 - (b))))
+
+/*one SipRound over the state v0..v3*/
+#define SIP_ROUND(v0, v1, v2, v3) do { \
+    v0 += v1; v1 = SIP_ROTATE(v1, 13); v1 ^= v0; \
+    v0 = SIP_ROTATE(v0, 32); \
+    v2 += v3; v3 = SIP_ROTATE(v3, 16); v3 ^= v2; \
+    v0 += v3; v3 = SIP_ROTATE(v3, 21); v3 ^= v0; \
+    v2 += v1; v1 = SIP_ROTATE(v1, 17); v1 ^= v2; \
+    v2 = SIP_ROTATE(v2, 32); \
+} while (0)
+
+/* Return the SipHash-1-3 code of the uLength bytes at pvBytes under
+   auSipKey. Without the key, no one can choose keys that share both
+   buckets, which is what would force a table to grow. */
+static size_t SymTable_sipHash(const void *pvBytes, size_t uLength)
+{
+   const unsigned char *pucBytes = (const unsigned char*)pvBytes;
+   uint64_t v0 = auSipKey[0] ^ 0x736f6d6570736575ULL;
+   uint64_t v1 = auSipKey[1] ^ 0x646f72616e646f6dULL;
+   uint64_t v2 = auSipKey[0] ^ 0x6c7967656e657261ULL;
+   uint64_t v3 = auSipKey[1] ^ 0x7465646279746573ULL;
+   uint64_t uWord;
+   size_t u;
+   assert(pvBytes != NULL || uLength == 0);
+
+   for (u = 0; u + 8 <= uLength; u += 8)
+   {
+      memcpy(&uWord, pucBytes + u, 8);
+      v3 ^= uWord;
+      SIP_ROUND(v0, v1, v2, v3);
+      v0 ^= uWord;
+   }
+
+   /*the last 0 to 7 bytes, with the length in the top byte*/
+   uWord = (uint64_t)uLength << 56;
+   pucBytes += u;
+   switch (uLength - u)
+   {
+      case 7: uWord |= (uint64_t)pucBytes[6] << 48; /* FALLTHROUGH */
+      case 6: uWord |= (uint64_t)pucBytes[5] << 40; /* FALLTHROUGH */
+      case 5: uWord |= (uint64_t)pucBytes[4] << 32; /* FALLTHROUGH */
+      case 4: uWord |= (uint64_t)pucBytes[3] << 24; /* FALLTHROUGH */
+      case 3: uWord |= (uint64_t)pucBytes[2] << 16; /* FALLTHROUGH */
+      case 2: uWord |= (uint64_t)pucBytes[1] << 8; /* FALLTHROUGH */
+      case 1: uWord |= (uint64_t)pucBytes[0]; break;
+      default: break;
+   }
+   v3 ^= uWord;
+   SIP_ROUND(v0, v1, v2, v3);
+   v0 ^= uWord;
+
+   v2 ^= 0xff;
+   SIP_ROUND(v0, v1, v2, v3);
+   SIP_ROUND(v0, v1, v2, v3);
+   SIP_ROUND(v0, v1, v2, v3);
+   return (size_t)(v0 ^ v1 ^ v2 ^ v3);
+}
+
+size_t SymTable_hashKey(const char *pcKey)
+{
+   assert(pcKey != NULL);
+   (void)pthread_once(&sSipKeyOnce, SymTable_chooseKey);
+   return SymTable_sipHash(pcKey, strlen(pcKey));
+}
+
+size_t SymTable_hashKeyN(const char *pcKey, size_t uLength)
+{
+   assert(pcKey != NULL);
+   (void)pthread_once(&sSipKeyOnce, SymTable_chooseKey);
+   return SymTable_sipHash(pcKey, uLength);
+}
+
+/* Returns uSize bytes from malloc. pvContext is unused. */
+static void *SymTable_defaultAlloc(size_t uSize, void *pvContext) {
+    (void)pvContext;
+    return malloc(uSize);
+}
+
+/* Returns pvBlock to free. pvContext is unused. */
+static void SymTable_defaultFree(void *pvBlock, void *pvContext) {
+    (void)pvContext;
+    free(pvBlock);
+}
+
+/* Returns uSize bytes from the allocator of oSymTable, or NULL if
+   insufficient memory is available. */
+static void *SymTable_alloc(SymTable_T oSymTable, size_t uSize) {
+    assert(oSymTable != NULL);
+    return (*oSymTable->pfAlloc)(uSize, oSymTable->pvContext);
+}
+
+/* Returns pvBlock to the allocator of oSymTable. */
+static void SymTable_release(SymTable_T oSymTable, void *pvBlock) {
+    assert(oSymTable != NULL);
+    (*oSymTable->pfFree)(pvBlock, oSymTable->pvContext);
+}
+
+/* Stores pvValue in *ppvSlot, the value slot of a binding of
+   oSymTable. An inline table copies the value into the storage that
+   *ppvSlot points to, or zeroes it if pvValue is NULL. */
+static void SymTable_setValue(SymTable_T oSymTable,
+    const void **ppvSlot, const void *pvValue) {
+    assert(oSymTable != NULL);
+    assert(ppvSlot != NULL);
+    if (oSymTable->valueSize == 0) {
+        *ppvSlot = pvValue;
+    }
+    else if (pvValue == NULL) {
+        memset((void*)*ppvSlot, 0, oSymTable->valueSize);
+    }
+    else {
+        memcpy((void*)*ppvSlot, pvValue, oSymTable->valueSize);
+    }
+}
+
+/* Returns the value pvValue of oSymTable as a replace or remove
+   hands it back: the pointer itself, or in an inline table a copy
+   in the table's old value. */
+static void *SymTable_saveValue(SymTable_T oSymTable,
+    const void *pvValue) {
+    assert(oSymTable != NULL);
+    if (oSymTable->valueSize == 0) {
+        return (void*)pvValue;
+    }
+    memcpy(oSymTable->oldValue, pvValue, oSymTable->valueSize);
+    return oSymTable->oldValue;
+}
+
+/* Returns the key of bind, a binding of oSymTable. */
+static char *SymTable_key(SymTable_T oSymTable, struct Bind *bind) {
+    assert(oSymTable != NULL);
+    assert(bind != NULL);
+    return (char*)(bind + 1) + oSymTable->valueRoom;
+}
+
+/* Returns the number of bytes in the block of a binding of oSymTable
+   whose key has uLength characters. */
+static size_t SymTable_bindSize(SymTable_T oSymTable, size_t uLength) {
+    assert(oSymTable != NULL);
+    return sizeof(struct Bind) + oSymTable->valueRoom + uLength + 1;
+}
+
+/* Returns a new binding of oSymTable whose key is a copy of the
+   uLength characters at pcKey and whose value is pvValue, or NULL if
+   insufficient memory is available. */
+static struct Bind *SymTable_newBind(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength, const void *pvValue) {
+    struct Bind *bind;
+    char *copy;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    bind = (struct Bind*)SymTable_alloc(oSymTable,
+        SymTable_bindSize(oSymTable, uLength));
+    if (bind == NULL) {
+        return NULL;
+    }
+    bind->length = uLength;
+    copy = SymTable_key(oSymTable, bind);
+    memcpy(copy, pcKey, uLength);
+    copy[uLength] = '\0';
+    bind->value = oSymTable->valueSize == 0 ? NULL : (void*)(bind + 1);
+    SymTable_setValue(oSymTable, &bind->value, pvValue);
+    return bind;
+}
+
+/* Returns a copy of bind, a binding of oSymTable, or NULL if
+   insufficient memory is available. */
+static struct Bind *SymTable_copyBind(SymTable_T oSymTable,
+    struct Bind *bind) {
+    struct Bind *copy;
+    size_t uSize;
+    assert(oSymTable != NULL);
+    assert(bind != NULL);
+    uSize = SymTable_bindSize(oSymTable, bind->length);
+    copy = (struct Bind*)SymTable_alloc(oSymTable, uSize);
+    if (copy == NULL) {
+        return NULL;
+    }
+    memcpy(copy, bind, uSize);
+    if (oSymTable->valueSize > 0) {
+        copy->value = copy + 1;
+    }
+    return copy;
+}
+
+/* Returns the Block that heads the block whose first bucket is first. */
+static struct Block *SymTable_header(struct Bucket *first) {
+    assert(first != NULL);
+    return (struct Block*)(void*)first - 1;
+}
+
+/* Returns the first bucket of a new block of oSymTable that holds
+   1 << uBlockBits free buckets, or NULL if insufficient memory is
+   available. */
+static struct Bucket *SymTable_newBlock(SymTable_T oSymTable,
+    size_t uBlockBits) {
+    struct Bucket *first;
+    void *pvRaw;
+    size_t uBytes;
+    assert(oSymTable != NULL);
+
+    /*the buckets start at a cache line, so that a bucket is read in
+    one line, which takes up to LINE_SIZE - 1 bytes more*/
+    uBytes = ((size_t)1 << uBlockBits) * sizeof(struct Bucket);
+    pvRaw = SymTable_alloc(oSymTable,
+        sizeof(struct Block) + LINE_SIZE - 1 + uBytes);
+    if (pvRaw == NULL) {
+        return NULL;
+    }
+    first = (struct Bucket*)(((uintptr_t)((struct Block*)pvRaw + 1) +
+        LINE_SIZE - 1) & ~(uintptr_t)(LINE_SIZE - 1));
+    memset(first, 0, uBytes);
+    SymTable_header(first)->refCount = 1;
+    SymTable_header(first)->pvRaw = pvRaw;
+    return first;
+}
+
+/* Drops a reference to the block of oSymTable whose first bucket is
+   first and that holds 1 << uBlockBits buckets, and once no table
+   points to it, frees it, along with its bindings if iDeep is TRUE. */
+static void SymTable_freeBlock(SymTable_T oSymTable,
+    struct Bucket *first, size_t uBlockBits, int iDeep) {
+    struct Block *header;
+    size_t i;
+    size_t j;
+    assert(oSymTable != NULL);
+    header = SymTable_header(first);
+    assert(header->refCount > 0);
+    header->refCount--;
+    if (header->refCount > 0) {
+        return;
+    }
+    if (iDeep) {
+        for (i = 0; i < (size_t)1 << uBlockBits; i++) {
+            for (j = 0; j < SLOT_COUNT; j++) {
+                if (first[i].binds[j] != NULL) {
+                    SymTable_release(oSymTable, first[i].binds[j]);
+                }
+            }
+        }
+    }
+    SymTable_release(oSymTable, header->pvRaw);
+}
+
+/* Drops the references of oSymTable to every block of psBuckets,
+   freeing the bindings of the blocks it frees if iDeep is TRUE, and
+   frees the list of blocks. */
+static void SymTable_freeBuckets(SymTable_T oSymTable,
+    struct Buckets *psBuckets, int iDeep) {
+    size_t i;
+    assert(oSymTable != NULL);
+    assert(psBuckets != NULL);
+    if (psBuckets->blocks == NULL) {
+        return;
+    }
+    for (i = 0; i < (size_t)1 <<
+        (psBuckets->bucketBits - psBuckets->blockBits); i++) {
+        SymTable_freeBlock(oSymTable, psBuckets->blocks[i],
+            psBuckets->blockBits, iDeep);
+    }
+    SymTable_release(oSymTable, psBuckets->blocks);
+    psBuckets->blocks = NULL;
+}
+
+/* Allocates the blocks of psBuckets, whose bucketBits & blockBits are
+   set, with every bucket free. Returns FALSE, leaving psBuckets
+   without blocks, if insufficient memory is available, and TRUE
+   otherwise. */
+static int SymTable_allocBuckets(SymTable_T oSymTable,
+    struct Buckets *psBuckets) {
+    size_t uBlockCount;
+    size_t i;
+    assert(oSymTable != NULL);
+    assert(psBuckets != NULL);
+    assert(psBuckets->blockBits <= psBuckets->bucketBits);
+    uBlockCount = (size_t)1 <<
+        (psBuckets->bucketBits - psBuckets->blockBits);
+    psBuckets->blocks = (struct Bucket**)SymTable_alloc(oSymTable,
+        uBlockCount * sizeof(struct Bucket*));
+    if (psBuckets->blocks == NULL) {
+        return FALSE;
+    }
+    for (i = 0; i < uBlockCount; i++) {
+        psBuckets->blocks[i] = SymTable_newBlock(oSymTable,
+            psBuckets->blockBits);
+        if (psBuckets->blocks[i] == NULL) {
+            while (i > 0) {
+                i--;
+                SymTable_freeBlock(oSymTable, psBuckets->blocks[i],
+                    psBuckets->blockBits, FALSE);
+            }
+            SymTable_release(oSymTable, psBuckets->blocks);
+            psBuckets->blocks = NULL;
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/* Returns the bucket at index i of psBuckets. */
+static struct Bucket *SymTable_bucket(const struct Buckets *psBuckets,
+    size_t i) {
+    assert(psBuckets != NULL);
+    assert(psBuckets->blocks != NULL);
+    return &psBuckets->blocks[i >> psBuckets->blockBits]
+        [i & (((size_t)1 << psBuckets->blockBits) - 1)];
+}
+
+/* Returns the index of the first bucket, or of the second if
+   iSecond is TRUE, of a key with hash code uHash among the
+   1 << uBucketBits buckets of a table with seed uSeed. The two are
+   the high bits of two products of the seeded code, so they fall
+   apart for keys that share one of them. */
+static size_t SymTable_choice(size_t uSeed, size_t uBucketBits,
+    size_t uHash, int iSecond) {
+    uint64_t uMixed;
+    assert(uBucketBits > 0 && uBucketBits < 64);
+    uMixed = (uint64_t)(uHash ^ uSeed);
+    uMixed *= iSecond ? 0xC2B2AE3D27D4EB4FULL : 0x9E3779B97F4A7C15ULL;
+    return (size_t)(uMixed >> (64 - uBucketBits));
+}
+
+/* Returns the bucket of psBuckets, in a table with seed uSeed, that
+   a key with hash code uHash may be in other than the one at index
+   i. */
+static size_t SymTable_other(const struct Buckets *psBuckets,
+    size_t uSeed, size_t uHash, size_t i) {
+    size_t uFirst;
+    assert(psBuckets != NULL);
+    uFirst = SymTable_choice(uSeed, psBuckets->bucketBits, uHash, FALSE);
+    if (uFirst != i) {
+        return uFirst;
+    }
+    return SymTable_choice(uSeed, psBuckets->bucketBits, uHash, TRUE);
+}
+
+/* Replaces the block at index uBlock of psBuckets, buckets of
+   oSymTable, with a copy that holds copies of its bindings if a
+   clone shares it, so that it can be changed. Returns FALSE if
+   insufficient memory is available and TRUE otherwise. */
+static int SymTable_ownBlock(SymTable_T oSymTable,
+    struct Buckets *psBuckets, size_t uBlock) {
+    struct Bucket *first;
+    struct Bucket *copy;
+    size_t i;
+    size_t j;
+    assert(oSymTable != NULL);
+    assert(psBuckets != NULL);
+    first = psBuckets->blocks[uBlock];
+    if (SymTable_header(first)->refCount == 1) {
+        return TRUE;
+    }
+    copy = SymTable_newBlock(oSymTable, psBuckets->blockBits);
+    if (copy == NULL) {
+        return FALSE;
+    }
+    for (i = 0; i < (size_t)1 << psBuckets->blockBits; i++) {
+        for (j = 0; j < SLOT_COUNT; j++) {
+            if (first[i].binds[j] == NULL) {
+                continue;
+            }
+            copy[i].binds[j] = SymTable_copyBind(oSymTable,
+                first[i].binds[j]);
+            if (copy[i].binds[j] == NULL) {
+                SymTable_freeBlock(oSymTable, copy,
+                    psBuckets->blockBits, TRUE);
+                return FALSE;
+            }
+            copy[i].hashes[j] = first[i].hashes[j];
+        }
+    }
+    SymTable_header(first)->refCount--;
+    psBuckets->blocks[uBlock] = copy;
+    return TRUE;
+}
+
+/* Returns the bucket of oSymTable that holds the key made of the
+   uLength characters at pcKey, with hash code uHash, and sets
+   *puIndex to its index and *puSlot to the key's slot in it, or
+   returns NULL if there is no such key. Only the key's two buckets
+   are read, however full the table is. */
+static struct Bucket *SymTable_findSlot(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength, size_t uHash, size_t *puIndex,
+    size_t *puSlot) {
+    struct Bucket *bucket;
+    struct Bind *bind;
+    size_t i;
+    size_t j;
+    int iSecond;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    assert(puIndex != NULL);
+    assert(puSlot != NULL);
+    if (oSymTable->buckets.blocks == NULL) {
+        return NULL;
+    }
+
+    /*the second bucket is fetched while the first is searched, so
+    that a key in it costs hardly more than one in the first*/
+#ifdef __GNUC__
+    __builtin_prefetch(SymTable_bucket(&oSymTable->buckets,
+        SymTable_choice(oSymTable->seed, oSymTable->buckets.bucketBits,
+        uHash, TRUE)));
+#endif
+    for (iSecond = FALSE; iSecond <= TRUE; iSecond++) {
+        i = SymTable_choice(oSymTable->seed,
+            oSymTable->buckets.bucketBits, uHash, iSecond);
+        bucket = SymTable_bucket(&oSymTable->buckets, i);
+        for (j = 0; j < SLOT_COUNT; j++) {
+            bind = bucket->binds[j];
+            if (bind != NULL && bucket->hashes[j] == uHash &&
+                bind->length == uLength &&
+                memcmp(SymTable_key(oSymTable, bind), pcKey,
+                uLength) == 0) {
+                *puIndex = i;
+                *puSlot = j;
+                return bucket;
+            }
+        }
+    }
+    return NULL;
+}
+
+/* Returns the binding of oSymTable whose key is the uLength
+   characters at pcKey, with hash code uHash, or NULL if there is
+   none. */
+static struct Bind *SymTable_find(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength, size_t uHash) {
+    struct Bucket *bucket;
+    size_t i;
+    size_t j;
+    bucket = SymTable_findSlot(oSymTable, pcKey, uLength, uHash, &i, &j);
+    if (bucket == NULL) {
+        return NULL;
+    }
+    return bucket->binds[j];
+}
+
+/* Returns the bucket of oSymTable that holds the key made of the
+   uLength characters at pcKey, with hash code uHash, and sets *puSlot
+   to the key's slot in it, like SymTable_findSlot, but first copies
+   the bucket's block if a clone shares it, so that the binding can
+   be changed. Returns NULL if there is no such key or if
+   insufficient memory is available. */
+static struct Bucket *SymTable_findOwned(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength, size_t uHash, size_t *puSlot) {
+    struct Bucket *bucket;
+    size_t i;
+    assert(oSymTable != NULL);
+    assert(puSlot != NULL);
+    bucket = SymTable_findSlot(oSymTable, pcKey, uLength, uHash, &i,
+        puSlot);
+    if (bucket == NULL) {
+        return NULL;
+    }
+    if (!SymTable_ownBlock(oSymTable, &oSymTable->buckets,
+        i >> oSymTable->buckets.blockBits)) {
+        return NULL;
+    }
+    return SymTable_bucket(&oSymTable->buckets, i);
+}
+
+/* Returns TRUE if the bucket at index i is on the way from the first
+   step at asSteps to step u, and FALSE otherwise. */
+static int SymTable_onPath(const struct Step *asSteps, size_t u,
+    size_t i) {
+    assert(asSteps != NULL);
+    for (; u != QUEUE_SIZE; u = asSteps[u].parent) {
+        if (asSteps[u].bucket == i) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+/* Puts bind, whose key has hash code uHash, into a free slot of
+   psBuckets, buckets of oSymTable. When both of its buckets are full,
+   searches breadth-first for bindings to move to their other bucket
+   to make room, and moves them from the last one back, so that every
+   binding stays findable. Blocks that a clone shares are copied
+   before they are changed. Returns FALSE, leaving the bindings where
+   they were, if no free slot is within QUEUE_SIZE steps or
+   insufficient memory is available, and TRUE otherwise. */
+static int SymTable_place(SymTable_T oSymTable,
+    struct Buckets *psBuckets, struct Bind *bind, size_t uHash) {
+    struct Step asSteps[QUEUE_SIZE];
+    struct Bucket *from;
+    struct Bucket *to;
+    size_t uCount;
+    size_t u;
+    size_t v;
+    size_t i;
+    size_t j;
+    assert(oSymTable != NULL);
+    assert(psBuckets != NULL);
+    assert(bind != NULL);
+
+    asSteps[0].bucket = SymTable_choice(oSymTable->seed,
+        psBuckets->bucketBits, uHash, FALSE);
+    asSteps[0].parent = QUEUE_SIZE;
+    asSteps[1].bucket = SymTable_choice(oSymTable->seed,
+        psBuckets->bucketBits, uHash, TRUE);
+    asSteps[1].parent = QUEUE_SIZE;
+    uCount = asSteps[1].bucket == asSteps[0].bucket ? 1 : 2;
+
+    /*a step's bucket is searched for a free slot before any step
+    after it, so the path found is as short as any*/
+    for (u = 0; u < uCount; u++) {
+        to = SymTable_bucket(psBuckets, asSteps[u].bucket);
+        for (j = 0; j < SLOT_COUNT; j++) {
+            if (to->binds[j] == NULL) {
+                break;
+            }
+        }
+        if (j < SLOT_COUNT) {
+            break;
+        }
+
+        /*a bucket already on the path is not entered again, so that
+        no slot is moved out of twice*/
+        for (j = 0; j < SLOT_COUNT && uCount < QUEUE_SIZE; j++) {
+            i = SymTable_other(psBuckets, oSymTable->seed,
+                to->hashes[j], asSteps[u].bucket);
+            if (!SymTable_onPath(asSteps, u, i)) {
+                asSteps[uCount].bucket = i;
+                asSteps[uCount].parent = u;
+                asSteps[uCount].slot = j;
+                uCount++;
+            }
+        }
+    }
+    if (u == uCount) {
+        return FALSE;
+    }
+    for (v = u; v != QUEUE_SIZE; v = asSteps[v].parent) {
+        if (!SymTable_ownBlock(oSymTable, psBuckets,
+            asSteps[v].bucket >> psBuckets->blockBits)) {
+            return FALSE;
+        }
+    }
+
+    /*each binding on the path moves into the slot that the one after
+    it just left*/
+    for (; asSteps[u].parent != QUEUE_SIZE; u = asSteps[u].parent) {
+        from = SymTable_bucket(psBuckets,
+            asSteps[asSteps[u].parent].bucket);
+        to = SymTable_bucket(psBuckets, asSteps[u].bucket);
+        to->binds[j] = from->binds[asSteps[u].slot];
+        to->hashes[j] = from->hashes[asSteps[u].slot];
+        j = asSteps[u].slot;
+    }
+    to = SymTable_bucket(psBuckets, asSteps[u].bucket);
+    to->binds[j] = bind;
+    to->hashes[j] = uHash;
+    return TRUE;
+}
+
+/* Moves every binding of oSymTable into a new set of buckets that has
+   twice as many, or 1 << MIN_BUCKET_BITS if the table has none.
+   Blocks are as large as MAX_BLOCK_BITS allows, or smaller if the
+   allocator refuses blocks that large. Returns FALSE, leaving the
+   bindings where they were, if insufficient memory is available,
+   and TRUE otherwise. */
+static int SymTable_grow(SymTable_T oSymTable) {
+    struct Buckets sOld;
+    struct Buckets sNew;
+    struct Bucket *bucket;
+    size_t uBucketCount;
+    size_t i;
+    size_t j;
+    assert(oSymTable != NULL);
+    sOld = oSymTable->buckets;
+    uBucketCount = 0;
+    sNew.bucketBits = MIN_BUCKET_BITS;
+    if (sOld.blocks != NULL) {
+        uBucketCount = (size_t)1 << sOld.bucketBits;
+        sNew.bucketBits = sOld.bucketBits + 1;
+    }
+    if (sNew.bucketBits >= 8 * sizeof(size_t) - 1) {
+        return FALSE;
+    }
+
+    /*bindings move rather than being copied, so none may be shared*/
+    for (i = 0; i < uBucketCount >> sOld.blockBits; i++) {
+        if (!SymTable_ownBlock(oSymTable, &oSymTable->buckets, i)) {
+            return FALSE;
+        }
+    }
+    sOld = oSymTable->buckets;
+
+    sNew.blockBits = sNew.bucketBits < MAX_BLOCK_BITS ?
+        sNew.bucketBits : MAX_BLOCK_BITS;
+    while (!SymTable_allocBuckets(oSymTable, &sNew)) {
+        if (sNew.blockBits == 0) {
+            return FALSE;
+        }
+        sNew.blockBits--;
+    }
+    for (i = 0; i < uBucketCount; i++) {
+        bucket = SymTable_bucket(&sOld, i);
+        for (j = 0; j < SLOT_COUNT; j++) {
+            if (bucket->binds[j] != NULL &&
+                !SymTable_place(oSymTable, &sNew, bucket->binds[j],
+                bucket->hashes[j])) {
+                SymTable_freeBuckets(oSymTable, &sNew, FALSE);
+                return FALSE;
+            }
+        }
+    }
+    SymTable_freeBuckets(oSymTable, &sOld, FALSE);
+    oSymTable->buckets = sNew;
+    return TRUE;
+}
+
+/* Returns a new SymTable with no bindings whose memory comes from
+   pfAlloc & pfFree with pvContext, and that stores values of
+   uValueSize bytes, or pointers to values if uValueSize is 0.
+   Returns NULL if insufficient memory is available. */
+static SymTable_T SymTable_create(
+    void *(*pfAlloc)(size_t uSize, void *pvContext),
+    void (*pfFree)(void *pvBlock, void *pvContext), void *pvContext,
+    size_t uValueSize) {
+    SymTable_T oSymTable;
+    assert(pfAlloc != NULL);
+    assert(pfFree != NULL);
+    (void)pthread_once(&sSipKeyOnce, SymTable_chooseKey);
+
+    /*allocates memory for a new SymTable*/
+    oSymTable = (SymTable_T)(*pfAlloc)(sizeof(struct SymTable),
+        pvContext);
+    if (oSymTable == NULL) {
+        return NULL;
+    }
+
+    /*the buckets are allocated lazily by the first SymTable_put*/
+    oSymTable->buckets.blocks = NULL;
+    oSymTable->buckets.bucketBits = 0;
+    oSymTable->buckets.blockBits = 0;
+    oSymTable->pool = NULL;
+    oSymTable->snapshot = NULL;
+    oSymTable->counter = 0;
+    oSymTable->pfAlloc = pfAlloc;
+    oSymTable->pfFree = pfFree;
+    oSymTable->pvContext = pvContext;
+    oSymTable->valueSize = uValueSize;
+    oSymTable->valueRoom = (uValueSize + sizeof(void*) - 1) /
+        sizeof(void*) * sizeof(void*);
+    oSymTable->oldValue = NULL;
+
+    /*the seed hashes the table's address under the secret key, which
+    no one outside can predict*/
+    oSymTable->seed = SymTable_sipHash(&oSymTable, sizeof(oSymTable));
+    if (uValueSize > 0) {
+        oSymTable->oldValue = (*pfAlloc)(uValueSize, pvContext);
+        if (oSymTable->oldValue == NULL) {
+            (*pfFree)(oSymTable, pvContext);
+            return NULL;
+        }
+    }
+    return oSymTable;
+}
+
+SymTable_T SymTable_new(void) {
+    return SymTable_create(SymTable_defaultAlloc, SymTable_defaultFree,
+        NULL, 0);
+}
+
+SymTable_T SymTable_newWithAllocator(
+    void *(*pfAlloc)(size_t uSize, void *pvContext),
+    void (*pfFree)(void *pvBlock, void *pvContext), void *pvContext) {
+    return SymTable_create(pfAlloc, pfFree, pvContext, 0);
+}
+
+SymTable_T SymTable_newInline(size_t uValueSize) {
+    assert(uValueSize > 0);
+    return SymTable_create(SymTable_defaultAlloc, SymTable_defaultFree,
+        NULL, uValueSize);
+}
+
+/* a key shares its binding's block, which a lookup reads anyway, so
+   a compact table is an ordinary one */
+SymTable_T SymTable_newCompact(void) {
+    return SymTable_new();
+}
+
+/* a missing key costs the same two buckets as a present one, so a
+   cuckoo table goes without a filter */
+int SymTable_addFilter(SymTable_T oSymTable) {
+    assert(oSymTable != NULL);
+    return TRUE;
+}
+
+void SymTable_free(SymTable_T oSymTable) {
+    assert(oSymTable != NULL);
+    if (oSymTable->snapshot != NULL) {
+        SymTable_free(oSymTable->snapshot);
+    }
+    SymTable_freeBuckets(oSymTable, &oSymTable->buckets, TRUE);
+    if (oSymTable->pool != NULL) {
+        oSymTable->pool->refCount--;
+        if (oSymTable->pool->refCount == 0) {
+            SymTable_release(oSymTable, oSymTable->pool);
+        }
+    }
+    SymTable_release(oSymTable, oSymTable->oldValue);
+    SymTable_release(oSymTable, oSymTable);
+}
+
+SymTable_T SymTable_clone(SymTable_T oSymTable) {
+    SymTable_T copy;
+    size_t uBlockCount;
+    size_t i;
+    assert(oSymTable != NULL);
+    assert(oSymTable->snapshot == NULL);
+    copy = SymTable_create(oSymTable->pfAlloc, oSymTable->pfFree,
+        oSymTable->pvContext, oSymTable->valueSize);
+    if (copy == NULL) {
+        return NULL;
+    }
+
+    /*the clone points to the same blocks, and either table copies the
+    blocks it changes from then on*/
+    if (oSymTable->buckets.blocks != NULL) {
+        uBlockCount = (size_t)1 << (oSymTable->buckets.bucketBits -
+            oSymTable->buckets.blockBits);
+        copy->buckets.blocks = (struct Bucket**)SymTable_alloc(copy,
+            uBlockCount * sizeof(struct Bucket*));
+        if (copy->buckets.blocks == NULL) {
+            SymTable_free(copy);
+            return NULL;
+        }
+        for (i = 0; i < uBlockCount; i++) {
+            copy->buckets.blocks[i] = oSymTable->buckets.blocks[i];
+            SymTable_header(copy->buckets.blocks[i])->refCount++;
+        }
+        copy->buckets.bucketBits = oSymTable->buckets.bucketBits;
+        copy->buckets.blockBits = oSymTable->buckets.blockBits;
+    }
+    copy->counter = oSymTable->counter;
+
+    /*buckets are picked with the seed, which must therefore match*/
+    copy->seed = oSymTable->seed;
+
+    /*values in the pool must outlive every table that holds them*/
+    copy->pool = oSymTable->pool;
+    if (copy->pool != NULL) {
+        copy->pool->refCount++;
+    }
+    return copy;
+}
+
+size_t SymTable_getLength(SymTable_T oSymTable) {
+    assert(oSymTable != NULL);
+    return oSymTable->counter;
+}
+
+/* Adds a binding whose key is the uLength characters at pcKey, with
+   hash code uHash, and whose value is pvValue to oSymTable, which
+   must not bind the key, and returns it, or returns NULL if
+   insufficient memory is available, in which case no binding was
+   added. */
+static struct Bind *SymTable_add(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength, size_t uHash,
+    const void *pvValue) {
+    struct Bind *bind;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    /*grows before the table gets so full that free slots are hard to
+    reach; a table that cannot grow goes on filling its free slots*/
+    if (oSymTable->buckets.blocks == NULL ||
+        (oSymTable->counter + 1) * 8 > LOAD_EIGHTHS * SLOT_COUNT *
+        ((size_t)1 << oSymTable->buckets.bucketBits)) {
+        (void)SymTable_grow(oSymTable);
+        if (oSymTable->buckets.blocks == NULL) {
+            return NULL;
+        }
+    }
+
+    bind = SymTable_newBind(oSymTable, pcKey, uLength, pvValue);
+    if (bind == NULL) {
+        return NULL;
+    }
+    while (!SymTable_place(oSymTable, &oSymTable->buckets, bind,
+        uHash)) {
+        if (!SymTable_grow(oSymTable)) {
+            SymTable_release(oSymTable, bind);
+            return NULL;
+        }
+    }
+    oSymTable->counter++;
+    return bind;
+}
+
+/* Returns the slot that holds the value of the binding of oSymTable
+   whose key is the uLength characters at pcKey, with hash code
+   uHash. If there is no such binding, first adds one whose value is
+   pvValue. Sets *piAdded to TRUE if the binding was added and FALSE
+   otherwise. Returns NULL if insufficient memory is available, in
+   which case no binding was added. */
+static const void **SymTable_findOrAdd(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength, size_t uHash,
+    const void *pvValue, int *piAdded) {
+    struct Bucket *bucket;
+    struct Bind *bind;
+    size_t i;
+    size_t j;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    assert(piAdded != NULL);
+    *piAdded = FALSE;
+
+    /*the caller may change the value, so its block must be owned*/
+    if (SymTable_findSlot(oSymTable, pcKey, uLength, uHash, &i, &j) !=
+        NULL) {
+        if (!SymTable_ownBlock(oSymTable, &oSymTable->buckets,
+            i >> oSymTable->buckets.blockBits)) {
+            return NULL;
+        }
+        bucket = SymTable_bucket(&oSymTable->buckets, i);
+        return &bucket->binds[j]->value;
+    }
+
+    bind = SymTable_add(oSymTable, pcKey, uLength, uHash, pvValue);
+    if (bind == NULL) {
+        return NULL;
+    }
+    *piAdded = TRUE;
+    return &bind->value;
+}
+
+/* Adds a binding whose key is the uLength characters at pcKey, with
+   hash code uHash, and whose value is pvValue to oSymTable and
+   returns TRUE, or returns FALSE if the key is already bound or if
+   insufficient memory is available. A key that is already bound
+   leaves its block shared with any clone, since nothing changes. */
+static int SymTable_insert(SymTable_T oSymTable, const char *pcKey,
+    size_t uLength, size_t uHash, const void *pvValue) {
+    size_t i;
+    size_t j;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    if (SymTable_findSlot(oSymTable, pcKey, uLength, uHash, &i, &j) !=
+        NULL) {
+        return FALSE;
+    }
+    return SymTable_add(oSymTable, pcKey, uLength, uHash, pvValue) !=
+        NULL;
+}
+
+int SymTable_put(SymTable_T oSymTable,
+    const char *pcKey, const void *pvValue) {
+    size_t uLength;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    uLength = strlen(pcKey);
+    return SymTable_insert(oSymTable, pcKey, uLength,
+        SymTable_sipHash(pcKey, uLength), pvValue);
+}
+
+int SymTable_putN(SymTable_T oSymTable, const char *pcKey,
+    size_t uLength, const void *pvValue) {
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    assert(memchr(pcKey, '\0', uLength) == NULL);
+    return SymTable_insert(oSymTable, pcKey, uLength,
+        SymTable_sipHash(pcKey, uLength), pvValue);
+}
+
+int SymTable_putWithHash(SymTable_T oSymTable,
+    const char *pcKey, size_t uHash, const void *pvValue) {
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    assert(uHash == SymTable_hashKey(pcKey));
+    return SymTable_insert(oSymTable, pcKey, strlen(pcKey), uHash,
+        pvValue);
+}
+
+void *SymTable_replace(SymTable_T oSymTable,
+    const char *pcKey, const void *pvValue) {
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    return SymTable_replaceN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+void *SymTable_replaceN(SymTable_T oSymTable, const char *pcKey,
+    size_t uLength, const void *pvValue) {
+    struct Bucket *bucket;
+    size_t j;
+    void *val;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    bucket = SymTable_findOwned(oSymTable, pcKey, uLength,
+        SymTable_sipHash(pcKey, uLength), &j);
+    if (bucket == NULL) {
+        return NULL;
+    }
+
+    /* replaces the value with a given value */
+    val = SymTable_saveValue(oSymTable, bucket->binds[j]->value);
+    SymTable_setValue(oSymTable, &bucket->binds[j]->value, pvValue);
+    return val;
+}
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey) {
+    size_t uLength;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    uLength = strlen(pcKey);
+    return SymTable_find(oSymTable, pcKey, uLength,
+        SymTable_sipHash(pcKey, uLength)) != NULL;
+}
+
+int SymTable_containsN(SymTable_T oSymTable, const char *pcKey,
+    size_t uLength) {
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    assert(memchr(pcKey, '\0', uLength) == NULL);
+    return SymTable_find(oSymTable, pcKey, uLength,
+        SymTable_sipHash(pcKey, uLength)) != NULL;
+}
+
+int SymTable_containsWithHash(SymTable_T oSymTable,
+    const char *pcKey, size_t uHash) {
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    assert(uHash == SymTable_hashKey(pcKey));
+    return SymTable_find(oSymTable, pcKey, strlen(pcKey), uHash) != NULL;
+}
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey) {
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    return SymTable_getN(oSymTable, pcKey, strlen(pcKey));
+}
+
+void *SymTable_getN(SymTable_T oSymTable, const char *pcKey,
+    size_t uLength) {
+    struct Bind *bind;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    bind = SymTable_find(oSymTable, pcKey, uLength,
+        SymTable_sipHash(pcKey, uLength));
+    if (bind == NULL) {
+        return NULL;
+    }
+    return (void*)bind->value;
+}
+
+void *SymTable_getWithHash(SymTable_T oSymTable,
+    const char *pcKey, size_t uHash) {
+    struct Bind *bind;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    assert(uHash == SymTable_hashKey(pcKey));
+    bind = SymTable_find(oSymTable, pcKey, strlen(pcKey), uHash);
+    if (bind == NULL) {
+        return NULL;
+    }
+    return (void*)bind->value;
+}
+
+/* Starts fetching the two buckets that a lookup of a key with hash
+   code uHash in oSymTable reads, so that they are at hand by the
+   time the key is looked up. */
+static void SymTable_prefetch(SymTable_T oSymTable, size_t uHash) {
+    assert(oSymTable != NULL);
+    if (oSymTable->buckets.blocks == NULL) {
+        return;
+    }
+#ifdef __GNUC__
+    __builtin_prefetch(SymTable_bucket(&oSymTable->buckets,
+        SymTable_choice(oSymTable->seed, oSymTable->buckets.bucketBits,
+        uHash, FALSE)));
+    __builtin_prefetch(SymTable_bucket(&oSymTable->buckets,
+        SymTable_choice(oSymTable->seed, oSymTable->buckets.bucketBits,
+        uHash, TRUE)));
+#else
+    (void)uHash;
+#endif
+}
+
+void *SymTable_getFirst(SymTable_T *poSymTables, size_t uCount,
+    const char *pcKey, size_t *puWhich) {
+    struct Bind *bind;
+    size_t uLength;
+    size_t uHash;
+    size_t i;
+    assert(poSymTables != NULL || uCount == 0);
+    assert(pcKey != NULL);
+
+    /*every table hashes a key alike, so the key is hashed once, and
+    the next table's buckets are fetched while this one is searched*/
+    uLength = strlen(pcKey);
+    uHash = SymTable_sipHash(pcKey, uLength);
+    if (uCount > 0) {
+        SymTable_prefetch(poSymTables[0], uHash);
+    }
+    for (i = 0; i < uCount; i++) {
+        assert(poSymTables[i] != NULL);
+        if (i + 1 < uCount) {
+            SymTable_prefetch(poSymTables[i + 1], uHash);
+        }
+        bind = SymTable_find(poSymTables[i], pcKey, uLength, uHash);
+        if (bind != NULL) {
+            if (puWhich != NULL) {
+                *puWhich = i;
+            }
+            return (void*)bind->value;
+        }
+    }
+    if (puWhich != NULL) {
+        *puWhich = uCount;
+    }
+    return NULL;
+}
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    return SymTable_removeN(oSymTable, pcKey, strlen(pcKey));
+}
+
+void *SymTable_removeN(SymTable_T oSymTable, const char *pcKey,
+    size_t uLength) {
+    struct Bucket *bucket;
+    struct Bind *bind;
+    size_t j;
+    void *pvOldValue;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    bucket = SymTable_findOwned(oSymTable, pcKey, uLength,
+        SymTable_sipHash(pcKey, uLength), &j);
+    if (bucket == NULL) {
+        return NULL;
+    }
+
+    /* frees the binding, decrements counter, returns val*/
+    bind = bucket->binds[j];
+    bucket->binds[j] = NULL;
+    bucket->hashes[j] = 0;
+    pvOldValue = SymTable_saveValue(oSymTable, bind->value);
+    SymTable_release(oSymTable, bind);
+    oSymTable->counter--;
+    return pvOldValue;
+}
+
+/* A transaction keeps a clone of the table as it was when the
+   transaction began, which costs little since the two share their
+   memory until the table changes; rolling back swaps it in. */
+int SymTable_beginTxn(SymTable_T oSymTable) {
+    assert(oSymTable != NULL);
+    assert(oSymTable->snapshot == NULL);
+    oSymTable->snapshot = SymTable_clone(oSymTable);
+    return oSymTable->snapshot != NULL;
+}
+
+void SymTable_commit(SymTable_T oSymTable) {
+    assert(oSymTable != NULL);
+    assert(oSymTable->snapshot != NULL);
+    SymTable_free(oSymTable->snapshot);
+    oSymTable->snapshot = NULL;
+}
+
+void SymTable_rollback(SymTable_T oSymTable) {
+    struct SymTable changed;
+    SymTable_T snapshot;
+    assert(oSymTable != NULL);
+    assert(oSymTable->snapshot != NULL);
+
+    /*the table takes the snapshot's contents, and the snapshot the
+    changed ones, which are freed with it*/
+    snapshot = oSymTable->snapshot;
+    changed = *oSymTable;
+    *oSymTable = *snapshot;
+    *snapshot = changed;
+    snapshot->snapshot = NULL;
+    SymTable_free(snapshot);
+}
+
+/* Lookups probe at most two buckets, so no profile is kept. */
+void SymTable_dumpProfile(FILE *psFile) {
+    assert(psFile != NULL);
+    fprintf(psFile,
+        "SymTable profile not kept by this implementation\n");
+}
+
+int SymTable_upsert(SymTable_T oSymTable,
+    const char *pcKey, const void *pvValue) {
+    const void **slot;
+    size_t uLength;
+    int iAdded;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    uLength = strlen(pcKey);
+    slot = SymTable_findOrAdd(oSymTable, pcKey, uLength,
+        SymTable_sipHash(pcKey, uLength), pvValue, &iAdded);
+    if (slot == NULL) {
+        return FALSE;
+    }
+    SymTable_setValue(oSymTable, slot, pvValue);
+    return TRUE;
+}
+
+void **SymTable_getOrInsert(SymTable_T oSymTable,
+    const char *pcKey, const void *pvValue) {
+    size_t uLength;
+    int iAdded;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    uLength = strlen(pcKey);
+    return (void**)SymTable_findOrAdd(oSymTable, pcKey, uLength,
+        SymTable_sipHash(pcKey, uLength), pvValue, &iAdded);
+}
+
+/* Applies *pfApply to each binding of oSymTable whose key begins with
+   the uPrefixLength characters at pcPrefix, is at least pcLo if it
+   is not NULL, and is less than pcHi if it is not NULL, passing
+   pvExtra as an extra parameter. */
+static void SymTable_visit(SymTable_T oSymTable, const char *pcPrefix,
+    size_t uPrefixLength, const char *pcLo, const char *pcHi,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra) {
+    struct Bucket *bucket;
+    const char *pcKey;
+    size_t i;
+    size_t j;
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+    if (oSymTable->buckets.blocks == NULL) {
+        return;
+    }
+
+    /*a hash table keeps no order, so every slot is filtered*/
+    for (i = 0; i < (size_t)1 << oSymTable->buckets.bucketBits; i++) {
+        bucket = SymTable_bucket(&oSymTable->buckets, i);
+        for (j = 0; j < SLOT_COUNT; j++) {
+            if (bucket->binds[j] == NULL) {
+                continue;
+            }
+            pcKey = SymTable_key(oSymTable, bucket->binds[j]);
+            if (strncmp(pcKey, pcPrefix, uPrefixLength) == 0 &&
+                (pcLo == NULL || strcmp(pcKey, pcLo) >= 0) &&
+                (pcHi == NULL || strcmp(pcKey, pcHi) < 0)) {
+                (*pfApply)(pcKey, (void*)bucket->binds[j]->value,
+                    (void*)pvExtra);
+            }
+        }
+    }
+}
+
+void SymTable_map(SymTable_T oSymTable, void (*pfApply)
+    (const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra) {
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+    SymTable_visit(oSymTable, "", 0, NULL, NULL, pfApply, pvExtra);
+}
+
+void SymTable_mapParallel(SymTable_T oSymTable, void (*pfApply)
+    (const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra, size_t uThreadCount) {
+    /*the buckets are walked by the calling thread alone*/
+    (void)uThreadCount;
+    SymTable_map(oSymTable, pfApply, pvExtra);
+}
+
+void SymTable_rangeMap(SymTable_T oSymTable, const char *pcLo,
+    const char *pcHi, void (*pfApply)
+    (const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra) {
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+    SymTable_visit(oSymTable, "", 0, pcLo, pcHi, pfApply, pvExtra);
+}
+
+void SymTable_prefixMap(SymTable_T oSymTable, const char *pcPrefix,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra) {
+    assert(oSymTable != NULL);
+    assert(pcPrefix != NULL);
+    assert(pfApply != NULL);
+    SymTable_visit(oSymTable, pcPrefix, strlen(pcPrefix), NULL, NULL,
+        pfApply, pvExtra);
+}
+
+SymTable_T SymTable_buildParallel(const char *const *ppcKeys,
+    const void *const *ppvValues, size_t uCount, size_t uThreadCount) {
+    SymTable_T oSymTable;
+    size_t i;
+    assert(uCount == 0 || ppcKeys != NULL);
+    assert(uCount == 0 || ppvValues != NULL);
+
+    /*a put may move bindings of any bucket to make room, so the
+    table is built by the calling thread alone*/
+    (void)uThreadCount;
+    oSymTable = SymTable_new();
+    if (oSymTable == NULL) {
+        return NULL;
+    }
+    for (i = 0; i < uCount; i++) {
+        assert(ppcKeys[i] != NULL);
+        if (!SymTable_put(oSymTable, ppcKeys[i], ppvValues[i]) &&
+            !SymTable_contains(oSymTable, ppcKeys[i])) {
+            SymTable_free(oSymTable);
+            return NULL;
+        }
+    }
+    return oSymTable;
+}
+
+/* Adds a binding to oSymTable for each line of the uLength bytes of
+   text at pcText, which is followed by a zero byte, ending each key &
+   value in place. Returns FALSE if the text holds a '\0' or
+   insufficient memory is available, and TRUE otherwise. */
+static int SymTable_addLines(SymTable_T oSymTable, char *pcText,
+    size_t uLength, char cSeparator) {
+    char *pcLine;
+    char *pcNext;
+    char *pcEnd;
+    char *pcSeparator;
+    char *pcValue;
+    size_t uLineLength;
+    assert(oSymTable != NULL);
+    assert(pcText != NULL);
+
+    pcEnd = pcText + uLength;
+    for (pcLine = pcText; pcLine < pcEnd; pcLine = pcNext + 1) {
+        pcNext = memchr(pcLine, '\n', (size_t)(pcEnd - pcLine));
+        if (pcNext == NULL) {
+            pcNext = pcEnd;
+        }
+        uLineLength = (size_t)(pcNext - pcLine);
+        if (uLineLength > 0 && pcLine[uLineLength - 1] == '\r') {
+            uLineLength--;
+        }
+        if (uLineLength == 0) {
+            continue;
+        }
+        if (memchr(pcLine, '\0', uLineLength) != NULL) {
+            return FALSE;
+        }
+
+        /*the key ends at the separator and the value at the end of
+        the line; without a separator both end there*/
+        pcLine[uLineLength] = '\0';
+        pcSeparator = memchr(pcLine, cSeparator, uLineLength);
+        pcValue = pcLine + uLineLength;
+        if (pcSeparator != NULL) {
+            *pcSeparator = '\0';
+            pcValue = pcSeparator + 1;
+        }
+        if (!SymTable_put(oSymTable, pcLine, pcValue) &&
+            !SymTable_contains(oSymTable, pcLine)) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+SymTable_T SymTable_load(const char *pcPath, char cSeparator) {
+    SymTable_T oSymTable;
+    FILE *psFile;
+    char *pcText;
+    long lLength;
+    assert(pcPath != NULL);
+    assert(cSeparator != '\n' && cSeparator != '\r' &&
+        cSeparator != '\0');
+
+    oSymTable = SymTable_new();
+    if (oSymTable == NULL) {
+        return NULL;
+    }
+    psFile = fopen(pcPath, "rb");
+    if (psFile == NULL) {
+        SymTable_free(oSymTable);
+        return NULL;
+    }
+
+    /*the whole file is read into the pool, followed by a zero byte
+    that ends a last line without a newline*/
+    lLength = -1;
+    if (fseek(psFile, 0, SEEK_END) == 0) {
+        lLength = ftell(psFile);
+    }
+    if (lLength >= 0 && fseek(psFile, 0, SEEK_SET) == 0) {
+        oSymTable->pool = (struct Pool*)SymTable_alloc(oSymTable,
+            sizeof(struct Pool) + (size_t)lLength + 1);
+    }
+    if (oSymTable->pool != NULL) {
+        oSymTable->pool->refCount = 1;
+        pcText = (char*)(oSymTable->pool + 1);
+        pcText[lLength] = '\0';
+        if (fread(pcText, 1, (size_t)lLength, psFile) !=
+            (size_t)lLength || !SymTable_addLines(oSymTable, pcText,
+            (size_t)lLength, cSeparator)) {
+            (void)fclose(psFile);
+            SymTable_free(oSymTable);
+            return NULL;
+        }
+    }
+    (void)fclose(psFile);
+    if (oSymTable->pool == NULL) {
+        SymTable_free(oSymTable);
+        return NULL;
+    }
+    return oSymTable;
+}
@@ -3,328 +3,3934 @@
 /* Author: Arnold Jiang                                              */
 /*-------------------------------------------------------------------*/
 
+/* MAP_ANONYMOUS and madvise() are not part of C99 or base POSIX */
+#define _DEFAULT_SOURCE
+
 #include "symtable.h"
 #include <assert.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 /*defines FALSE (0) and TRUE (1)*/
 enum {FALSE, TRUE};
 
-/*global variable to store total bucket counts as a size_t array*/
-static const size_t auBucketCounts[] = {509, 1021, 2039, 
-    4093, 8191, 16381, 32749, 65521};
+/*global variable to store total bucket counts as a size_t array.
+The small leading counts keep tables that only ever hold a handful
+of bindings (e.g. function scopes) from paying for 509 buckets*/
+static const size_t auBucketCounts[] = {7, 31, 127, 509, 1021, 2039, 
+    4093, 8191, 16381, 32749, 65521, 131071, 262139, 524287, 1048573,
+    2097143, 4194301, 8388593, 16777213, 33554393, 67108859, 134217689,
+    268435399, 536870909, 1073741789, 2147483647};
 
 /* A SymTable structure is a "manager" structure that points to 
-"buckets" that points to a specific bucket and contains a size_t 
-counter that maintains the number of binds & another counter 
-that counts the number of buckets*/
+"buckets", an array that holds the first bind of each bucket itself, 
+and contains a size_t counter that maintains the number of binds & 
+another counter that counts the number of buckets. Keeping the first 
+bind in the array means that a hit on a bucket with one bind costs 
+a single cache miss instead of two dependent ones. The bucket array 
+is not allocated until the first binding is put, so an empty 
+SymTable costs a single small allocation. All memory comes from the 
+table's allocator. A table made by SymTable_newInline keeps each value 
+right after its bind, so a bucket takes bindSize bytes of the array 
+rather than sizeof(struct Bind). A table and its clones share one 
+bucket array, with its chains & keys, until they change it. A table 
+made by SymTable_load keeps the keys from its file in a pool, and one 
+made by SymTable_newCompact keeps all of its keys in a store*/
 struct SymTable {
-    /*pointer to a pointer to a bucket*/
-    struct Bind **buckets;
+    /*pointer to the bucket array, NULL while the table has never 
+    held a binding*/
+    struct Bind *buckets;
     /*tracks the number of binds*/
     size_t counter;
     /*trakcs the number of buckets*/
     size_t bucketCount;
+    /*secret that is mixed into every hash code before it picks a 
+    bucket, so that no two tables spread keys alike*/
+    size_t seed;
+    /*bytes in each value stored in the binds, or 0 if the binds 
+    hold pointers to values*/
+    size_t valueSize;
+    /*bytes in each bind, including its value*/
+    size_t bindSize;
+    /*holds a copy of the value that the last replace or remove took
+    out of an inline table, or is NULL*/
+    void *oldValue;
+    /*points to the index of each bucket whose chain is long enough to
+    have one, or is NULL while no bucket has an index*/
+    struct Index **indexes;
+    /*tracks the number of buckets with an index*/
+    size_t indexCount;
+    /*counts the tables that share the bucket array, or is NULL while 
+    the array has never been shared with a clone*/
+    size_t *shares;
+    /*points to the table's own copy of each segment of the shared 
+    array that it has changed, or is NULL while it has changed none*/
+    struct Segment **segments;
+    /*points to the text of the file that the table was loaded from, 
+    or is NULL*/
+    struct Pool *pool;
+    /*points to the store that holds the keys of a table made by 
+    SymTable_newCompact, or is NULL*/
+    struct Store *store;
+    /*bytes of the store that the table's keys take up*/
+    size_t keyBytes;
+    /*TRUE if SymTable_addFilter gave the table a filter, which it 
+    goes without while there is not enough memory for one*/
+    int filtered;
+    /*points to the table's filter, or is NULL*/
+    struct Filter *filter;
+    /*points to the undo log of the open transaction, undoCount 
+    records of undoSize bytes each with room for undoCapacity, or is 
+    NULL while no transaction is open*/
+    char *undo;
+    size_t undoCount;
+    size_t undoCapacity;
+    size_t undoSize;
+    /*allocates & frees memory, given pvContext*/
+    void *(*pfAlloc)(size_t uSize, void *pvContext);
+    void (*pfFree)(void *pvBlock, void *pvContext);
+    void *pvContext;
 };
 
 /* A value and unique char* (string) key is stored in a bind. 
-Binds are linked to form a list via a pointer to the next bind*/
+The first bind of a bucket lives in the bucket array; binds that 
+collide with it are allocated separately and linked to form a list 
+via a pointer to the next bind*/
 struct Bind {
-    /*points to a string that represents the key*/
+    /*points to a string that represents the key, or is NULL in a 
+    bucket that holds no binds*/
     char *key;
-    /*points to a value*/
+    /*length of the key, so that most mismatches are rejected 
+    without comparing any characters*/
+    size_t keyLength;
+    /*full hash code of the key, so that chains can be searched and 
+    rehashed without rescanning the key*/
+    size_t hash;
+    /*points to a value, which in an inline table is the storage 
+    right after the bind*/
     const void *value;
     /*points to the next bind in the linked list*/
     struct Bind *next;
 };
 
-/* Return a hash code for pcKey that is between 0 and uBucketCount-1,
-   inclusive. */
-static size_t SymTable_hash(const char *pcKey, size_t uBucketCount)
+/*a chain that grows longer than INDEX_THRESHOLD binds gets an index, 
+which it keeps until it shrinks below UNINDEX_THRESHOLD; the gap 
+keeps a bucket from building and dropping its index over and over*/
+enum {INDEX_THRESHOLD = 8, UNINDEX_THRESHOLD = 6};
+
+/* An Index lets a long chain be searched in O(log n) steps however 
+badly its keys happen to collide. binds[0] is the bind in the bucket 
+array, and binds[1] to binds[count - 1] are the other binds of the 
+chain in ascending order of hash code, key length and characters. 
+The chain is linked in the same order, so that the bind before any 
+other is at hand when it is unlinked*/
+struct Index {
+    /*number of binds in the chain*/
+    size_t count;
+    /*number of binds that binds has room for*/
+    size_t capacity;
+    /*points to the binds of the chain, in order*/
+    struct Bind **binds;
+};
+
+/*a table that shares its bucket array with a clone copies the array 
+SEGMENT_SIZE buckets at a time, when it first changes one of them*/
+enum {SEGMENT_BITS = 8, SEGMENT_SIZE = 1 << SEGMENT_BITS};
+
+/* A Segment is a table's copy of SEGMENT_SIZE buckets of a shared 
+bucket array, together with the chains and keys of those buckets. The 
+buckets follow the header in the same block. Cloning a table shares 
+its segments as well, so a segment is freed by the last table to 
+drop it*/
+struct Segment {
+    /*number of tables that read the segment*/
+    size_t refCount;
+};
+
+/* A Pool holds the text of a file that SymTable_load read, which the 
+keys & values of its lines point into, so that loading allocates no 
+memory per binding. The text is mapped privately, so the lines can be 
+ended in place, and is followed by one more zero byte to end a last 
+line without a newline. A key in the pool is never freed on its own; 
+the whole pool is unmapped by the last table of its family to be 
+freed*/
+struct Pool {
+    /*number of tables that read the pool*/
+    size_t refCount;
+    /*points to the text, which is length bytes without the extra 
+    byte*/
+    char *text;
+    size_t length;
+};
+
+/*bytes at the start of a file whose lines SymTable_load counts, to 
+estimate how many lines the whole file has*/
+enum {SAMPLE_BYTES = 1 << 20};
+
+/*a compact table splits only keys shorter than MAX_SPLIT_KEY, so that 
+a key's encoding fits in ENCODED_SIZE bytes on the stack, and stores 
+keys in chunks of STORE_CHUNK_SIZE bytes; its set of prefixes starts 
+with MIN_PREFIX_SLOTS slots*/
+enum {MAX_SPLIT_KEY = 240, ENCODED_SIZE = MAX_SPLIT_KEY + 16,
+    STORE_CHUNK_SIZE = 64 * 1024, MIN_PREFIX_SLOTS = 64};
+
+/* A Store holds the keys of a table made by SymTable_newCompact, 
+packed end to end in chunks instead of allocated one by one. A key 
+shorter than MAX_SPLIT_KEY that holds a '.', ':' or '/' is split after 
+the last of them. The part before the split is a prefix, which the 
+store keeps once however many keys begin with it, and the key is 
+stored as '\0', the number of its prefix in LEB128 and the rest of its 
+characters, without a '\0' at the end. No key holds '\0', so such an 
+encoding never equals a key that is stored as itself, as every other 
+key is, '\0' and all. A table and its clones share one store, to which 
+keys are only ever added; the last table of the family to be freed 
+frees it, and a table that has it to itself packs it again once 
+removals have left most of it unused*/
+struct Store {
+    /*number of tables that read the store*/
+    size_t refCount;
+    /*points to the newest chunk, which is linked to the older ones*/
+    struct Chunk *chunks;
+    /*points to the free bytes at the end of the newest chunk, of 
+    which there are room*/
+    char *next;
+    size_t room;
+    /*bytes taken from the chunks, and the part of them that prefixes 
+    take*/
+    size_t used;
+    size_t prefixBytes;
+    /*points to each prefix, by number*/
+    struct Prefix **prefixes;
+    size_t prefixCount;
+    /*set of the prefixes, with open addressing: each slot holds one 
+    more than the number of a prefix, or 0 if it is empty. slotCount is 
+    0 or a power of 2, and prefixes has room for slotCount / 2*/
+    size_t *slots;
+    size_t slotCount;
+};
+
+/* A Prefix is the first length characters of keys in a Store, which 
+follow the header in the same chunk*/
+struct Prefix {
+    /*hash code of the characters*/
+    size_t hash;
+    size_t length;
+};
+
+/* A Chunk is a block of a Store, whose keys & prefixes follow the 
+header*/
+struct Chunk {
+    /*points to the chunk that was allocated before it, or is NULL*/
+    struct Chunk *next;
+};
+
+/*a filter sets FILTER_PROBES bits for each key, all in one block of 
+FILTER_BLOCK_WORDS words, and has FILTER_BITS_PER_BUCKET bits for each 
+bucket of its table*/
+enum {FILTER_PROBES = 6, FILTER_BLOCK_WORDS = 8,
+    FILTER_BITS_PER_BUCKET = 10};
+
+/* A Filter is a Bloom filter of the hash codes of a table's keys, 
+which turns away most lookups of keys that are not there without a 
+look at the buckets. Each block is one cache line, so a lookup reads 
+a single line of the filter. Removing a key leaves its bits set, so 
+the filter is built again from the table once more keys have been 
+removed since it was built than the table holds. A table and its 
+clones share a filter until one of them adds a key*/
+struct Filter {
+    /*number of tables that read the filter*/
+    size_t refCount;
+    /*number of blocks*/
+    size_t blockCount;
+    /*number of keys removed since the filter was built*/
+    size_t staleCount;
+    /*the blocks, one after another*/
+    uint64_t words[];
+};
+
+/*kinds of change that an undo record takes back, and the number of 
+records that an undo log has room for when its transaction opens*/
+enum {UNDO_ADD, UNDO_REPLACE, UNDO_REMOVE, MIN_UNDO_CAPACITY = 16};
+
+/* An Undo records a change that an open transaction made to a table, 
+so that SymTable_rollback can take it back; in an inline table, the 
+old value follows the record. The key is in the form that the table 
+stores it. For UNDO_ADD & UNDO_REPLACE it is the binding's own key, 
+which stays where it is until the transaction ends, since nothing 
+rehashes, packs or clones the table meanwhile. For UNDO_REMOVE it is 
+the key that the removed binding held, which the log keeps along with 
+the bind that the removal freed, so that putting the binding back 
+needs no memory*/
+struct Undo {
+    /*UNDO_ADD, UNDO_REPLACE or UNDO_REMOVE*/
+    int kind;
+    char *key;
+    size_t keyLength;
+    size_t hash;
+    /*the value before the change, in a table that is not inline*/
+    const void *value;
+    /*the bind that a removal freed, or NULL*/
+    struct Bind *spare;
+};
+
+/*secret key of SipHash, chosen once per run of the program*/
+static uint64_t auSipKey[2];
+static pthread_once_t sSipKeyOnce = PTHREAD_ONCE_INIT;
+
+/* Chooses auSipKey from /dev/urandom or, where that cannot be read, 
+   from the clock and the addresses that the program was loaded at. */
+static void SymTable_chooseKey(void) {
+    FILE *psFile;
+    int iLocal;
+    psFile = fopen("/dev/urandom", "rb");
+    if (psFile != NULL) {
+        if (fread(auSipKey, sizeof(auSipKey), 1, psFile) == 1) {
+            (void)fclose(psFile);
+            return;
+        }
+        (void)fclose(psFile);
+    }
+    auSipKey[0] = (uint64_t)time(NULL) ^ (uint64_t)(uintptr_t)&iLocal;
+    auSipKey[1] = (uint64_t)clock() ^
+        (uint64_t)(uintptr_t)&SymTable_chooseKey;
+}
+
+/*rotates the 64 bits of x left by b*/
+#define SIP_ROTATE(x, b) (((x) << (b)) | ((x) >> (64 - (b))))
+
+/*one SipRound over the state v0..v3*/
+#define SIP_ROUND(v0, v1, v2, v3) do { \
+    v0 += v1; v1 = SIP_ROTATE(v1, 13); v1 ^= v0; \
+    v0 = SIP_ROTATE(v0, 32); \
+    v2 += v3; v3 = SIP_ROTATE(v3, 16); v3 ^= v2; \
+    v0 += v3; v3 = SIP_ROTATE(v3, 21); v3 ^= v0; \
+    v2 += v1; v1 = SIP_ROTATE(v1, 17); v1 ^= v2; \
+    v2 = SIP_ROTATE(v2, 32); \
+} while (0)
+
+/* Return the SipHash-1-3 code of the uLength bytes at pvBytes under 
+   auSipKey. Without the key, no one can choose keys that collide, 
+   so chains stay short whatever keys a table is given. Words are 
+   read in native byte order, which changes the codes but not their 
+   quality. */
+static size_t SymTable_sipHash(const void *pvBytes, size_t uLength)
 {
-   const size_t HASH_MULTIPLIER = 65599;
+   const unsigned char *pucBytes = (const unsigned char*)pvBytes;
+   uint64_t v0 = auSipKey[0] ^ 0x736f6d6570736575ULL;
+   uint64_t v1 = auSipKey[1] ^ 0x646f72616e646f6dULL;
+   uint64_t v2 = auSipKey[0] ^ 0x6c7967656e657261ULL;
+   uint64_t v3 = auSipKey[1] ^ 0x7465646279746573ULL;
+   uint64_t uWord;
    size_t u;
-   size_t uHash = 0;
+   assert(pvBytes != NULL || uLength == 0);
+
+   for (u = 0; u + 8 <= uLength; u += 8)
+   {
+      memcpy(&uWord, pucBytes + u, 8);
+      v3 ^= uWord;
+      SIP_ROUND(v0, v1, v2, v3);
+      v0 ^= uWord;
+   }
+
+   /*the last 0 to 7 bytes, with the length in the top byte*/
+   uWord = (uint64_t)uLength << 56;
+   pucBytes += u;
+   switch (uLength - u)
+   {
+      case 7: uWord |= (uint64_t)pucBytes[6] << 48; /* FALLTHROUGH */
+      case 6: uWord |= (uint64_t)pucBytes[5] << 40; /* FALLTHROUGH */
+      case 5: uWord |= (uint64_t)pucBytes[4] << 32; /* FALLTHROUGH */
+      case 4: uWord |= (uint64_t)pucBytes[3] << 24; /* FALLTHROUGH */
+      case 3: uWord |= (uint64_t)pucBytes[2] << 16; /* FALLTHROUGH */
+      case 2: uWord |= (uint64_t)pucBytes[1] << 8; /* FALLTHROUGH */
+      case 1: uWord |= (uint64_t)pucBytes[0]; break;
+      default: break;
+   }
+   v3 ^= uWord;
+   SIP_ROUND(v0, v1, v2, v3);
+   v0 ^= uWord;
+
+   v2 ^= 0xff;
+   SIP_ROUND(v0, v1, v2, v3);
+   SIP_ROUND(v0, v1, v2, v3);
+   SIP_ROUND(v0, v1, v2, v3);
+   return (size_t)(v0 ^ v1 ^ v2 ^ v3);
+}
+
+/* Return the hash code of the string pcKey, and store its length 
+   in *puLength. */
+static size_t SymTable_hashString(const char *pcKey, size_t *puLength)
+{
    assert(pcKey != NULL);
-   for (u = 0; pcKey[u] != '\0'; u++)
-      uHash = uHash * HASH_MULTIPLIER + (size_t)pcKey[u];
-   return uHash % uBucketCount;
+   assert(puLength != NULL);
+   *puLength = strlen(pcKey);
+   return SymTable_sipHash(pcKey, *puLength);
 }
 
-/* Expands SymTable_T oSymTable by creating a new bucket array of 
-   the size in auBucketCounts and rehashes all the keys. Returns 
-   a size_t of the new size of the array. */
-static void SymTable_expand(SymTable_T oSymTable) {
-    /*last array index in auBucketCounts[]*/
-    size_t i;
-    size_t j;
-    size_t hash;
-    struct Bind** tmp;
-    struct Bind* curr;
-    struct Bind* next;
-    /*stores the # of buckets at a given time*/
-    size_t numBucketCounts;
-    assert(oSymTable != NULL);
-    i = 0;
-    numBucketCounts = 
-    sizeof(auBucketCounts)/sizeof(auBucketCounts[0]);
+size_t SymTable_hashKey(const char *pcKey)
+{
+   size_t uLength;
+   assert(pcKey != NULL);
+   (void)pthread_once(&sSipKeyOnce, SymTable_chooseKey);
+   return SymTable_hashString(pcKey, &uLength);
+}
 
-    /*increments i to the new index*/
-    while (i < numBucketCounts - 1 && 
-        auBucketCounts[i] <= oSymTable->bucketCount) {
-            i++;
-    }
+size_t SymTable_hashKeyN(const char *pcKey, size_t uLength)
+{
+   assert(pcKey != NULL);
+   (void)pthread_once(&sSipKeyOnce, SymTable_chooseKey);
+   return SymTable_sipHash(pcKey, uLength);
+}
 
-    /* handles the case in which auBucketCounts is at a max*/
-    if (i == numBucketCounts - 1) {
-        return;
-    }
+/*operations that the profile keeps apart: calls of the first 
+PROFILE_SAMPLED_COUNT are counted & one in 1 << SAMPLE_BITS of them 
+timed, while every resize of a bucket array is timed & every chain 
+that grows long enough to get an index is counted. The names are 
+used whether or not SYMTABLE_PROFILE is defined*/
+enum {PROFILE_PUT, PROFILE_GET, PROFILE_CONTAINS, PROFILE_REPLACE,
+    PROFILE_REMOVE, PROFILE_UPSERT, PROFILE_GET_OR_INSERT,
+    PROFILE_GET_FIRST, PROFILE_SAMPLED_COUNT, PROFILE_EXPAND =
+    PROFILE_SAMPLED_COUNT, PROFILE_INDEX, PROFILE_OP_COUNT};
 
-    /*callocs the buckets based on auBucketCounts*/
-    tmp = calloc(auBucketCounts[i], sizeof(struct Bind*));
-    if (tmp == NULL) {
-        return;
-    }    
+#ifdef SYMTABLE_PROFILE
 
-    /*goes through every old bucket & rehashes using the new size*/
-    for (j = 0; j < oSymTable->bucketCount; j++) {
-        curr = oSymTable->buckets[j];
+#ifndef __GNUC__
+#error "SYMTABLE_PROFILE needs __thread and the __atomic builtins"
+#endif
 
-        while (curr != NULL) {
-            /*new hash*/
-            hash = SymTable_hash(curr->key, auBucketCounts[i]); 
-            next = curr->next;
-            curr->next = tmp[hash];
-            tmp[hash] = curr;
-            curr = next;
-        }
-    }
+/*a latency histogram has SUB_BUCKET_COUNT buckets for each power of 
+two nanoseconds up to 2 to the MAX_MAGNITUDE, so that each bucket is 
+within an eighth of the latencies it holds; a profile remembers its 
+thread's last RECENT_RESIZE_COUNT resizes*/
+enum {SAMPLE_BITS = 6, SUB_BUCKET_BITS = 3,
+    SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS, MAX_MAGNITUDE = 40,
+    HISTOGRAM_SIZE = (MAX_MAGNITUDE - SUB_BUCKET_BITS + 2) <<
+    SUB_BUCKET_BITS, RECENT_RESIZE_COUNT = 8};
 
-    /*Frees the old array & sets the pointer to the new array*/
-    free(oSymTable->buckets);
-    oSymTable->bucketCount = auBucketCounts[i];
-    oSymTable->buckets = tmp;
+/* A Profile holds what one thread's calls into every table have 
+cost. Only that thread writes it, so recording needs no lock, and 
+SymTable_dumpProfile reads it with relaxed atomic loads while it may 
+still be changing. Profiles are never freed, so that the calls of 
+threads that have ended are still reported*/
+struct Profile {
+    /*calls of each operation, and the latencies of those timed*/
+    uint64_t calls[PROFILE_OP_COUNT];
+    uint64_t latencies[PROFILE_OP_COUNT][HISTOGRAM_SIZE];
+    uint64_t maxLatency[PROFILE_OP_COUNT];
+    /*the bucket counts that the last resizes reached, and how long 
+    each took, in a ring that resizeCount indexes*/
+    uint64_t resizeBuckets[RECENT_RESIZE_COUNT];
+    uint64_t resizeNanoseconds[RECENT_RESIZE_COUNT];
+    uint64_t resizeCount;
+    /*points to the profile of the thread that began to call before 
+    this one*/
+    struct Profile *next;
+};
+
+/*names of the operations, in the order of their enum*/
+static const char *const apcProfileNames[PROFILE_OP_COUNT] = {"put",
+    "get", "contains", "replace", "remove", "upsert", "getOrInsert",
+    "getFirst", "expand", "index"};
+
+/*the profile of every thread that has called into a table, newest 
+first, and the calling thread's own*/
+static struct Profile *psProfiles;
+static __thread struct Profile *psThreadProfile;
+
+/* Returns the time in nanoseconds since an arbitrary point. */
+static uint64_t SymTable_nanoseconds(void) {
+    struct timespec sTime;
+    (void)clock_gettime(CLOCK_MONOTONIC, &sTime);
+    return (uint64_t)sTime.tv_sec * 1000000000u +
+        (uint64_t)sTime.tv_nsec;
 }
 
-SymTable_T SymTable_new(void) {
-    SymTable_T oSymTable; 
+/* Adds uAmount to *puCounter, which another thread may be reading. */
+static void SymTable_profileAdd(uint64_t *puCounter, uint64_t uAmount) {
+    __atomic_store_n(puCounter, __atomic_load_n(puCounter,
+        __ATOMIC_RELAXED) + uAmount, __ATOMIC_RELAXED);
+}
 
-    /*allocates memory for a new SymTable*/
-    oSymTable = (SymTable_T)malloc(sizeof(struct SymTable));
-    if (oSymTable == NULL) {
+/* Returns the profile of the calling thread, which its first call 
+   allocates and adds to psProfiles, or NULL if insufficient memory 
+   is available for it. */
+static struct Profile *SymTable_threadProfile(void) {
+    struct Profile *psProfile;
+    psProfile = psThreadProfile;
+    if (psProfile != NULL) {
+        return psProfile;
+    }
+    psProfile = (struct Profile*)calloc(1, sizeof(struct Profile));
+    if (psProfile == NULL) {
         return NULL;
-    } 
+    }
+    psProfile->next = __atomic_load_n(&psProfiles, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&psProfiles, &psProfile->next,
+        psProfile, TRUE, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    psThreadProfile = psProfile;
+    return psProfile;
+}
 
-    /*allocates memory for the buckets in the SymTable*/
-    oSymTable->buckets = calloc
-        (auBucketCounts[0], sizeof(struct Bind*));
-    if (oSymTable->buckets == NULL) {
-        free(oSymTable);
-        return NULL;
+/* Counts a call of operation iOp, and returns the calling thread's 
+   profile, or NULL if it has none. */
+static struct Profile *SymTable_profileCount(int iOp) {
+    struct Profile *psProfile;
+    assert(iOp >= 0 && iOp < PROFILE_OP_COUNT);
+    psProfile = SymTable_threadProfile();
+    if (psProfile != NULL) {
+        SymTable_profileAdd(&psProfile->calls[iOp], 1);
     }
+    return psProfile;
+}
 
-    /*Sets counter to 0*/
-    oSymTable->counter = 0;
-    oSymTable->bucketCount = auBucketCounts[0];
+/* Counts a call of operation iOp, and returns the time that it 
+   starts at if it is to be timed, or 0 otherwise. */
+static uint64_t SymTable_profileStart(int iOp) {
+    struct Profile *psProfile;
+    psProfile = SymTable_profileCount(iOp);
+    if (psProfile == NULL) {
+        return 0;
+    }
+    if (iOp < PROFILE_SAMPLED_COUNT && (psProfile->calls[iOp] &
+        ((1u << SAMPLE_BITS) - 1)) != 1) {
+        return 0;
+    }
+    return SymTable_nanoseconds();
+}
 
-    return oSymTable;
+/* Returns the histogram bucket that holds a latency of uNanoseconds. */
+static size_t SymTable_histogramBucket(uint64_t uNanoseconds) {
+    int iMagnitude;
+    if (uNanoseconds < SUB_BUCKET_COUNT) {
+        return (size_t)uNanoseconds;
+    }
+    iMagnitude = 63 - __builtin_clzll(uNanoseconds);
+    if (iMagnitude > MAX_MAGNITUDE) {
+        return HISTOGRAM_SIZE - 1;
+    }
+    return ((size_t)(iMagnitude - SUB_BUCKET_BITS + 1) <<
+        SUB_BUCKET_BITS) + (size_t)((uNanoseconds >> (iMagnitude -
+        SUB_BUCKET_BITS)) & (SUB_BUCKET_COUNT - 1));
 }
 
-void SymTable_free(SymTable_T oSymTable) {
+/* Returns the least latency that histogram bucket uBucket holds. */
+static uint64_t SymTable_histogramFloor(size_t uBucket) {
+    int iMagnitude;
+    if (uBucket < SUB_BUCKET_COUNT) {
+        return uBucket;
+    }
+    iMagnitude = (int)(uBucket >> SUB_BUCKET_BITS) + SUB_BUCKET_BITS - 1;
+    return (uint64_t)(SUB_BUCKET_COUNT + (uBucket &
+        (SUB_BUCKET_COUNT - 1))) << (iMagnitude - SUB_BUCKET_BITS);
+}
+
+/* Records how long the call of operation iOp that started at uStart, 
+   as SymTable_profileStart returned, took, and returns that time in 
+   nanoseconds, or 0 if the call was not timed. */
+static uint64_t SymTable_profileEnd(int iOp, uint64_t uStart) {
+    struct Profile *psProfile;
+    uint64_t uNanoseconds;
+    assert(iOp >= 0 && iOp < PROFILE_OP_COUNT);
+    psProfile = psThreadProfile;
+    if (uStart == 0 || psProfile == NULL) {
+        return 0;
+    }
+    uNanoseconds = SymTable_nanoseconds() - uStart;
+    SymTable_profileAdd(&psProfile->latencies[iOp]
+        [SymTable_histogramBucket(uNanoseconds)], 1);
+    if (uNanoseconds > psProfile->maxLatency[iOp]) {
+        __atomic_store_n(&psProfile->maxLatency[iOp], uNanoseconds,
+            __ATOMIC_RELAXED);
+    }
+    return uNanoseconds;
+}
+
+/* Records a resize of a bucket array to uBucketCount buckets that 
+   started at uStart. */
+static void SymTable_profileResize(uint64_t uStart, size_t uBucketCount)
+{
+    struct Profile *psProfile;
+    uint64_t uNanoseconds;
+    size_t uSlot;
+    uNanoseconds = SymTable_profileEnd(PROFILE_EXPAND, uStart);
+    psProfile = psThreadProfile;
+    if (uStart == 0 || psProfile == NULL) {
+        return;
+    }
+    uSlot = (size_t)(psProfile->resizeCount % RECENT_RESIZE_COUNT);
+    __atomic_store_n(&psProfile->resizeBuckets[uSlot],
+        (uint64_t)uBucketCount, __ATOMIC_RELAXED);
+    __atomic_store_n(&psProfile->resizeNanoseconds[uSlot], uNanoseconds,
+        __ATOMIC_RELAXED);
+    SymTable_profileAdd(&psProfile->resizeCount, 1);
+}
+
+/* Returns the least latency that at least uPermille thousandths of 
+   the uCount latencies in histogram auLatencies are no greater than, 
+   to within the width of its bucket. */
+static uint64_t SymTable_percentile(const uint64_t *auLatencies,
+    uint64_t uCount, uint64_t uPermille) {
+    uint64_t uSeen;
     size_t i;
-    struct Bind *bind;
-    struct Bind *next;
-    assert(oSymTable != NULL);
+    assert(auLatencies != NULL);
+    uSeen = 0;
+    for (i = 0; i < HISTOGRAM_SIZE; i++) {
+        uSeen += auLatencies[i];
+        if (uSeen > 0 && uSeen * 1000 >= uCount * uPermille) {
+            return SymTable_histogramFloor(i);
+        }
+    }
+    return 0;
+}
 
-    /*iterates through every bucket, goes through every node 
-    in each bucket, and removes the key & node*/
-    for (i = 0; i < oSymTable->bucketCount; i++) {
-        bind = oSymTable->buckets[i];
-        while (bind != NULL) {
-            next = bind->next;
-            free(bind->key);
-            free(bind);
-            bind = next;
+void SymTable_dumpProfile(FILE *psFile) {
+    uint64_t auLatencies[HISTOGRAM_SIZE];
+    struct Profile *psProfile;
+    uint64_t uCalls;
+    uint64_t uTimed;
+    uint64_t uMax;
+    uint64_t uResizes;
+    size_t uThreads;
+    size_t i;
+    int iOp;
+    assert(psFile != NULL);
+
+    uThreads = 0;
+    for (psProfile = __atomic_load_n(&psProfiles, __ATOMIC_ACQUIRE);
+        psProfile != NULL; psProfile = psProfile->next) {
+        uThreads++;
+    }
+    fprintf(psFile, "SymTable profile of %lu thread(s), timing 1 call "
+        "in %u and every resize\n", (unsigned long)uThreads,
+        1u << SAMPLE_BITS);
+    fprintf(psFile, "%-12s %12s %10s %10s %10s %10s %12s\n",
+        "operation", "calls", "timed", "p50 ns", "p99 ns", "p99.9 ns",
+        "max ns");
+
+    /*the histograms of every thread are summed, one operation at a 
+    time*/
+    for (iOp = 0; iOp < PROFILE_OP_COUNT; iOp++) {
+        memset(auLatencies, 0, sizeof(auLatencies));
+        uCalls = 0;
+        uTimed = 0;
+        uMax = 0;
+        for (psProfile = __atomic_load_n(&psProfiles, __ATOMIC_ACQUIRE);
+            psProfile != NULL; psProfile = psProfile->next) {
+            uCalls += __atomic_load_n(&psProfile->calls[iOp],
+                __ATOMIC_RELAXED);
+            for (i = 0; i < HISTOGRAM_SIZE; i++) {
+                auLatencies[i] += __atomic_load_n(
+                    &psProfile->latencies[iOp][i], __ATOMIC_RELAXED);
+            }
+            if (__atomic_load_n(&psProfile->maxLatency[iOp],
+                __ATOMIC_RELAXED) > uMax) {
+                uMax = __atomic_load_n(&psProfile->maxLatency[iOp],
+                    __ATOMIC_RELAXED);
+            }
+        }
+        for (i = 0; i < HISTOGRAM_SIZE; i++) {
+            uTimed += auLatencies[i];
+        }
+        if (uCalls == 0) {
+            continue;
+        }
+        if (uTimed == 0) {
+            fprintf(psFile, "%-12s %12llu\n", apcProfileNames[iOp],
+                (unsigned long long)uCalls);
+            continue;
         }
+        fprintf(psFile, "%-12s %12llu %10llu %10llu %10llu %10llu "
+            "%12llu\n", apcProfileNames[iOp], (unsigned long long)uCalls,
+            (unsigned long long)uTimed, (unsigned long long)
+            SymTable_percentile(auLatencies, uTimed, 500),
+            (unsigned long long)SymTable_percentile(auLatencies, uTimed,
+            990), (unsigned long long)SymTable_percentile(auLatencies,
+            uTimed, 999), (unsigned long long)uMax);
     }
 
-    /*frees the linked list array: buckets & overall SymTable*/
-    free(oSymTable->buckets);
-    free(oSymTable);
+    /*the last resizes of each thread, oldest first*/
+    for (psProfile = __atomic_load_n(&psProfiles, __ATOMIC_ACQUIRE);
+        psProfile != NULL; psProfile = psProfile->next) {
+        uResizes = __atomic_load_n(&psProfile->resizeCount,
+            __ATOMIC_RELAXED);
+        for (i = uResizes < RECENT_RESIZE_COUNT ? 0 :
+            (size_t)(uResizes - RECENT_RESIZE_COUNT);
+            i < uResizes; i++) {
+            fprintf(psFile, "resize to %llu buckets took %llu ns\n",
+                (unsigned long long)__atomic_load_n(
+                &psProfile->resizeBuckets[i % RECENT_RESIZE_COUNT],
+                __ATOMIC_RELAXED), (unsigned long long)__atomic_load_n(
+                &psProfile->resizeNanoseconds[i % RECENT_RESIZE_COUNT],
+                __ATOMIC_RELAXED));
+        }
+    }
 }
 
-size_t SymTable_getLength(SymTable_T oSymTable) {
-    assert(oSymTable != NULL);
-    return oSymTable->counter;
+#else
+
+/*without SYMTABLE_PROFILE, the hooks compile to nothing*/
+#define SymTable_profileCount(iOp) ((void)0)
+#define SymTable_profileStart(iOp) ((uint64_t)0)
+#define SymTable_profileEnd(iOp, uStart) ((void)(uStart))
+#define SymTable_profileResize(uStart, uBucketCount) ((void)(uStart))
+
+void SymTable_dumpProfile(FILE *psFile) {
+    assert(psFile != NULL);
+    fprintf(psFile, "SymTable profile not kept: built without "
+        "SYMTABLE_PROFILE\n");
 }
 
-int SymTable_put(SymTable_T oSymTable,
-    const char *pcKey, const void *pvValue) {
-        struct Bind *newBind;
-        char *copy;
-        size_t hash;
-        assert(oSymTable != NULL);
-        assert(pcKey != NULL);
+#endif
 
-        /*Calls expand function to allocate more space and set 
-        bucketcount equal to the new size*/
-        if (oSymTable->counter == oSymTable->bucketCount) {
-            SymTable_expand(oSymTable);
-        }
+/* Returns uSize bytes from malloc. pvContext is unused. */
+static void *SymTable_defaultAlloc(size_t uSize, void *pvContext) {
+    (void)pvContext;
+    return malloc(uSize);
+}
 
-        hash = SymTable_hash(pcKey, oSymTable->bucketCount);
+/* Returns pvBlock to free. pvContext is unused. */
+static void SymTable_defaultFree(void *pvBlock, void *pvContext) {
+    (void)pvContext;
+    free(pvBlock);
+}
 
-        /* checks if pcKey exists already in SymTable*/
-        if (SymTable_contains(oSymTable, pcKey)) {
-            return FALSE;
-        }
+/* Returns uSize bytes from the allocator of oSymTable, or NULL if 
+   insufficient memory is available. */
+static void *SymTable_alloc(SymTable_T oSymTable, size_t uSize) {
+    assert(oSymTable != NULL);
+    return (*oSymTable->pfAlloc)(uSize, oSymTable->pvContext);
+}
 
-        /*Makes a Defensive Copy of the string that pcKey points to &
-        stores the address of that copy in a new binding*/
-        copy = malloc(strlen(pcKey) + 1);
-        if (copy == NULL) {
-            return FALSE;
-        }
-        strcpy(copy, pcKey);
+/* Returns pvBlock to the allocator of oSymTable. */
+static void SymTable_release(SymTable_T oSymTable, void *pvBlock) {
+    assert(oSymTable != NULL);
+    (*oSymTable->pfFree)(pvBlock, oSymTable->pvContext);
+}
 
-        /*allocates memory for the newBind*/
-        newBind = (struct Bind*)malloc(sizeof(struct Bind));
-        if (newBind == NULL) {
-            free(copy);
-            return FALSE;
-        }
+/* Returns TRUE if pcKey lies in the pool of oSymTable, and FALSE 
+   otherwise. */
+static int SymTable_isPooled(SymTable_T oSymTable, const char *pcKey) {
+    assert(oSymTable != NULL);
+    return oSymTable->pool != NULL && (uintptr_t)pcKey -
+        (uintptr_t)oSymTable->pool->text <= oSymTable->pool->length;
+}
 
-        /*assigns key and value*/
-        newBind->key = (char*)copy;
-        newBind->value = (void*)pvValue;
-        
-        /*inserts the newBind into the SymTable*/
-        newBind->next = oSymTable->buckets[hash];
-        oSymTable->buckets[hash] = newBind;
-        oSymTable->counter++;
-        return TRUE;
+/* Frees key, a key of oSymTable, unless it lies in the table's pool 
+   or store, which outlive it. */
+static void SymTable_releaseKey(SymTable_T oSymTable, char *key) {
+    assert(oSymTable != NULL);
+    if (oSymTable->store == NULL && !SymTable_isPooled(oSymTable, key)) {
+        SymTable_release(oSymTable, key);
     }
+}
 
-void *SymTable_replace(SymTable_T oSymTable, 
-    const char *pcKey, const void *pvValue) {
-        size_t hash;
-        struct Bind *tmp;
-        void* val;
-        assert(oSymTable != NULL);
-        assert(pcKey != NULL);
-        val = NULL;
-        hash = SymTable_hash(pcKey, oSymTable->bucketCount);
-        
-        /* checks if oSymTable contains the key */
-        if (SymTable_contains(oSymTable, pcKey) != 1) {
-            return NULL;
-        }
+/* Returns TRUE if the uLength characters at pcKey are the encoding of 
+   a key that a compact table split, and FALSE otherwise. */
+static int SymTable_isEncoded(const char *pcKey, size_t uLength) {
+    assert(pcKey != NULL);
+    return uLength > 0 && pcKey[0] == '\0';
+}
 
-        /* replaces the value with a given value */
-        for (tmp = oSymTable->buckets[hash]; 
-            tmp != NULL; tmp = tmp->next){
-            if (strcmp(pcKey, tmp->key) == 0) {
-                val = (void*)tmp->value;
-                tmp->value = pvValue;
+/* Returns the number of bytes that a store takes to hold the key of 
+   oSymTable whose stored form is the uLength characters at pcKey. */
+static size_t SymTable_keySize(const char *pcKey, size_t uLength) {
+    assert(pcKey != NULL);
+    return SymTable_isEncoded(pcKey, uLength) ? uLength : uLength + 1;
+}
+
+/* Returns uSize bytes from the store of oSymTable, starting on a 
+   boundary fit for a Prefix if iAligned is TRUE, or NULL if 
+   insufficient memory is available. */
+static char *SymTable_storeBytes(SymTable_T oSymTable, size_t uSize,
+    int iAligned) {
+    struct Store *store;
+    struct Chunk *chunk;
+    size_t uPad;
+    size_t uChunkSize;
+    char *pcBytes;
+    assert(oSymTable != NULL);
+    assert(oSymTable->store != NULL);
+    store = oSymTable->store;
+
+    uPad = 0;
+    if (iAligned) {
+        uPad = (size_t)(-(uintptr_t)store->next) & (sizeof(size_t) - 1);
+    }
+    if (uSize + uPad > store->room) {
+        /*a key too big to share a chunk gets one of its own, behind 
+        the newest chunk, whose room is still used*/
+        if (uSize > STORE_CHUNK_SIZE / 4 && store->chunks != NULL) {
+            chunk = (struct Chunk*)SymTable_alloc(oSymTable,
+                sizeof(struct Chunk) + uSize);
+            if (chunk == NULL) {
+                return NULL;
             }
+            chunk->next = store->chunks->next;
+            store->chunks->next = chunk;
+            store->used += uSize;
+            return (char*)(chunk + 1);
         }
-        return val;
+        uChunkSize = uSize > STORE_CHUNK_SIZE ? uSize : STORE_CHUNK_SIZE;
+        chunk = (struct Chunk*)SymTable_alloc(oSymTable,
+            sizeof(struct Chunk) + uChunkSize);
+        if (chunk == NULL) {
+            return NULL;
+        }
+        chunk->next = store->chunks;
+        store->chunks = chunk;
+        store->next = (char*)(chunk + 1);
+        store->room = uChunkSize;
+        uPad = 0;
     }
+    pcBytes = store->next + uPad;
+    store->next = pcBytes + uSize;
+    store->room -= uPad + uSize;
+    store->used += uPad + uSize;
+    return pcBytes;
+}
 
-int SymTable_contains(SymTable_T oSymTable, const char *pcKey) {
-    size_t hash;
-    struct Bind *tmp;
+/* Frees every chunk in the list that chunk begins, which belongs to 
+   the store of oSymTable. */
+static void SymTable_freeChunks(SymTable_T oSymTable,
+    struct Chunk *chunk) {
+    struct Chunk *next;
     assert(oSymTable != NULL);
-    assert(pcKey != NULL);
-    hash = SymTable_hash(pcKey, oSymTable->bucketCount);
-
-    /*searches the oSymTable*/
-    for (tmp = oSymTable->buckets[hash]; tmp != NULL; tmp = tmp->next){
-        if (strcmp(pcKey, tmp->key) == 0) 
-            return TRUE;
+    for (; chunk != NULL; chunk = next) {
+        next = chunk->next;
+        SymTable_release(oSymTable, chunk);
     }
-    return FALSE;
 }
 
-void *SymTable_get(SymTable_T oSymTable, const char *pcKey) {
-    size_t hash;
-    struct Bind *tmp;
+/* Doubles the slots of the store of oSymTable, and the room for 
+   prefixes with them. Returns FALSE and leaves the store unchanged if 
+   insufficient memory is available, and TRUE otherwise. */
+static int SymTable_growPrefixes(SymTable_T oSymTable) {
+    struct Store *store;
+    struct Prefix **prefixes;
+    size_t *slots;
+    size_t uSlotCount;
+    size_t uSlot;
+    size_t i;
     assert(oSymTable != NULL);
-    assert(pcKey != NULL);
-    hash = SymTable_hash(pcKey, oSymTable->bucketCount);
+    assert(oSymTable->store != NULL);
+    store = oSymTable->store;
 
-    /*checks if the oSymTable contains the Key*/
-    if (SymTable_contains(oSymTable, pcKey) == 0) {
-        return NULL;
+    uSlotCount = store->slotCount == 0 ? MIN_PREFIX_SLOTS :
+        2 * store->slotCount;
+    slots = (size_t*)SymTable_alloc(oSymTable,
+        uSlotCount * sizeof(size_t));
+    prefixes = (struct Prefix**)SymTable_alloc(oSymTable,
+        uSlotCount / 2 * sizeof(struct Prefix*));
+    if (slots == NULL || prefixes == NULL) {
+        if (slots != NULL) {
+            SymTable_release(oSymTable, slots);
+        }
+        if (prefixes != NULL) {
+            SymTable_release(oSymTable, prefixes);
+        }
+        return FALSE;
     }
-
-    /*Searches for the value*/
-    for (tmp = oSymTable->buckets[hash]; tmp != NULL; tmp = tmp->next){
-        if (strcmp(pcKey, tmp->key) == 0) 
-            return (void*)tmp->value;
+    memset(slots, 0, uSlotCount * sizeof(size_t));
+    for (i = 0; i < store->prefixCount; i++) {
+        prefixes[i] = store->prefixes[i];
+        for (uSlot = prefixes[i]->hash & (uSlotCount - 1);
+            slots[uSlot] != 0; uSlot = (uSlot + 1) & (uSlotCount - 1)) {
+        }
+        slots[uSlot] = i + 1;
     }
-    return NULL;
+    if (store->slots != NULL) {
+        SymTable_release(oSymTable, store->slots);
+        SymTable_release(oSymTable, store->prefixes);
+    }
+    store->slots = slots;
+    store->slotCount = uSlotCount;
+    store->prefixes = prefixes;
+    return TRUE;
 }
 
-void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
-    size_t hash;
-    struct Bind *tmp;
-    struct Bind *before;
-    void *val;
+/* Sets *puNumber to the number of the prefix in the store of 
+   oSymTable that is the uLength characters at pcPrefix, first adding 
+   that prefix if it is missing and iAdd is TRUE. Returns FALSE if the 
+   prefix is not in the store, either because iAdd is FALSE or 
+   because insufficient memory is available, and TRUE otherwise. */
+static int SymTable_findPrefix(SymTable_T oSymTable,
+    const char *pcPrefix, size_t uLength, int iAdd, size_t *puNumber) {
+    struct Store *store;
+    struct Prefix *prefix;
+    size_t uHash;
+    size_t uSlot;
     assert(oSymTable != NULL);
-    assert(pcKey != NULL);
-    hash = SymTable_hash(pcKey, oSymTable->bucketCount);
-    val = NULL;
-    before = NULL;
+    assert(oSymTable->store != NULL);
+    assert(pcPrefix != NULL);
+    assert(puNumber != NULL);
+    store = oSymTable->store;
 
-    /* checks if oSymTable contains the key */
-    if (SymTable_contains(oSymTable, pcKey)) {
-        for (tmp = oSymTable->buckets[hash]; 
-        tmp != NULL; tmp = tmp->next){
-            if (strcmp(pcKey, tmp->key) == 0) 
-                break;
+    uHash = SymTable_sipHash(pcPrefix, uLength);
+    if (store->slotCount > 0) {
+        for (uSlot = uHash & (store->slotCount - 1);
+            store->slots[uSlot] != 0;
+            uSlot = (uSlot + 1) & (store->slotCount - 1)) {
+            prefix = store->prefixes[store->slots[uSlot] - 1];
+            if (prefix->hash == uHash && prefix->length == uLength &&
+                memcmp(prefix + 1, pcPrefix, uLength) == 0) {
+                *puNumber = store->slots[uSlot] - 1;
+                return TRUE;
             }
+        }
+    }
+    if (!iAdd) {
+        return FALSE;
+    }
 
-        /* skips to the bind */
-        for (tmp = oSymTable->buckets[hash]; 
-        tmp!= NULL && strcmp(tmp->key, pcKey); 
-            before = tmp, tmp = tmp->next);
+    /*the slots are kept at most half full*/
+    if (2 * (store->prefixCount + 1) > store->slotCount &&
+        !SymTable_growPrefixes(oSymTable)) {
+        return FALSE;
+    }
+    prefix = (struct Prefix*)SymTable_storeBytes(oSymTable,
+        sizeof(struct Prefix) + uLength, TRUE);
+    if (prefix == NULL) {
+        return FALSE;
+    }
+    prefix->hash = uHash;
+    prefix->length = uLength;
+    memcpy(prefix + 1, pcPrefix, uLength);
+    store->prefixBytes += sizeof(struct Prefix) + uLength;
+    for (uSlot = uHash & (store->slotCount - 1); store->slots[uSlot] != 0;
+        uSlot = (uSlot + 1) & (store->slotCount - 1)) {
+    }
+    store->prefixes[store->prefixCount] = prefix;
+    store->prefixCount++;
+    store->slots[uSlot] = store->prefixCount;
+    *puNumber = store->prefixCount - 1;
+    return TRUE;
+}
+
+/* Turns the key that is the *puLength characters at *ppcKey into the 
+   form that oSymTable stores it in, updating *ppcKey and *puLength. 
+   In a compact table a key that is split is encoded into acEncoded, 
+   which has room for ENCODED_SIZE characters; every other key is its 
+   own form. The prefix of a split key is added to the table's store 
+   if it is missing and iAdd is TRUE. Returns FALSE if the key cannot 
+   be in the table, because its prefix is missing, or if insufficient 
+   memory is available to add its prefix, and TRUE otherwise. */
+static int SymTable_encode(SymTable_T oSymTable, const char **ppcKey,
+    size_t *puLength, int iAdd, char *acEncoded) {
+    const char *pcKey;
+    size_t uPrefix;
+    size_t uNumber;
+    size_t uEncoded;
+    char c;
+    assert(oSymTable != NULL);
+    assert(ppcKey != NULL);
+    assert(puLength != NULL);
+    assert(acEncoded != NULL);
+    if (oSymTable->store == NULL || *puLength >= MAX_SPLIT_KEY) {
+        return TRUE;
+    }
+    pcKey = *ppcKey;
 
-        /*handles first bind case*/
-        if (before == NULL) {
-            val = (void*)tmp->value;
-            oSymTable->buckets[hash] = tmp->next;
+    /*the key splits after its last '.', ':' or '/', if it has one*/
+    for (uPrefix = *puLength; uPrefix > 0; uPrefix--) {
+        c = pcKey[uPrefix - 1];
+        if (c == '.' || c == ':' || c == '/') {
+            break;
         }
+    }
+    if (uPrefix == 0) {
+        return TRUE;
+    }
+    if (!SymTable_findPrefix(oSymTable, pcKey, uPrefix, iAdd,
+        &uNumber)) {
+        return FALSE;
+    }
 
-        /*handles other bind cases*/
-        else {
-            val = (void*)tmp->value;
-            before->next = tmp->next;
+    acEncoded[0] = '\0';
+    uEncoded = 1;
+    do {
+        acEncoded[uEncoded] = (char)(uNumber & 0x7F);
+        uNumber >>= 7;
+        if (uNumber != 0) {
+            acEncoded[uEncoded] = (char)(acEncoded[uEncoded] | 0x80);
         }
+        uEncoded++;
+    } while (uNumber != 0);
+    memcpy(acEncoded + uEncoded, pcKey + uPrefix, *puLength - uPrefix);
+    *ppcKey = acEncoded;
+    *puLength = uEncoded + *puLength - uPrefix;
+    return TRUE;
+}
 
-        /* keys the key, tmp, decrements counter, returns val*/
-        free(tmp->key);
-        free(tmp);
-        oSymTable->counter--;
-        return val;
+/* Returns the key of bind, a bind of oSymTable, as a string: the 
+   bind's own key, unless it is encoded, in which case it is decoded 
+   into acDecoded, which has room for MAX_SPLIT_KEY characters. */
+static const char *SymTable_decode(SymTable_T oSymTable,
+    const struct Bind *bind, char *acDecoded) {
+    const unsigned char *pucByte;
+    const struct Prefix *prefix;
+    size_t uNumber;
+    size_t uSuffix;
+    unsigned int uShift;
+    assert(oSymTable != NULL);
+    assert(bind != NULL);
+    assert(acDecoded != NULL);
+    if (!SymTable_isEncoded(bind->key, bind->keyLength)) {
+        return bind->key;
     }
-    return NULL;
+
+    pucByte = (const unsigned char*)bind->key + 1;
+    uNumber = 0;
+    uShift = 0;
+    do {
+        uNumber |= (size_t)(*pucByte & 0x7F) << uShift;
+        uShift += 7;
+    } while ((*pucByte++ & 0x80) != 0);
+    assert(uNumber < oSymTable->store->prefixCount);
+    prefix = oSymTable->store->prefixes[uNumber];
+    uSuffix = bind->keyLength - (size_t)((const char*)pucByte -
+        bind->key);
+    memcpy(acDecoded, prefix + 1, prefix->length);
+    memcpy(acDecoded + prefix->length, pucByte, uSuffix);
+    acDecoded[prefix->length + uSuffix] = '\0';
+    return acDecoded;
 }
 
-void SymTable_map(SymTable_T oSymTable, void (*pfApply)
-    (const char *pcKey, void *pvValue, void *pvExtra), 
-    const void *pvExtra) {
-    size_t i;
-    struct Bind *current;
+/*bytes in a transparent huge page; bucket arrays at least this large 
+are mapped on huge-page boundaries*/
+enum {HUGE_PAGE_SIZE = 2 * 1024 * 1024};
+
+/* Returns the number of bytes that a bucket array of uBucketCount 
+   buckets of oSymTable occupies. */
+static size_t SymTable_bucketBytes(SymTable_T oSymTable,
+    size_t uBucketCount) {
+    size_t uBytes = uBucketCount * oSymTable->bindSize;
+#if defined(MAP_ANONYMOUS) && defined(MADV_HUGEPAGE)
+    if (uBytes >= HUGE_PAGE_SIZE) {
+        uBytes = (uBytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE *
+            HUGE_PAGE_SIZE;
+    }
+#endif
+    return uBytes;
+}
+
+/* Returns a new bucket array of uBucketCount empty buckets for 
+   oSymTable, or NULL if insufficient memory is available. A large 
+   array spans many 4 KB pages, and a random get would miss the TLB 
+   as well as the cache, so where the system supports it such an 
+   array is mapped on huge-page boundaries and marked for transparent 
+   huge pages, unless oSymTable has an allocator of its own. Its 
+   pages land on the NUMA node of the thread that first writes them, 
+   which is the thread that fills the array. */
+static struct Bind *SymTable_allocBuckets(SymTable_T oSymTable,
+    size_t uBucketCount) {
+    struct Bind *buckets;
+#if defined(MAP_ANONYMOUS) && defined(MADV_HUGEPAGE)
+    size_t uBytes;
+    size_t uHead;
+    char *pcMap;
+#endif
     assert(oSymTable != NULL);
-    assert(pfApply != NULL);
-    for (i = 0; i < oSymTable->bucketCount; i++) {
-        current = oSymTable->buckets[i];
-        while (current != NULL) {
-            (*pfApply)((void*)current->key, 
-                (void*) current->value, (void*) pvExtra);
-            current = current->next;
-        }   
+
+    if (oSymTable->pfAlloc != SymTable_defaultAlloc) {
+        buckets = (struct Bind*)SymTable_alloc(oSymTable,
+            uBucketCount * oSymTable->bindSize);
+        if (buckets != NULL) {
+            memset(buckets, 0, uBucketCount * oSymTable->bindSize);
+        }
+        return buckets;
     }
-}
\ No newline at end of file
+
+#if defined(MAP_ANONYMOUS) && defined(MADV_HUGEPAGE)
+    uBytes = SymTable_bucketBytes(oSymTable, uBucketCount);
+    if (uBytes >= HUGE_PAGE_SIZE) {
+        /*maps an extra huge page so that an aligned run fits, then
+        unmaps whatever lies outside that run*/
+        pcMap = mmap(NULL, uBytes + HUGE_PAGE_SIZE,
+            PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (pcMap == MAP_FAILED) {
+            return NULL;
+        }
+        uHead = (HUGE_PAGE_SIZE - (size_t)pcMap % HUGE_PAGE_SIZE) %
+            HUGE_PAGE_SIZE;
+        if (uHead > 0) {
+            (void)munmap(pcMap, uHead);
+        }
+        (void)munmap(pcMap + uHead + uBytes, HUGE_PAGE_SIZE - uHead);
+
+        /*anonymous pages are already zero, that is, empty buckets;
+        without huge pages the array still works, only slower*/
+        (void)madvise(pcMap + uHead, uBytes, MADV_HUGEPAGE);
+        return (struct Bind*)(void*)(pcMap + uHead);
+    }
+#endif
+    return (struct Bind*)calloc(uBucketCount, oSymTable->bindSize);
+}
+
+/* Frees the bucket array buckets of uBucketCount buckets, which 
+   SymTable_allocBuckets returned for oSymTable. */
+static void SymTable_freeBuckets(SymTable_T oSymTable,
+    struct Bind *buckets, size_t uBucketCount) {
+    assert(oSymTable != NULL);
+    if (buckets == NULL) {
+        return;
+    }
+#if defined(MAP_ANONYMOUS) && defined(MADV_HUGEPAGE)
+    if (oSymTable->pfAlloc == SymTable_defaultAlloc &&
+        SymTable_bucketBytes(oSymTable, uBucketCount) >= HUGE_PAGE_SIZE) {
+        (void)munmap(buckets, SymTable_bucketBytes(oSymTable,
+            uBucketCount));
+        return;
+    }
+#endif
+    (void)uBucketCount;
+    SymTable_release(oSymTable, buckets);
+}
+
+/* Returns bucket uBucket of the bucket array buckets of oSymTable. */
+static struct Bind *SymTable_bucket(SymTable_T oSymTable,
+    struct Bind *buckets, size_t uBucket) {
+    assert(oSymTable != NULL);
+    assert(buckets != NULL);
+    return (struct Bind*)(void*)
+        ((char*)buckets + uBucket * oSymTable->bindSize);
+}
+
+/* Returns the bucket that the key with hash code uHash belongs in 
+   among uBucketCount buckets of oSymTable. The table's seed is mixed 
+   in first, so that even keys whose codes were somehow learnt from 
+   another table do not pile into one bucket of this one. */
+static size_t SymTable_index(SymTable_T oSymTable, size_t uHash,
+    size_t uBucketCount) {
+    assert(oSymTable != NULL);
+    assert(uBucketCount > 0);
+    return (uHash ^ oSymTable->seed) % uBucketCount;
+}
+
+/* Returns the buckets of segment. */
+static struct Bind *SymTable_segmentBuckets(struct Segment *segment) {
+    assert(segment != NULL);
+    return (struct Bind*)(void*)(segment + 1);
+}
+
+/* Returns bucket uBucket of oSymTable, which lives in the table's 
+   copy of its segment if the table has one and in the bucket array 
+   otherwise. */
+static struct Bind *SymTable_slot(SymTable_T oSymTable, size_t uBucket)
+{
+    struct Segment *segment;
+    assert(oSymTable != NULL);
+    assert(uBucket < oSymTable->bucketCount);
+    if (oSymTable->segments != NULL) {
+        segment = oSymTable->segments[uBucket >> SEGMENT_BITS];
+        if (segment != NULL) {
+            return SymTable_bucket(oSymTable,
+                SymTable_segmentBuckets(segment),
+                uBucket & (SEGMENT_SIZE - 1));
+        }
+    }
+    return SymTable_bucket(oSymTable, oSymTable->buckets, uBucket);
+}
+
+/* Returns the first bind of bucket uBucket of oSymTable, or NULL if 
+   the bucket holds no binds. */
+static struct Bind *SymTable_chain(SymTable_T oSymTable, size_t uBucket)
+{
+    struct Bind *bucket;
+    assert(oSymTable != NULL);
+    assert(uBucket < oSymTable->bucketCount);
+    bucket = SymTable_slot(oSymTable, uBucket);
+    if (bucket->key == NULL) {
+        return NULL;
+    }
+    return bucket;
+}
+
+/* Stores pvValue as the value of bind of oSymTable. An inline table 
+   copies the value into the storage after the bind, or zeroes that 
+   storage if pvValue is NULL. */
+static void SymTable_setValue(SymTable_T oSymTable, struct Bind *bind,
+    const void *pvValue) {
+    assert(oSymTable != NULL);
+    assert(bind != NULL);
+    if (oSymTable->valueSize == 0) {
+        bind->value = pvValue;
+        return;
+    }
+    bind->value = bind + 1;
+    if (pvValue == NULL) {
+        memset(bind + 1, 0, oSymTable->valueSize);
+    }
+    else {
+        memcpy(bind + 1, pvValue, oSymTable->valueSize);
+    }
+}
+
+/* Moves the bind at source of oSymTable, with its value, to 
+   destination, which it must not overlap, and unlinks it from the 
+   next bind. */
+static void SymTable_moveBind(SymTable_T oSymTable,
+    struct Bind *destination, const struct Bind *source) {
+    assert(oSymTable != NULL);
+    assert(destination != NULL);
+    assert(source != NULL);
+    memcpy(destination, source, oSymTable->bindSize);
+    if (oSymTable->valueSize != 0) {
+        destination->value = destination + 1;
+    }
+    destination->next = NULL;
+}
+
+/* Returns the value of bind of oSymTable as a replace or remove 
+   hands it back: the pointer itself, or in an inline table a copy 
+   in the table's old value. */
+static void *SymTable_saveValue(SymTable_T oSymTable,
+    const struct Bind *bind) {
+    assert(oSymTable != NULL);
+    assert(bind != NULL);
+    if (oSymTable->valueSize == 0) {
+        return (void*)bind->value;
+    }
+    memcpy(oSymTable->oldValue, bind->value, oSymTable->valueSize);
+    return oSymTable->oldValue;
+}
+
+/* Returns a negative number, 0, or a positive number as bind sorts 
+   before, with, or after the key that is the uLength characters at 
+   pcKey with hash code uHash, in the order that an Index keeps. */
+static int SymTable_compareKey(const struct Bind *bind,
+    const char *pcKey, size_t uLength, size_t uHash) {
+    assert(bind != NULL);
+    assert(pcKey != NULL);
+    if (bind->hash != uHash) {
+        return bind->hash < uHash ? -1 : 1;
+    }
+    if (bind->keyLength != uLength) {
+        return bind->keyLength < uLength ? -1 : 1;
+    }
+    return memcmp(bind->key, pcKey, uLength);
+}
+
+/* Compares the binds that the struct Bind pointers at pvFirst and 
+   pvSecond point to, in the order that an Index keeps, for qsort. */
+static int SymTable_compareBinds(const void *pvFirst,
+    const void *pvSecond) {
+    const struct Bind *second = *(struct Bind *const *)pvSecond;
+    return SymTable_compareKey(*(struct Bind *const *)pvFirst,
+        second->key, second->keyLength, second->hash);
+}
+
+/* Returns the position among binds[1] to binds[count - 1] of index 
+   of the first bind that does not sort before the key that is the 
+   uLength characters at pcKey with hash code uHash, or count if 
+   there is none. */
+static size_t SymTable_search(const struct Index *index,
+    const char *pcKey, size_t uLength, size_t uHash) {
+    size_t uLow = 1;
+    size_t uHigh;
+    size_t uMiddle;
+    assert(index != NULL);
+    uHigh = index->count;
+    while (uLow < uHigh) {
+        uMiddle = uLow + (uHigh - uLow) / 2;
+        if (SymTable_compareKey(index->binds[uMiddle], pcKey, uLength,
+            uHash) < 0) {
+            uLow = uMiddle + 1;
+        }
+        else {
+            uHigh = uMiddle;
+        }
+    }
+    return uLow;
+}
+
+/* Frees the index of bucket uBucket of oSymTable, if it has one, and 
+   the table's array of indexes once no bucket has an index. The 
+   chain stays as it is. */
+static void SymTable_dropIndex(SymTable_T oSymTable, size_t uBucket) {
+    struct Index *index;
+    assert(oSymTable != NULL);
+    if (oSymTable->indexes == NULL) {
+        return;
+    }
+    index = oSymTable->indexes[uBucket];
+    if (index == NULL) {
+        return;
+    }
+    SymTable_release(oSymTable, index->binds);
+    SymTable_release(oSymTable, index);
+    oSymTable->indexes[uBucket] = NULL;
+    oSymTable->indexCount--;
+    if (oSymTable->indexCount == 0) {
+        SymTable_release(oSymTable, oSymTable->indexes);
+        oSymTable->indexes = NULL;
+    }
+}
+
+/* Frees every index of oSymTable, whose array of indexes has 
+   uBucketCount entries. */
+static void SymTable_dropIndexes(SymTable_T oSymTable,
+    size_t uBucketCount) {
+    size_t i;
+    assert(oSymTable != NULL);
+    for (i = 0; oSymTable->indexes != NULL && i < uBucketCount; i++) {
+        SymTable_dropIndex(oSymTable, i);
+    }
+}
+
+/* Gives bucket uBucket of oSymTable an index if its chain is longer 
+   than INDEX_THRESHOLD binds and has none yet, sorting the chain to 
+   match. An index only speeds up searches, so if there is not enough 
+   memory for one the chain is left as it is. */
+static void SymTable_buildIndex(SymTable_T oSymTable, size_t uBucket) {
+    struct Index *index;
+    struct Bind *bind;
+    size_t uCount;
+    size_t i;
+    assert(oSymTable != NULL);
+
+    if (oSymTable->indexes != NULL &&
+        oSymTable->indexes[uBucket] != NULL) {
+        return;
+    }
+    uCount = 0;
+    for (bind = SymTable_chain(oSymTable, uBucket);
+        bind != NULL && uCount <= INDEX_THRESHOLD; bind = bind->next) {
+        uCount++;
+    }
+    if (uCount <= INDEX_THRESHOLD) {
+        return;
+    }
+    SymTable_profileCount(PROFILE_INDEX);
+    for (; bind != NULL; bind = bind->next) {
+        uCount++;
+    }
+
+    if (oSymTable->indexes == NULL) {
+        oSymTable->indexes = (struct Index**)SymTable_alloc(oSymTable,
+            oSymTable->bucketCount * sizeof(struct Index*));
+        if (oSymTable->indexes == NULL) {
+            return;
+        }
+        memset(oSymTable->indexes, 0,
+            oSymTable->bucketCount * sizeof(struct Index*));
+    }
+    index = (struct Index*)SymTable_alloc(oSymTable,
+        sizeof(struct Index));
+    if (index != NULL) {
+        index->capacity = 2 * uCount;
+        index->binds = (struct Bind**)SymTable_alloc(oSymTable,
+            index->capacity * sizeof(struct Bind*));
+        if (index->binds == NULL) {
+            SymTable_release(oSymTable, index);
+            index = NULL;
+        }
+    }
+    if (index == NULL) {
+        if (oSymTable->indexCount == 0) {
+            SymTable_release(oSymTable, oSymTable->indexes);
+            oSymTable->indexes = NULL;
+        }
+        return;
+    }
+
+    /*sorts every bind but the one in the array, and relinks them*/
+    index->count = uCount;
+    i = 0;
+    for (bind = SymTable_chain(oSymTable, uBucket); bind != NULL;
+        bind = bind->next) {
+        index->binds[i++] = bind;
+    }
+    qsort(index->binds + 1, uCount - 1, sizeof(struct Bind*),
+        SymTable_compareBinds);
+    for (i = 0; i + 1 < uCount; i++) {
+        index->binds[i]->next = index->binds[i + 1];
+    }
+    index->binds[uCount - 1]->next = NULL;
+
+    oSymTable->indexes[uBucket] = index;
+    oSymTable->indexCount++;
+}
+
+/* Gives every bucket of oSymTable whose chain is too long an index. */
+static void SymTable_buildIndexes(SymTable_T oSymTable) {
+    size_t i;
+    assert(oSymTable != NULL);
+    for (i = 0; i < oSymTable->bucketCount; i++) {
+        SymTable_buildIndex(oSymTable, i);
+    }
+}
+
+/* Files bind, which SymTable_link just put after the first bind of 
+   bucket uBucket of oSymTable, into the bucket's index: in order in 
+   the index and the chain if the bucket has an index, or by giving 
+   the bucket an index if its chain has grown too long. */
+static void SymTable_indexBind(SymTable_T oSymTable, size_t uBucket,
+    struct Bind *bind) {
+    struct Index *index;
+    struct Bind **binds;
+    struct Bind *bucket;
+    size_t uPosition;
+    assert(oSymTable != NULL);
+    assert(bind != NULL);
+
+    if (oSymTable->indexes == NULL ||
+        oSymTable->indexes[uBucket] == NULL) {
+        SymTable_buildIndex(oSymTable, uBucket);
+        return;
+    }
+    index = oSymTable->indexes[uBucket];
+    if (index->count == index->capacity) {
+        binds = (struct Bind**)SymTable_alloc(oSymTable,
+            2 * index->capacity * sizeof(struct Bind*));
+        if (binds == NULL) {
+            /*the chain is still whole, only no longer sorted*/
+            SymTable_dropIndex(oSymTable, uBucket);
+            return;
+        }
+        memcpy(binds, index->binds, index->count * sizeof(struct Bind*));
+        SymTable_release(oSymTable, index->binds);
+        index->binds = binds;
+        index->capacity *= 2;
+    }
+
+    /*unlinks the bind from the front of the chain and links it back
+    in at its place in the order*/
+    bucket = index->binds[0];
+    assert(bucket->next == bind);
+    bucket->next = bind->next;
+    uPosition = SymTable_search(index, bind->key, bind->keyLength,
+        bind->hash);
+    memmove(index->binds + uPosition + 1, index->binds + uPosition,
+        (index->count - uPosition) * sizeof(struct Bind*));
+    index->binds[uPosition] = bind;
+    index->count++;
+    bind->next = uPosition + 1 < index->count ?
+        index->binds[uPosition + 1] : NULL;
+    index->binds[uPosition - 1]->next = bind;
+}
+
+/* Takes the bind at uPosition out of index, the index of bucket 
+   uBucket of oSymTable, after the bind has been unlinked from the 
+   chain, and drops the index if the chain has become short. */
+static void SymTable_unindexBind(SymTable_T oSymTable, size_t uBucket,
+    struct Index *index, size_t uPosition) {
+    assert(oSymTable != NULL);
+    assert(index != NULL);
+    assert(uPosition > 0 && uPosition < index->count);
+    memmove(index->binds + uPosition, index->binds + uPosition + 1,
+        (index->count - uPosition - 1) * sizeof(struct Bind*));
+    index->count--;
+    if (index->count < UNINDEX_THRESHOLD) {
+        SymTable_dropIndex(oSymTable, uBucket);
+    }
+}
+
+/* Frees the keys of the uBucketCount buckets at buckets of oSymTable 
+   and every bind of their chains outside the buckets themselves. */
+static void SymTable_freeChains(SymTable_T oSymTable,
+    struct Bind *buckets, size_t uBucketCount) {
+    size_t i;
+    struct Bind *bind;
+    struct Bind *next;
+    assert(oSymTable != NULL);
+    for (i = 0; i < uBucketCount; i++) {
+        bind = SymTable_bucket(oSymTable, buckets, i);
+        if (bind->key == NULL) {
+            continue;
+        }
+        SymTable_releaseKey(oSymTable, bind->key);
+        for (bind = bind->next; bind != NULL; bind = next) {
+            next = bind->next;
+            SymTable_releaseKey(oSymTable, bind->key);
+            SymTable_release(oSymTable, bind);
+        }
+    }
+}
+
+/* Returns the number of buckets of oSymTable in segment uSegment. */
+static size_t SymTable_segmentSize(SymTable_T oSymTable,
+    size_t uSegment) {
+    size_t uFirst;
+    assert(oSymTable != NULL);
+    uFirst = uSegment << SEGMENT_BITS;
+    assert(uFirst < oSymTable->bucketCount);
+    if (oSymTable->bucketCount - uFirst < SEGMENT_SIZE) {
+        return oSymTable->bucketCount - uFirst;
+    }
+    return SEGMENT_SIZE;
+}
+
+/* Drops segment, which holds uBucketCount buckets, from a table of 
+   oSymTable's family, and frees it with its chains & keys if no other 
+   table reads it. */
+static void SymTable_releaseSegment(SymTable_T oSymTable,
+    struct Segment *segment, size_t uBucketCount) {
+    assert(oSymTable != NULL);
+    assert(segment != NULL);
+    assert(segment->refCount > 0);
+    segment->refCount--;
+    if (segment->refCount == 0) {
+        SymTable_freeChains(oSymTable, SymTable_segmentBuckets(segment),
+            uBucketCount);
+        SymTable_release(oSymTable, segment);
+    }
+}
+
+/* Returns a new segment of oSymTable that holds a copy of the 
+   uBucketCount buckets at source, with copies of their chains and 
+   keys in the same order, or NULL if insufficient memory is 
+   available. Keys in the pool or store are shared rather than 
+   copied. */
+static struct Segment *SymTable_copySegment(SymTable_T oSymTable,
+    struct Bind *source, size_t uBucketCount) {
+    struct Segment *segment;
+    struct Bind *bucket;
+    struct Bind *from;
+    struct Bind *to;
+    struct Bind *last;
+    char *copy;
+    size_t i;
+    assert(oSymTable != NULL);
+    assert(source != NULL);
+
+    segment = (struct Segment*)SymTable_alloc(oSymTable,
+        sizeof(struct Segment) + uBucketCount * oSymTable->bindSize);
+    if (segment == NULL) {
+        return NULL;
+    }
+    segment->refCount = 1;
+    memset(SymTable_segmentBuckets(segment), 0,
+        uBucketCount * oSymTable->bindSize);
+
+    /*every bind is complete before it is linked in, so that a copy 
+    cut short by a failed allocation can be freed like any other*/
+    for (i = 0; i < uBucketCount; i++) {
+        bucket = SymTable_bucket(oSymTable,
+            SymTable_segmentBuckets(segment), i);
+        last = NULL;
+        for (from = SymTable_bucket(oSymTable, source, i);
+            from != NULL && from->key != NULL; from = from->next) {
+            copy = oSymTable->store != NULL ||
+                SymTable_isPooled(oSymTable, from->key) ? from->key :
+                SymTable_alloc(oSymTable, from->keyLength + 1);
+            to = last == NULL ? bucket : (struct Bind*)SymTable_alloc
+                (oSymTable, oSymTable->bindSize);
+            if (copy == NULL || to == NULL) {
+                if (copy != NULL) {
+                    SymTable_releaseKey(oSymTable, copy);
+                }
+                if (to != NULL && to != bucket) {
+                    SymTable_release(oSymTable, to);
+                }
+                SymTable_releaseSegment(oSymTable, segment,
+                    uBucketCount);
+                return NULL;
+            }
+            if (copy != from->key) {
+                memcpy(copy, from->key, from->keyLength + 1);
+            }
+            SymTable_moveBind(oSymTable, to, from);
+            to->key = copy;
+            if (last != NULL) {
+                last->next = to;
+            }
+            last = to;
+        }
+    }
+    return segment;
+}
+
+/* Returns bucket uBucket of oSymTable ready to be changed, or NULL if 
+   insufficient memory is available. While the bucket's segment is 
+   shared with a clone, the table first takes a copy of its own, 
+   which gets indexes of its own as well. The binds that the caller 
+   found before this call may then belong to the other tables, so it 
+   must find them again. */
+static struct Bind *SymTable_own(SymTable_T oSymTable, size_t uBucket) {
+    struct Segment *segment;
+    struct Segment *copy;
+    struct Bind *source;
+    size_t uSegment;
+    size_t uSegmentCount;
+    size_t uSize;
+    size_t i;
+    assert(oSymTable != NULL);
+    assert(uBucket < oSymTable->bucketCount);
+
+    if (oSymTable->shares == NULL) {
+        return SymTable_bucket(oSymTable, oSymTable->buckets, uBucket);
+    }
+    uSegment = uBucket >> SEGMENT_BITS;
+    segment = oSymTable->segments == NULL ? NULL :
+        oSymTable->segments[uSegment];
+    if (segment != NULL && segment->refCount == 1) {
+        return SymTable_slot(oSymTable, uBucket);
+    }
+    if (segment == NULL && *oSymTable->shares == 1) {
+        return SymTable_bucket(oSymTable, oSymTable->buckets, uBucket);
+    }
+
+    if (oSymTable->segments == NULL) {
+        uSegmentCount = (oSymTable->bucketCount + SEGMENT_SIZE - 1) >>
+            SEGMENT_BITS;
+        oSymTable->segments = (struct Segment**)SymTable_alloc
+            (oSymTable, uSegmentCount * sizeof(struct Segment*));
+        if (oSymTable->segments == NULL) {
+            return NULL;
+        }
+        memset(oSymTable->segments, 0,
+            uSegmentCount * sizeof(struct Segment*));
+    }
+    uSize = SymTable_segmentSize(oSymTable, uSegment);
+    source = segment != NULL ? SymTable_segmentBuckets(segment) :
+        SymTable_bucket(oSymTable, oSymTable->buckets,
+        uSegment << SEGMENT_BITS);
+    copy = SymTable_copySegment(oSymTable, source, uSize);
+    if (copy == NULL) {
+        return NULL;
+    }
+    if (segment != NULL) {
+        segment->refCount--;
+    }
+    oSymTable->segments[uSegment] = copy;
+
+    /*the indexes of the segment's buckets point into the old chains*/
+    for (i = uSegment << SEGMENT_BITS;
+        i < (uSegment << SEGMENT_BITS) + uSize; i++) {
+        if (oSymTable->indexes != NULL &&
+            oSymTable->indexes[i] != NULL) {
+            SymTable_dropIndex(oSymTable, i);
+            SymTable_buildIndex(oSymTable, i);
+        }
+    }
+    return SymTable_slot(oSymTable, uBucket);
+}
+
+/* Returns the bits of the filter of oSymTable that stand for the key 
+   with hash code uHash: its block in the high half, and its probes 
+   below that. */
+static uint64_t SymTable_filterHash(SymTable_T oSymTable, size_t uHash)
+{
+    assert(oSymTable != NULL);
+    /*the multiply spreads a 32-bit hash code across all 64 bits*/
+    return (uint64_t)(uHash ^ oSymTable->seed) * 0xFF51AFD7ED558CCDULL;
+}
+
+/* Returns the block of filter for the key whose filter bits are 
+   uFilterHash. */
+static uint64_t *SymTable_filterBlock(struct Filter *filter,
+    uint64_t uFilterHash) {
+    assert(filter != NULL);
+    return filter->words + FILTER_BLOCK_WORDS * (size_t)
+        (((uFilterHash >> 32) * filter->blockCount) >> 32);
+}
+
+/* Sets the bits of filter for the key whose filter bits are 
+   uFilterHash. */
+static void SymTable_filterSet(struct Filter *filter,
+    uint64_t uFilterHash) {
+    uint64_t *puBlock;
+    unsigned int uBit;
+    int i;
+    assert(filter != NULL);
+    puBlock = SymTable_filterBlock(filter, uFilterHash);
+    for (i = 0; i < FILTER_PROBES; i++) {
+        uBit = (unsigned int)(uFilterHash >> (9 * i)) & 511;
+        puBlock[uBit >> 6] |= (uint64_t)1 << (uBit & 63);
+    }
+}
+
+/* Returns FALSE if filter shows that there is no key whose filter 
+   bits are uFilterHash, and TRUE if there may be one. */
+static int SymTable_filterTest(struct Filter *filter,
+    uint64_t uFilterHash) {
+    const uint64_t *puBlock;
+    unsigned int uBit;
+    int i;
+    assert(filter != NULL);
+    puBlock = SymTable_filterBlock(filter, uFilterHash);
+    for (i = 0; i < FILTER_PROBES; i++) {
+        uBit = (unsigned int)(uFilterHash >> (9 * i)) & 511;
+        if ((puBlock[uBit >> 6] & ((uint64_t)1 << (uBit & 63))) == 0) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/* Drops the filter of oSymTable, if it has one, and frees it unless a 
+   clone reads it. */
+static void SymTable_dropFilter(SymTable_T oSymTable) {
+    assert(oSymTable != NULL);
+    if (oSymTable->filter == NULL) {
+        return;
+    }
+    oSymTable->filter->refCount--;
+    if (oSymTable->filter->refCount == 0) {
+        SymTable_release(oSymTable, oSymTable->filter);
+    }
+    oSymTable->filter = NULL;
+}
+
+/* Gives oSymTable a new filter of its keys, sized for its bucket 
+   array, in place of the one it has. A filter only speeds up 
+   lookups, so if there is not enough memory for it the table goes 
+   without. */
+static void SymTable_buildFilter(SymTable_T oSymTable) {
+    struct Filter *filter;
+    struct Bind *bind;
+    size_t uBlockCount;
+    size_t uBytes;
+    size_t i;
+    assert(oSymTable != NULL);
+    SymTable_dropFilter(oSymTable);
+    if (oSymTable->bucketCount == 0) {
+        return;
+    }
+
+    uBlockCount = (oSymTable->bucketCount * FILTER_BITS_PER_BUCKET +
+        FILTER_BLOCK_WORDS * 64 - 1) / (FILTER_BLOCK_WORDS * 64);
+    uBytes = uBlockCount * FILTER_BLOCK_WORDS * sizeof(uint64_t);
+    filter = (struct Filter*)SymTable_alloc(oSymTable,
+        sizeof(struct Filter) + uBytes);
+    if (filter == NULL) {
+        return;
+    }
+    filter->refCount = 1;
+    filter->blockCount = uBlockCount;
+    filter->staleCount = 0;
+    memset(filter->words, 0, uBytes);
+    for (i = 0; i < oSymTable->bucketCount; i++) {
+        for (bind = SymTable_chain(oSymTable, i); bind != NULL;
+            bind = bind->next) {
+            SymTable_filterSet(filter,
+                SymTable_filterHash(oSymTable, bind->hash));
+        }
+    }
+    oSymTable->filter = filter;
+}
+
+/* Sets the bits of a key with hash code uHash that was just added to 
+   oSymTable in the table's filter, which the table first copies if a 
+   clone reads it too. */
+static void SymTable_filterAdd(SymTable_T oSymTable, size_t uHash) {
+    struct Filter *copy;
+    size_t uSize;
+    assert(oSymTable != NULL);
+    assert(oSymTable->filter != NULL);
+    if (oSymTable->filter->refCount > 1) {
+        uSize = sizeof(struct Filter) + oSymTable->filter->blockCount *
+            FILTER_BLOCK_WORDS * sizeof(uint64_t);
+        copy = (struct Filter*)SymTable_alloc(oSymTable, uSize);
+        if (copy == NULL) {
+            SymTable_dropFilter(oSymTable);
+            return;
+        }
+        memcpy(copy, oSymTable->filter, uSize);
+        copy->refCount = 1;
+        oSymTable->filter->refCount--;
+        oSymTable->filter = copy;
+    }
+    SymTable_filterSet(oSymTable->filter,
+        SymTable_filterHash(oSymTable, uHash));
+}
+
+/* Notes that a key was just removed from oSymTable, whose filter is 
+   built again once it holds more removed keys than live ones, and at 
+   least a quarter as many as there are buckets, so that the cost of 
+   building it is spread over the removals. */
+static void SymTable_filterRemove(SymTable_T oSymTable) {
+    assert(oSymTable != NULL);
+    assert(oSymTable->filter != NULL);
+    oSymTable->filter->staleCount++;
+    if (oSymTable->filter->staleCount > oSymTable->counter &&
+        4 * oSymTable->filter->staleCount > oSymTable->bucketCount) {
+        SymTable_buildFilter(oSymTable);
+    }
+}
+
+/* Returns the bind of oSymTable whose key is the uLength characters 
+   at pcKey, where uHash is the hash code of that key, or NULL if 
+   there is no such bind. */
+static struct Bind *SymTable_find(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength, size_t uHash) {
+    struct Bind *tmp;
+    struct Index *index;
+    size_t uBucket;
+    size_t uPosition;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    /*an empty table may not have any buckets yet*/
+    if (oSymTable->bucketCount == 0) {
+        return NULL;
+    }
+
+    /*most keys that are not there are turned away by the filter*/
+    if (oSymTable->filter != NULL && !SymTable_filterTest(
+        oSymTable->filter, SymTable_filterHash(oSymTable, uHash))) {
+        return NULL;
+    }
+    uBucket = SymTable_index(oSymTable, uHash, oSymTable->bucketCount);
+
+    /*a long chain is searched through its index*/
+    if (oSymTable->indexes != NULL &&
+        oSymTable->indexes[uBucket] != NULL) {
+        index = oSymTable->indexes[uBucket];
+        if (SymTable_compareKey(index->binds[0], pcKey, uLength,
+            uHash) == 0) {
+            return index->binds[0];
+        }
+        uPosition = SymTable_search(index, pcKey, uLength, uHash);
+        if (uPosition < index->count && SymTable_compareKey(
+            index->binds[uPosition], pcKey, uLength, uHash) == 0) {
+            return index->binds[uPosition];
+        }
+        return NULL;
+    }
+
+    /*searches the chain, comparing characters only on equal hashes
+    and lengths*/
+    for (tmp = SymTable_chain(oSymTable, uBucket); tmp != NULL;
+        tmp = tmp->next) {
+        if (tmp->hash == uHash && tmp->keyLength == uLength &&
+            memcmp(pcKey, tmp->key, uLength) == 0) 
+            return tmp;
+    }
+    return NULL;
+}
+
+/* Returns bind, the bind of oSymTable whose key is the uLength 
+   characters at pcKey with hash code uHash, or the table's own copy 
+   of it if it was shared with a clone, ready to be changed. Returns 
+   NULL if insufficient memory is available. */
+static struct Bind *SymTable_ownBind(SymTable_T oSymTable,
+    struct Bind *bind, const char *pcKey, size_t uLength,
+    size_t uHash) {
+    assert(oSymTable != NULL);
+    assert(bind != NULL);
+    if (oSymTable->shares == NULL) {
+        return bind;
+    }
+    if (SymTable_own(oSymTable, SymTable_index(oSymTable, uHash,
+        oSymTable->bucketCount)) == NULL) {
+        return NULL;
+    }
+    return SymTable_find(oSymTable, pcKey, uLength, uHash);
+}
+
+/* Stores the binding whose key is key, with length uLength and hash 
+   code uHash, and whose value is pvValue in bucket of oSymTable, in 
+   the array if the bucket is empty and otherwise in spare, or in a 
+   new bind if spare is NULL, after the first one. The bucket takes 
+   over key. Returns the bind that holds the binding, or NULL if 
+   insufficient memory is available. */
+static struct Bind *SymTable_link(SymTable_T oSymTable,
+    struct Bind *bucket, char *key, size_t uLength, size_t uHash,
+    const void *pvValue, struct Bind *spare) {
+    struct Bind *newBind;
+    assert(bucket != NULL);
+    assert(key != NULL);
+
+    if (bucket->key == NULL) {
+        newBind = bucket;
+    }
+    else if (spare != NULL) {
+        newBind = spare;
+        newBind->next = bucket->next;
+        bucket->next = newBind;
+    }
+    else {
+        newBind = (struct Bind*)SymTable_alloc(oSymTable,
+            oSymTable->bindSize);
+        if (newBind == NULL) {
+            return NULL;
+        }
+        newBind->next = bucket->next;
+        bucket->next = newBind;
+    }
+    newBind->key = key;
+    newBind->keyLength = uLength;
+    newBind->hash = uHash;
+    SymTable_setValue(oSymTable, newBind, pvValue);
+    return newBind;
+}
+
+/* Frees the bucket array of oSymTable and the table's copies of its 
+   segments, after every bind in them has been moved elsewhere. The 
+   array is only freed, with whatever chains are left in the segments 
+   that the table copied, once no clone shares it. */
+static void SymTable_unshare(SymTable_T oSymTable) {
+    size_t uSegment;
+    size_t uSize;
+    int iOwnsArray;
+    assert(oSymTable != NULL);
+    iOwnsArray = oSymTable->shares == NULL || *oSymTable->shares == 1;
+    if (oSymTable->segments != NULL) {
+        for (uSegment = 0; uSegment << SEGMENT_BITS <
+            oSymTable->bucketCount; uSegment++) {
+            if (oSymTable->segments[uSegment] == NULL) {
+                continue;
+            }
+            uSize = SymTable_segmentSize(oSymTable, uSegment);
+            assert(oSymTable->segments[uSegment]->refCount == 1);
+            if (iOwnsArray) {
+                SymTable_freeChains(oSymTable, SymTable_bucket(oSymTable,
+                    oSymTable->buckets, uSegment << SEGMENT_BITS), uSize);
+            }
+            SymTable_release(oSymTable, oSymTable->segments[uSegment]);
+        }
+        SymTable_release(oSymTable, oSymTable->segments);
+        oSymTable->segments = NULL;
+    }
+    if (iOwnsArray) {
+        SymTable_freeBuckets(oSymTable, oSymTable->buckets,
+            oSymTable->bucketCount);
+    }
+    if (oSymTable->shares != NULL) {
+        (*oSymTable->shares)--;
+        if (*oSymTable->shares == 0) {
+            SymTable_release(oSymTable, oSymTable->shares);
+        }
+        oSymTable->shares = NULL;
+    }
+}
+
+/* Expands SymTable_T oSymTable by creating a new bucket array of 
+   the next size in auBucketCounts, or of the first size that is at 
+   least uCount if that is larger, and rehashes all the keys. If 
+   oSymTable has no bucket array yet, the smallest one is allocated. 
+   Leaves oSymTable unchanged if it is already at the largest size 
+   or if insufficient memory is available. */
+static void SymTable_expand(SymTable_T oSymTable, size_t uCount) {
+    /*last array index in auBucketCounts[]*/
+    size_t i;
+    size_t j;
+    size_t uOccupied;
+    size_t uOverflow;
+    size_t uIndexed;
+    struct Bind *tmp;
+    struct Bind *bucket;
+    struct Bind *curr;
+    struct Bind *next;
+    /*binds that no bucket uses, to hold collisions in the new array*/
+    struct Bind *spare;
+    /*stores the # of buckets at a given time*/
+    size_t numBucketCounts;
+    assert(oSymTable != NULL);
+    i = 0;
+    numBucketCounts = 
+    sizeof(auBucketCounts)/sizeof(auBucketCounts[0]);
+
+    /*increments i to the new index*/
+    while (i < numBucketCounts - 1 && 
+        (auBucketCounts[i] <= oSymTable->bucketCount ||
+        auBucketCounts[i] < uCount)) {
+            i++;
+    }
+
+    /* handles the case in which auBucketCounts is at a max*/
+    if (auBucketCounts[i] <= oSymTable->bucketCount) {
+        return;
+    }
+
+    /*the rehash moves binds around, so a table that shares buckets 
+    with a clone first takes its own copy of every shared segment*/
+    if (oSymTable->shares != NULL) {
+        for (j = 0; j < oSymTable->bucketCount; j += SEGMENT_SIZE) {
+            if (SymTable_own(oSymTable, j) == NULL) {
+                return;
+            }
+        }
+    }
+
+    /*allocates the buckets based on auBucketCounts*/
+    tmp = SymTable_allocBuckets(oSymTable, auBucketCounts[i]);
+    if (tmp == NULL) {
+        return;
+    }    
+
+    /*counts the new buckets that will be used, marking them through
+    their hash field, and the binds outside the old array. Every
+    bind beyond the first of a new bucket needs a separate bind,
+    which is allocated now so that the rehash itself cannot fail*/
+    uOccupied = 0;
+    uOverflow = 0;
+    for (j = 0; j < oSymTable->bucketCount; j++) {
+        for (curr = SymTable_chain(oSymTable, j); curr != NULL;
+            curr = curr->next) {
+            bucket = SymTable_bucket(oSymTable, tmp,
+                SymTable_index(oSymTable, curr->hash, auBucketCounts[i]));
+            if (bucket->hash == 0) {
+                bucket->hash = 1;
+                uOccupied++;
+            }
+            if (curr != SymTable_slot(oSymTable, j)) {
+                uOverflow++;
+            }
+        }
+    }
+    spare = NULL;
+    for (; uOverflow < oSymTable->counter - uOccupied; uOverflow++) {
+        curr = (struct Bind*)SymTable_alloc(oSymTable,
+            oSymTable->bindSize);
+        if (curr == NULL) {
+            while (spare != NULL) {
+                next = spare->next;
+                SymTable_release(oSymTable, spare);
+                spare = next;
+            }
+            SymTable_freeBuckets(oSymTable, tmp, auBucketCounts[i]);
+            return;
+        }
+        curr->next = spare;
+        spare = curr;
+    }
+
+    /*moves the separate binds first, so that those emptied by
+    landing in the new array are spare before the binds of the old
+    array need them*/
+    for (j = 0; j < oSymTable->bucketCount; j++) {
+        curr = SymTable_chain(oSymTable, j);
+        if (curr == NULL) {
+            continue;
+        }
+        for (curr = curr->next; curr != NULL; curr = next) {
+            /*new bucket from the stored hash code*/
+            bucket = SymTable_bucket(oSymTable, tmp,
+                SymTable_index(oSymTable, curr->hash, auBucketCounts[i]));
+            next = curr->next;
+            if (bucket->key == NULL) {
+                SymTable_moveBind(oSymTable, bucket, curr);
+                curr->next = spare;
+                spare = curr;
+            }
+            else {
+                curr->next = bucket->next;
+                bucket->next = curr;
+            }
+        }
+    }
+    for (j = 0; j < oSymTable->bucketCount; j++) {
+        curr = SymTable_chain(oSymTable, j);
+        if (curr == NULL) {
+            continue;
+        }
+        bucket = SymTable_bucket(oSymTable, tmp,
+            SymTable_index(oSymTable, curr->hash, auBucketCounts[i]));
+        if (bucket->key == NULL) {
+            SymTable_moveBind(oSymTable, bucket, curr);
+        }
+        else {
+            assert(spare != NULL);
+            next = spare;
+            spare = spare->next;
+            SymTable_moveBind(oSymTable, next, curr);
+            next->next = bucket->next;
+            bucket->next = next;
+        }
+    }
+    while (spare != NULL) {
+        next = spare->next;
+        SymTable_release(oSymTable, spare);
+        spare = next;
+    }
+
+    /*Frees the old array & sets the pointer to the new array. The
+    chains that had an index have been split up, so long chains get
+    new indexes*/
+    uIndexed = oSymTable->indexCount;
+    SymTable_dropIndexes(oSymTable, oSymTable->bucketCount);
+    SymTable_unshare(oSymTable);
+    oSymTable->bucketCount = auBucketCounts[i];
+    oSymTable->buckets = tmp;
+    if (uIndexed > 0) {
+        SymTable_buildIndexes(oSymTable);
+    }
+
+    /*the filter is sized for the bucket array*/
+    if (oSymTable->filtered) {
+        SymTable_buildFilter(oSymTable);
+    }
+}
+
+/* Behaves like SymTable_expand, and records the resize in the 
+   profile. */
+static void SymTable_grow(SymTable_T oSymTable, size_t uCount) {
+    uint64_t uStart;
+    assert(oSymTable != NULL);
+    uStart = SymTable_profileStart(PROFILE_EXPAND);
+    SymTable_expand(oSymTable, uCount);
+    SymTable_profileResize(uStart, oSymTable->bucketCount);
+}
+
+/* Returns a new SymTable with no bindings whose memory comes from 
+   pfAlloc & pfFree with pvContext, and that stores values of 
+   uValueSize bytes in its binds, or pointers to values if uValueSize 
+   is 0. Returns NULL if insufficient memory is available. */
+static SymTable_T SymTable_create(
+    void *(*pfAlloc)(size_t uSize, void *pvContext),
+    void (*pfFree)(void *pvBlock, void *pvContext), void *pvContext,
+    size_t uValueSize) {
+    SymTable_T oSymTable; 
+    assert(pfAlloc != NULL);
+    assert(pfFree != NULL);
+
+    /*allocates memory for a new SymTable*/
+    oSymTable = (SymTable_T)(*pfAlloc)(sizeof(struct SymTable),
+        pvContext);
+    if (oSymTable == NULL) {
+        return NULL;
+    } 
+    oSymTable->pfAlloc = pfAlloc;
+    oSymTable->pfFree = pfFree;
+    oSymTable->pvContext = pvContext;
+
+    /*an inline value is padded so that the next bucket's bind stays 
+    aligned*/
+    oSymTable->valueSize = uValueSize;
+    oSymTable->bindSize = sizeof(struct Bind) + (uValueSize + 
+        sizeof(void*) - 1) / sizeof(void*) * sizeof(void*);
+    oSymTable->oldValue = NULL;
+    if (uValueSize > 0) {
+        oSymTable->oldValue = (*pfAlloc)(uValueSize, pvContext);
+        if (oSymTable->oldValue == NULL) {
+            (*pfFree)(oSymTable, pvContext);
+            return NULL;
+        }
+    }
+
+    /*the buckets are allocated lazily by the first SymTable_put*/
+    oSymTable->buckets = NULL;
+    oSymTable->indexes = NULL;
+    oSymTable->indexCount = 0;
+    oSymTable->shares = NULL;
+    oSymTable->segments = NULL;
+    oSymTable->pool = NULL;
+    oSymTable->store = NULL;
+    oSymTable->keyBytes = 0;
+    oSymTable->filtered = FALSE;
+    oSymTable->filter = NULL;
+    oSymTable->undo = NULL;
+
+    /*Sets counter to 0*/
+    oSymTable->counter = 0;
+    oSymTable->bucketCount = 0;
+
+    /*the seed hashes the table's address under the secret key, which 
+    is unique among live tables and cannot be guessed*/
+    (void)pthread_once(&sSipKeyOnce, SymTable_chooseKey);
+    oSymTable->seed = SymTable_sipHash(&oSymTable, sizeof(oSymTable));
+
+    return oSymTable;
+}
+
+SymTable_T SymTable_new(void) {
+    return SymTable_create(SymTable_defaultAlloc, SymTable_defaultFree,
+        NULL, 0);
+}
+
+SymTable_T SymTable_newWithAllocator(
+    void *(*pfAlloc)(size_t uSize, void *pvContext),
+    void (*pfFree)(void *pvBlock, void *pvContext), void *pvContext) {
+    return SymTable_create(pfAlloc, pfFree, pvContext, 0);
+}
+
+SymTable_T SymTable_newInline(size_t uValueSize) {
+    assert(uValueSize > 0);
+    return SymTable_create(SymTable_defaultAlloc, SymTable_defaultFree,
+        NULL, uValueSize);
+}
+
+SymTable_T SymTable_newCompact(void) {
+    SymTable_T oSymTable;
+    struct Store *store;
+    oSymTable = SymTable_create(SymTable_defaultAlloc,
+        SymTable_defaultFree, NULL, 0);
+    if (oSymTable == NULL) {
+        return NULL;
+    }
+    store = (struct Store*)SymTable_alloc(oSymTable,
+        sizeof(struct Store));
+    if (store == NULL) {
+        SymTable_free(oSymTable);
+        return NULL;
+    }
+    store->refCount = 1;
+    store->chunks = NULL;
+    store->next = NULL;
+    store->room = 0;
+    store->used = 0;
+    store->prefixBytes = 0;
+    store->prefixes = NULL;
+    store->prefixCount = 0;
+    store->slots = NULL;
+    store->slotCount = 0;
+    oSymTable->store = store;
+    return oSymTable;
+}
+
+/* Returns record i of the undo log of oSymTable. */
+static struct Undo *SymTable_undoRecord(SymTable_T oSymTable,
+    size_t i) {
+    assert(oSymTable != NULL);
+    assert(oSymTable->undo != NULL);
+    assert(i < oSymTable->undoCount);
+    return (struct Undo*)(void*)(oSymTable->undo +
+        i * oSymTable->undoSize);
+}
+
+/* Returns the old value that record of oSymTable holds. */
+static const void *SymTable_undoValue(SymTable_T oSymTable,
+    const struct Undo *record) {
+    assert(oSymTable != NULL);
+    assert(record != NULL);
+    if (oSymTable->valueSize == 0) {
+        return record->value;
+    }
+    return record + 1;
+}
+
+/* Frees key and bind, which may be NULL, once a removal from 
+   oSymTable no longer needs them, or hands them to *ppcKey and 
+   *ppSpare instead if ppcKey is not NULL. */
+static void SymTable_discard(SymTable_T oSymTable, char *key,
+    struct Bind *bind, char **ppcKey, struct Bind **ppSpare) {
+    assert(oSymTable != NULL);
+    if (ppcKey != NULL) {
+        assert(ppSpare != NULL);
+        *ppcKey = key;
+        *ppSpare = bind;
+        return;
+    }
+    SymTable_releaseKey(oSymTable, key);
+    if (bind != NULL) {
+        SymTable_release(oSymTable, bind);
+    }
+}
+
+/* Frees the undo log of oSymTable, with the keys & binds that its 
+   removal records still hold, which ends the open transaction. */
+static void SymTable_endTxn(SymTable_T oSymTable) {
+    struct Undo *record;
+    size_t i;
+    assert(oSymTable != NULL);
+    assert(oSymTable->undo != NULL);
+    for (i = 0; i < oSymTable->undoCount; i++) {
+        record = SymTable_undoRecord(oSymTable, i);
+        if (record->kind == UNDO_REMOVE) {
+            SymTable_discard(oSymTable, record->key, record->spare,
+                NULL, NULL);
+        }
+    }
+    SymTable_release(oSymTable, oSymTable->undo);
+    oSymTable->undo = NULL;
+}
+
+void SymTable_free(SymTable_T oSymTable) {
+    size_t uSegment;
+    assert(oSymTable != NULL);
+    if (oSymTable->undo != NULL) {
+        SymTable_endTxn(oSymTable);
+    }
+
+    /*drops the table's copies of segments, each of which goes once 
+    no clone reads it either*/
+    if (oSymTable->segments != NULL) {
+        for (uSegment = 0; uSegment << SEGMENT_BITS <
+            oSymTable->bucketCount; uSegment++) {
+            if (oSymTable->segments[uSegment] != NULL) {
+                SymTable_releaseSegment(oSymTable,
+                    oSymTable->segments[uSegment],
+                    SymTable_segmentSize(oSymTable, uSegment));
+            }
+        }
+        SymTable_release(oSymTable, oSymTable->segments);
+    }
+
+    /*goes through every bucket of the array, unless a clone still 
+    shares it, and removes the key & every node outside the bucket 
+    array*/
+    if (oSymTable->shares != NULL) {
+        (*oSymTable->shares)--;
+    }
+    if (oSymTable->shares == NULL || *oSymTable->shares == 0) {
+        if (oSymTable->buckets != NULL) {
+            SymTable_freeChains(oSymTable, oSymTable->buckets,
+                oSymTable->bucketCount);
+        }
+        SymTable_freeBuckets(oSymTable, oSymTable->buckets,
+            oSymTable->bucketCount);
+        if (oSymTable->shares != NULL) {
+            SymTable_release(oSymTable, oSymTable->shares);
+        }
+    }
+
+    /*the keys are gone, so the pool can go unless a clone reads it*/
+    if (oSymTable->pool != NULL) {
+        oSymTable->pool->refCount--;
+        if (oSymTable->pool->refCount == 0) {
+            (void)munmap(oSymTable->pool->text,
+                oSymTable->pool->length + 1);
+            SymTable_release(oSymTable, oSymTable->pool);
+        }
+    }
+
+    /*so can the store*/
+    if (oSymTable->store != NULL) {
+        oSymTable->store->refCount--;
+        if (oSymTable->store->refCount == 0) {
+            SymTable_freeChunks(oSymTable, oSymTable->store->chunks);
+            if (oSymTable->store->slots != NULL) {
+                SymTable_release(oSymTable, oSymTable->store->slots);
+                SymTable_release(oSymTable, oSymTable->store->prefixes);
+            }
+            SymTable_release(oSymTable, oSymTable->store);
+        }
+    }
+
+    /*frees the filter, indexes & overall SymTable*/
+    SymTable_dropFilter(oSymTable);
+    SymTable_dropIndexes(oSymTable, oSymTable->bucketCount);
+    SymTable_release(oSymTable, oSymTable->oldValue);
+    SymTable_release(oSymTable, oSymTable);
+}
+
+/* Gives copy, a clone of oSymTable that has the same bucket array, 
+   a copy of every index of oSymTable. An index only speeds up 
+   searches, so if there is not enough memory for them all, copy is 
+   left without indexes. */
+static void SymTable_copyIndexes(SymTable_T copy, SymTable_T oSymTable) {
+    struct Index *index;
+    size_t i;
+    assert(copy != NULL);
+    assert(oSymTable != NULL);
+    assert(copy->bucketCount == oSymTable->bucketCount);
+    copy->indexes = (struct Index**)SymTable_alloc(copy,
+        copy->bucketCount * sizeof(struct Index*));
+    if (copy->indexes == NULL) {
+        return;
+    }
+    memset(copy->indexes, 0, copy->bucketCount * sizeof(struct Index*));
+    for (i = 0; i < oSymTable->bucketCount; i++) {
+        if (oSymTable->indexes[i] == NULL) {
+            continue;
+        }
+        index = (struct Index*)SymTable_alloc(copy, sizeof(struct Index));
+        if (index != NULL) {
+            *index = *oSymTable->indexes[i];
+            index->binds = (struct Bind**)SymTable_alloc(copy,
+                index->capacity * sizeof(struct Bind*));
+            if (index->binds == NULL) {
+                SymTable_release(copy, index);
+                index = NULL;
+            }
+        }
+        if (index == NULL) {
+            if (copy->indexCount == 0) {
+                SymTable_release(copy, copy->indexes);
+                copy->indexes = NULL;
+            }
+            SymTable_dropIndexes(copy, copy->bucketCount);
+            return;
+        }
+        memcpy(index->binds, oSymTable->indexes[i]->binds,
+            index->count * sizeof(struct Bind*));
+        copy->indexes[i] = index;
+        copy->indexCount++;
+    }
+}
+
+SymTable_T SymTable_clone(SymTable_T oSymTable) {
+    SymTable_T copy;
+    size_t uSegment;
+    size_t uSegmentCount;
+    assert(oSymTable != NULL);
+    assert(oSymTable->undo == NULL);
+
+    copy = SymTable_create(oSymTable->pfAlloc, oSymTable->pfFree,
+        oSymTable->pvContext, oSymTable->valueSize);
+    if (copy == NULL) {
+        return NULL;
+    }
+
+    /*values in the pool must outlive the table, even if it is empty*/
+    copy->pool = oSymTable->pool;
+    if (copy->pool != NULL) {
+        copy->pool->refCount++;
+    }
+    copy->store = oSymTable->store;
+    if (copy->store != NULL) {
+        copy->store->refCount++;
+    }
+    copy->keyBytes = oSymTable->keyBytes;
+    copy->filtered = oSymTable->filtered;
+    copy->filter = oSymTable->filter;
+    if (copy->filter != NULL) {
+        copy->filter->refCount++;
+    }
+    if (oSymTable->buckets == NULL) {
+        return copy;
+    }
+
+    /*the clone reads the same bucket array & the same copies of 
+    segments; whichever table changes a segment first copies it*/
+    if (oSymTable->shares == NULL) {
+        oSymTable->shares = (size_t*)SymTable_alloc(oSymTable,
+            sizeof(size_t));
+        if (oSymTable->shares == NULL) {
+            SymTable_free(copy);
+            return NULL;
+        }
+        *oSymTable->shares = 1;
+    }
+    if (oSymTable->segments != NULL) {
+        uSegmentCount = (oSymTable->bucketCount + SEGMENT_SIZE - 1) >>
+            SEGMENT_BITS;
+        copy->segments = (struct Segment**)SymTable_alloc(copy,
+            uSegmentCount * sizeof(struct Segment*));
+        if (copy->segments == NULL) {
+            SymTable_free(copy);
+            return NULL;
+        }
+        memcpy(copy->segments, oSymTable->segments,
+            uSegmentCount * sizeof(struct Segment*));
+        for (uSegment = 0; uSegment < uSegmentCount; uSegment++) {
+            if (copy->segments[uSegment] != NULL) {
+                copy->segments[uSegment]->refCount++;
+            }
+        }
+    }
+    copy->buckets = oSymTable->buckets;
+    copy->shares = oSymTable->shares;
+    (*copy->shares)++;
+    copy->bucketCount = oSymTable->bucketCount;
+    copy->counter = oSymTable->counter;
+
+    /*buckets are picked with the seed, which must therefore match*/
+    copy->seed = oSymTable->seed;
+    if (oSymTable->indexCount > 0) {
+        SymTable_copyIndexes(copy, oSymTable);
+    }
+    return copy;
+}
+
+int SymTable_addFilter(SymTable_T oSymTable) {
+    assert(oSymTable != NULL);
+    if (oSymTable->filtered) {
+        return TRUE;
+    }
+
+    /*a table without buckets gets its filter with them*/
+    if (oSymTable->bucketCount > 0) {
+        SymTable_buildFilter(oSymTable);
+        if (oSymTable->filter == NULL) {
+            return FALSE;
+        }
+    }
+    oSymTable->filtered = TRUE;
+    return TRUE;
+}
+
+size_t SymTable_getLength(SymTable_T oSymTable) {
+    assert(oSymTable != NULL);
+    return oSymTable->counter;
+}
+
+/* Makes room for one more record in the undo log of oSymTable, if a 
+   transaction is open, so that the change it records cannot fail 
+   once it is made. Returns FALSE if insufficient memory is available 
+   and TRUE otherwise. */
+static int SymTable_reserveUndo(SymTable_T oSymTable) {
+    char *records;
+    assert(oSymTable != NULL);
+    if (oSymTable->undo == NULL ||
+        oSymTable->undoCount < oSymTable->undoCapacity) {
+        return TRUE;
+    }
+    records = (char*)SymTable_alloc(oSymTable,
+        2 * oSymTable->undoCapacity * oSymTable->undoSize);
+    if (records == NULL) {
+        return FALSE;
+    }
+    memcpy(records, oSymTable->undo,
+        oSymTable->undoCount * oSymTable->undoSize);
+    SymTable_release(oSymTable, oSymTable->undo);
+    oSymTable->undo = records;
+    oSymTable->undoCapacity *= 2;
+    return TRUE;
+}
+
+/* Records a change of kind iKind to the binding of oSymTable whose 
+   key, in stored form, is the uLength characters at key, with hash 
+   code uHash, and whose value was pvValue, in the undo log if a 
+   transaction is open, which SymTable_reserveUndo made room in. A 
+   removal hands the log its key and spare, the bind it freed. */
+static void SymTable_logUndo(SymTable_T oSymTable, int iKind,
+    char *key, size_t uLength, size_t uHash, const void *pvValue,
+    struct Bind *spare) {
+    struct Undo *record;
+    assert(oSymTable != NULL);
+    if (oSymTable->undo == NULL) {
+        return;
+    }
+    assert(oSymTable->undoCount < oSymTable->undoCapacity);
+    oSymTable->undoCount++;
+    record = SymTable_undoRecord(oSymTable, oSymTable->undoCount - 1);
+    record->kind = iKind;
+    record->key = key;
+    record->keyLength = uLength;
+    record->hash = uHash;
+    record->value = pvValue;
+    record->spare = spare;
+    if (oSymTable->valueSize > 0 && pvValue != NULL) {
+        memcpy(record + 1, pvValue, oSymTable->valueSize);
+    }
+}
+
+/* Returns bind, the binding of oSymTable whose key is the uLength 
+   characters at pcKey, with hash code uHash, before its value is 
+   changed, after copying it if a clone shares it and recording its 
+   value in the undo log of an open transaction. Returns NULL if 
+   insufficient memory is available. */
+static struct Bind *SymTable_prepareChange(SymTable_T oSymTable,
+    struct Bind *bind, const char *pcKey, size_t uLength,
+    size_t uHash) {
+    assert(oSymTable != NULL);
+    assert(bind != NULL);
+    if (!SymTable_reserveUndo(oSymTable)) {
+        return NULL;
+    }
+    bind = SymTable_ownBind(oSymTable, bind, pcKey, uLength, uHash);
+    if (bind == NULL) {
+        return NULL;
+    }
+    SymTable_logUndo(oSymTable, UNDO_REPLACE, bind->key, uLength, uHash,
+        bind->value, NULL);
+    return bind;
+}
+
+/* Links a bind whose key is a copy of the uLength characters at 
+   pcKey, with hash code uHash, and whose value is pvValue into 
+   bucket of oSymTable, and returns it, or returns NULL and leaves 
+   bucket unchanged if insufficient memory is available. */
+static struct Bind *SymTable_newBind(SymTable_T oSymTable,
+    struct Bind *bucket, const char *pcKey, size_t uLength,
+    size_t uHash, const void *pvValue) {
+    struct Bind *newBind;
+    char *copy;
+    size_t uSize;
+    assert(bucket != NULL);
+    assert(pcKey != NULL);
+
+    /*a key that is already a whole string in the pool is used in 
+    place, and a compact table copies a key's stored form to its 
+    store; any other gets a Defensive Copy of the string that pcKey 
+    points to, whose address is stored in a new binding*/
+    uSize = SymTable_keySize(pcKey, uLength);
+    if (SymTable_isPooled(oSymTable, pcKey) && pcKey[uLength] == '\0') {
+        copy = (char*)pcKey;
+    }
+    else if (oSymTable->store != NULL) {
+        copy = SymTable_storeBytes(oSymTable, uSize, FALSE);
+        if (copy == NULL) {
+            return NULL;
+        }
+        memcpy(copy, pcKey, uLength);
+        if (uSize > uLength) {
+            copy[uLength] = '\0';
+        }
+    }
+    else {
+        copy = SymTable_alloc(oSymTable, uLength + 1);
+        if (copy == NULL) {
+            return NULL;
+        }
+        memcpy(copy, pcKey, uLength);
+        copy[uLength] = '\0';
+    }
+
+    newBind = SymTable_link(oSymTable, bucket, copy, uLength, uHash,
+        pvValue, NULL);
+    if (newBind == NULL) {
+        SymTable_releaseKey(oSymTable, copy);
+        return NULL;
+    }
+    if (oSymTable->store != NULL) {
+        oSymTable->keyBytes += uSize;
+    }
+    return newBind;
+}
+
+/* Returns the bind of oSymTable whose key is the uLength characters 
+   at pcKey, with hash code uHash. If there is no such bind, first 
+   adds one whose value is pvValue. Sets *piAdded to TRUE if the bind 
+   was added and FALSE otherwise. Returns NULL and leaves oSymTable 
+   unchanged if insufficient memory is available. */
+static struct Bind *SymTable_findOrAdd(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength, size_t uHash,
+    const void *pvValue, int *piAdded) {
+        struct Bind *newBind;
+        struct Bind *bucket;
+        size_t uBucket;
+        assert(oSymTable != NULL);
+        assert(pcKey != NULL);
+        assert(piAdded != NULL);
+        *piAdded = FALSE;
+
+        /* checks if pcKey exists already in SymTable*/
+        newBind = SymTable_find(oSymTable, pcKey, uLength, uHash);
+        if (newBind != NULL) {
+            return newBind;
+        }
+
+        /*Calls expand function to allocate more space and set 
+        bucketcount equal to the new size. An open transaction puts 
+        the rehash off until it commits*/
+        if (oSymTable->counter >= oSymTable->bucketCount &&
+            (oSymTable->undo == NULL || oSymTable->buckets == NULL)) {
+            SymTable_grow(oSymTable, 0);
+        }
+
+        /*the first bucket array could not be allocated*/
+        if (oSymTable->buckets == NULL ||
+            !SymTable_reserveUndo(oSymTable)) {
+            return NULL;
+        }
+
+        /*inserts the newBind into the SymTable*/
+        uBucket = SymTable_index(oSymTable, uHash,
+            oSymTable->bucketCount);
+        bucket = SymTable_own(oSymTable, uBucket);
+        if (bucket == NULL) {
+            return NULL;
+        }
+        newBind = SymTable_newBind(oSymTable, bucket, pcKey, uLength,
+            uHash, pvValue);
+        if (newBind == NULL) {
+            return NULL;
+        }
+        if (newBind != bucket) {
+            SymTable_indexBind(oSymTable, uBucket, newBind);
+        }
+        if (oSymTable->filter != NULL) {
+            SymTable_filterAdd(oSymTable, uHash);
+        }
+        SymTable_logUndo(oSymTable, UNDO_ADD, newBind->key, uLength,
+            uHash, NULL, NULL);
+        oSymTable->counter++;
+        *piAdded = TRUE;
+        return newBind;
+    }
+
+/* Adds a binding whose key is the uLength characters at pcKey, with 
+   hash code uHash, and whose value is pvValue to oSymTable and 
+   returns TRUE, or returns FALSE and leaves oSymTable unchanged if 
+   the key is already bound or if insufficient memory is available. */
+static int SymTable_insert(SymTable_T oSymTable, const char *pcKey,
+    size_t uLength, size_t uHash, const void *pvValue) {
+    char acEncoded[ENCODED_SIZE];
+    uint64_t uStart;
+    int iAdded;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    uStart = SymTable_profileStart(PROFILE_PUT);
+    iAdded = FALSE;
+    if (SymTable_encode(oSymTable, &pcKey, &uLength, TRUE, acEncoded)) {
+        (void)SymTable_findOrAdd(oSymTable, pcKey, uLength, uHash,
+            pvValue, &iAdded);
+    }
+    SymTable_profileEnd(PROFILE_PUT, uStart);
+    return iAdded;
+}
+
+int SymTable_put(SymTable_T oSymTable,
+    const char *pcKey, const void *pvValue) {
+    size_t uLength;
+    size_t uHash;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    uHash = SymTable_hashString(pcKey, &uLength);
+    return SymTable_insert(oSymTable, pcKey, uLength, uHash, pvValue);
+}
+
+int SymTable_putWithHash(SymTable_T oSymTable,
+    const char *pcKey, size_t uHash, const void *pvValue) {
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    assert(uHash == SymTable_hashKey(pcKey));
+    return SymTable_insert(oSymTable, pcKey, strlen(pcKey), uHash,
+        pvValue);
+}
+
+int SymTable_putN(SymTable_T oSymTable, const char *pcKey,
+    size_t uLength, const void *pvValue) {
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    assert(memchr(pcKey, '\0', uLength) == NULL);
+    return SymTable_insert(oSymTable, pcKey, uLength,
+        SymTable_hashKeyN(pcKey, uLength), pvValue);
+}
+
+/* If oSymTable contains a binding whose key is the uLength characters
+   at pcKey, with hash code uHash, replaces the binding's value with 
+   pvValue and returns the old value. Otherwise returns NULL. */
+static void *SymTable_replaceBind(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength, size_t uHash,
+    const void *pvValue) {
+        struct Bind *tmp;
+        void* val;
+        char acEncoded[ENCODED_SIZE];
+        uint64_t uStart;
+        assert(oSymTable != NULL);
+        assert(pcKey != NULL);
+        uStart = SymTable_profileStart(PROFILE_REPLACE);
+        
+        /* checks if oSymTable contains the key */
+        tmp = NULL;
+        if (SymTable_encode(oSymTable, &pcKey, &uLength, FALSE,
+            acEncoded)) {
+            tmp = SymTable_find(oSymTable, pcKey, uLength, uHash);
+        }
+        if (tmp != NULL) {
+            tmp = SymTable_prepareChange(oSymTable, tmp, pcKey, uLength,
+                uHash);
+        }
+
+        /* replaces the value with a given value */
+        val = NULL;
+        if (tmp != NULL) {
+            val = SymTable_saveValue(oSymTable, tmp);
+            SymTable_setValue(oSymTable, tmp, pvValue);
+        }
+        SymTable_profileEnd(PROFILE_REPLACE, uStart);
+        return val;
+    }
+
+void *SymTable_replace(SymTable_T oSymTable, 
+    const char *pcKey, const void *pvValue) {
+    size_t uLength;
+    size_t uHash;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    uHash = SymTable_hashString(pcKey, &uLength);
+    return SymTable_replaceBind(oSymTable, pcKey, uLength, uHash,
+        pvValue);
+}
+
+void *SymTable_replaceN(SymTable_T oSymTable, const char *pcKey,
+    size_t uLength, const void *pvValue) {
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    assert(memchr(pcKey, '\0', uLength) == NULL);
+    return SymTable_replaceBind(oSymTable, pcKey, uLength,
+        SymTable_hashKeyN(pcKey, uLength), pvValue);
+}
+
+/* Behaves like SymTable_find, for a key that is not yet in the form 
+   that oSymTable stores it in. */
+static struct Bind *SymTable_findKey(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength, size_t uHash) {
+    char acEncoded[ENCODED_SIZE];
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    if (!SymTable_encode(oSymTable, &pcKey, &uLength, FALSE,
+        acEncoded)) {
+        return NULL;
+    }
+    return SymTable_find(oSymTable, pcKey, uLength, uHash);
+}
+
+/* Returns TRUE if oSymTable contains a binding whose key is the 
+   uLength characters at pcKey, with hash code uHash, and FALSE 
+   otherwise. */
+static int SymTable_has(SymTable_T oSymTable, const char *pcKey,
+    size_t uLength, size_t uHash) {
+    struct Bind *tmp;
+    uint64_t uStart;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    uStart = SymTable_profileStart(PROFILE_CONTAINS);
+    tmp = SymTable_findKey(oSymTable, pcKey, uLength, uHash);
+    SymTable_profileEnd(PROFILE_CONTAINS, uStart);
+    return tmp != NULL;
+}
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey) {
+    size_t uLength;
+    size_t uHash;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    uHash = SymTable_hashString(pcKey, &uLength);
+    return SymTable_has(oSymTable, pcKey, uLength, uHash);
+}
+
+int SymTable_containsWithHash(SymTable_T oSymTable,
+    const char *pcKey, size_t uHash) {
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    assert(uHash == SymTable_hashKey(pcKey));
+    return SymTable_has(oSymTable, pcKey, strlen(pcKey), uHash);
+}
+
+int SymTable_containsN(SymTable_T oSymTable, const char *pcKey,
+    size_t uLength) {
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    assert(memchr(pcKey, '\0', uLength) == NULL);
+    return SymTable_has(oSymTable, pcKey, uLength,
+        SymTable_hashKeyN(pcKey, uLength));
+}
+
+/* Returns the value of the binding of oSymTable whose key is the 
+   uLength characters at pcKey, with hash code uHash, or NULL if 
+   there is no such binding. */
+static void *SymTable_value(SymTable_T oSymTable, const char *pcKey,
+    size_t uLength, size_t uHash) {
+    struct Bind *tmp;
+    uint64_t uStart;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    uStart = SymTable_profileStart(PROFILE_GET);
+    tmp = SymTable_findKey(oSymTable, pcKey, uLength, uHash);
+    SymTable_profileEnd(PROFILE_GET, uStart);
+    if (tmp == NULL) {
+        return NULL;
+    }
+    return (void*)tmp->value;
+}
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey) {
+    size_t uLength;
+    size_t uHash;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    uHash = SymTable_hashString(pcKey, &uLength);
+    return SymTable_value(oSymTable, pcKey, uLength, uHash);
+}
+
+void *SymTable_getWithHash(SymTable_T oSymTable,
+    const char *pcKey, size_t uHash) {
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    assert(uHash == SymTable_hashKey(pcKey));
+    return SymTable_value(oSymTable, pcKey, strlen(pcKey), uHash);
+}
+
+void *SymTable_getN(SymTable_T oSymTable, const char *pcKey,
+    size_t uLength) {
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    assert(memchr(pcKey, '\0', uLength) == NULL);
+    return SymTable_value(oSymTable, pcKey, uLength,
+        SymTable_hashKeyN(pcKey, uLength));
+}
+
+/* Starts fetching the memory that a lookup of a key with hash code 
+   uHash in oSymTable reads first, its filter block and its bucket, 
+   so that it is at hand by the time the key is looked up. */
+static void SymTable_prefetch(SymTable_T oSymTable, size_t uHash) {
+    assert(oSymTable != NULL);
+    if (oSymTable->bucketCount == 0) {
+        return;
+    }
+#ifdef __GNUC__
+    if (oSymTable->filter != NULL) {
+        __builtin_prefetch(SymTable_filterBlock(oSymTable->filter,
+            SymTable_filterHash(oSymTable, uHash)));
+    }
+    __builtin_prefetch(SymTable_slot(oSymTable, SymTable_index(oSymTable,
+        uHash, oSymTable->bucketCount)));
+#else
+    (void)uHash;
+#endif
+}
+
+void *SymTable_getFirst(SymTable_T *poSymTables, size_t uCount,
+    const char *pcKey, size_t *puWhich) {
+    struct Bind *tmp;
+    uint64_t uStart;
+    size_t uLength;
+    size_t uHash;
+    size_t i;
+    assert(poSymTables != NULL || uCount == 0);
+    assert(pcKey != NULL);
+    uStart = SymTable_profileStart(PROFILE_GET_FIRST);
+
+    /*every table hashes a key alike, so the key is hashed once, and 
+    the next table's bucket is fetched while this one is searched*/
+    uHash = SymTable_hashString(pcKey, &uLength);
+    if (uCount > 0) {
+        SymTable_prefetch(poSymTables[0], uHash);
+    }
+    tmp = NULL;
+    for (i = 0; i < uCount && tmp == NULL; i++) {
+        assert(poSymTables[i] != NULL);
+        if (i + 1 < uCount) {
+            SymTable_prefetch(poSymTables[i + 1], uHash);
+        }
+        tmp = SymTable_findKey(poSymTables[i], pcKey, uLength, uHash);
+    }
+    SymTable_profileEnd(PROFILE_GET_FIRST, uStart);
+    if (tmp == NULL) {
+        if (puWhich != NULL) {
+            *puWhich = uCount;
+        }
+        return NULL;
+    }
+    if (puWhich != NULL) {
+        *puWhich = i - 1;
+    }
+    return (void*)tmp->value;
+}
+
+/* If oSymTable contains a binding whose key is the uLength characters
+   at pcKey, with hash code uHash, removes that binding and returns 
+   its value. Otherwise returns NULL. If ppcKey is not NULL, the key 
+   and the bind that the removal frees, if any, are handed to *ppcKey 
+   and *ppSpare rather than freed. */
+static void *SymTable_removeBind(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength, size_t uHash, char **ppcKey,
+    struct Bind **ppSpare) {
+    struct Bind *bucket;
+    struct Bind *tmp;
+    char *key;
+    struct Bind **link;
+    struct Index *index;
+    size_t uBucket;
+    size_t uPosition;
+    void *val;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    if (oSymTable->bucketCount == 0) {
+        return NULL;
+    }
+    if (oSymTable->filter != NULL && !SymTable_filterTest(
+        oSymTable->filter, SymTable_filterHash(oSymTable, uHash))) {
+        return NULL;
+    }
+    uBucket = SymTable_index(oSymTable, uHash, oSymTable->bucketCount);
+
+    /*copying a segment shared with a clone is wasted on a key that is 
+    not there*/
+    if (oSymTable->shares != NULL &&
+        SymTable_find(oSymTable, pcKey, uLength, uHash) == NULL) {
+        return NULL;
+    }
+    bucket = SymTable_own(oSymTable, uBucket);
+    if (bucket == NULL || bucket->key == NULL) {
+        return NULL;
+    }
+    index = oSymTable->indexes == NULL ? NULL :
+        oSymTable->indexes[uBucket];
+
+    /* the first bind is replaced by the one after it, if any */
+    if (bucket->hash == uHash && bucket->keyLength == uLength &&
+        memcmp(pcKey, bucket->key, uLength) == 0) {
+        val = SymTable_saveValue(oSymTable, bucket);
+        key = bucket->key;
+        tmp = bucket->next;
+        if (tmp != NULL) {
+            SymTable_moveBind(oSymTable, bucket, tmp);
+            bucket->next = tmp->next;
+            SymTable_discard(oSymTable, key, tmp, ppcKey, ppSpare);
+            /*binds[1] now lives in the array, which binds[0] is*/
+            if (index != NULL) {
+                SymTable_unindexBind(oSymTable, uBucket, index, 1);
+            }
+        }
+        else {
+            bucket->key = NULL;
+            SymTable_discard(oSymTable, key, NULL, ppcKey, ppSpare);
+        }
+        oSymTable->counter--;
+        return val;
+    }
+
+    /* a long chain finds the bind, and the one before it, through 
+    its index */
+    if (index != NULL) {
+        uPosition = SymTable_search(index, pcKey, uLength, uHash);
+        if (uPosition == index->count || SymTable_compareKey(
+            index->binds[uPosition], pcKey, uLength, uHash) != 0) {
+            return NULL;
+        }
+        tmp = index->binds[uPosition];
+        val = SymTable_saveValue(oSymTable, tmp);
+        index->binds[uPosition - 1]->next = tmp->next;
+        SymTable_discard(oSymTable, tmp->key, tmp, ppcKey, ppSpare);
+        SymTable_unindexBind(oSymTable, uBucket, index, uPosition);
+        oSymTable->counter--;
+        return val;
+    }
+
+    /* skips to the bind, remembering the link that points to it */
+    for (link = &bucket->next; *link != NULL; link = &(*link)->next) {
+        tmp = *link;
+        if (tmp->hash == uHash && tmp->keyLength == uLength &&
+            memcmp(pcKey, tmp->key, uLength) == 0) {
+            /* unlinks the bind, frees the key & bind, decrements 
+            counter, returns val*/
+            val = SymTable_saveValue(oSymTable, tmp);
+            *link = tmp->next;
+            SymTable_discard(oSymTable, tmp->key, tmp, ppcKey, ppSpare);
+            oSymTable->counter--;
+            return val;
+        }
+    }
+    return NULL;
+}
+
+/* Packs the keys & prefixes of the store of oSymTable into new 
+   chunks and frees the old ones, if the table has the store to 
+   itself and removals have left more than half of it unused. Only 
+   the chains that the table reads are moved; any others are old 
+   chains of a shared bucket array, which only this table still 
+   shares, and are only ever freed. If insufficient memory is 
+   available, the keys that were moved stay moved and the old chunks 
+   are kept. */
+static void SymTable_packStore(SymTable_T oSymTable) {
+    struct Store *store;
+    struct Chunk *old;
+    struct Chunk *last;
+    struct Bind *bind;
+    char *copy;
+    size_t uOldUsed;
+    size_t uSize;
+    size_t i;
+    int iMoved;
+    assert(oSymTable != NULL);
+    assert(oSymTable->store != NULL);
+    store = oSymTable->store;
+    if (store->refCount > 1 ||
+        store->used <= 2 * (oSymTable->keyBytes + store->prefixBytes) +
+        STORE_CHUNK_SIZE) {
+        return;
+    }
+
+    old = store->chunks;
+    uOldUsed = store->used;
+    store->chunks = NULL;
+    store->next = NULL;
+    store->room = 0;
+    store->used = 0;
+    iMoved = TRUE;
+    for (i = 0; iMoved && i < store->prefixCount; i++) {
+        uSize = sizeof(struct Prefix) + store->prefixes[i]->length;
+        copy = SymTable_storeBytes(oSymTable, uSize, TRUE);
+        if (copy == NULL) {
+            iMoved = FALSE;
+            continue;
+        }
+        memcpy(copy, store->prefixes[i], uSize);
+        store->prefixes[i] = (struct Prefix*)copy;
+    }
+    for (i = 0; iMoved && i < oSymTable->bucketCount; i++) {
+        for (bind = SymTable_chain(oSymTable, i); bind != NULL;
+            bind = bind->next) {
+            uSize = SymTable_keySize(bind->key, bind->keyLength);
+            copy = SymTable_storeBytes(oSymTable, uSize, FALSE);
+            if (copy == NULL) {
+                iMoved = FALSE;
+                break;
+            }
+            memcpy(copy, bind->key, uSize);
+            bind->key = copy;
+        }
+    }
+    if (iMoved) {
+        SymTable_freeChunks(oSymTable, old);
+        return;
+    }
+
+    /*the old chunks still hold whatever was not moved*/
+    if (store->chunks == NULL) {
+        store->chunks = old;
+    }
+    else {
+        for (last = store->chunks; last->next != NULL;
+            last = last->next) {
+        }
+        last->next = old;
+    }
+    store->used += uOldUsed;
+}
+
+/* Notes that the key made of the uLength characters at pcKey, in 
+   stored form, was just removed from oSymTable. */
+static void SymTable_forgetKey(SymTable_T oSymTable, const char *pcKey,
+    size_t uLength) {
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    /*the key's bytes stay in the store until it is packed, which an 
+    open transaction puts off, and its bits stay in the filter until 
+    it is built again*/
+    if (oSymTable->store != NULL) {
+        oSymTable->keyBytes -= SymTable_keySize(pcKey, uLength);
+        if (oSymTable->undo == NULL) {
+            SymTable_packStore(oSymTable);
+        }
+    }
+    if (oSymTable->filter != NULL) {
+        SymTable_filterRemove(oSymTable);
+    }
+}
+
+/* Behaves like SymTable_removeBind, for a key that is not yet in the 
+   form that oSymTable stores it in. */
+static void *SymTable_removeKey(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength, size_t uHash) {
+    char acEncoded[ENCODED_SIZE];
+    struct Bind *spare;
+    char *key;
+    uint64_t uStart;
+    size_t uCount;
+    void *val;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    uStart = SymTable_profileStart(PROFILE_REMOVE);
+    val = NULL;
+    if (SymTable_encode(oSymTable, &pcKey, &uLength, FALSE,
+        acEncoded) && SymTable_reserveUndo(oSymTable)) {
+        uCount = oSymTable->counter;
+        key = NULL;
+        spare = NULL;
+        val = SymTable_removeBind(oSymTable, pcKey, uLength, uHash,
+            oSymTable->undo != NULL ? &key : NULL, &spare);
+        if (oSymTable->counter != uCount) {
+            SymTable_logUndo(oSymTable, UNDO_REMOVE, key, uLength, uHash,
+                val, spare);
+            SymTable_forgetKey(oSymTable, pcKey, uLength);
+        }
+    }
+    SymTable_profileEnd(PROFILE_REMOVE, uStart);
+    return val;
+}
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
+    size_t uLength;
+    size_t uHash;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    uHash = SymTable_hashString(pcKey, &uLength);
+    return SymTable_removeKey(oSymTable, pcKey, uLength, uHash);
+}
+
+void *SymTable_removeN(SymTable_T oSymTable, const char *pcKey,
+    size_t uLength) {
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    assert(memchr(pcKey, '\0', uLength) == NULL);
+    return SymTable_removeKey(oSymTable, pcKey, uLength,
+        SymTable_hashKeyN(pcKey, uLength));
+}
+
+int SymTable_beginTxn(SymTable_T oSymTable) {
+    assert(oSymTable != NULL);
+    assert(oSymTable->undo == NULL);
+
+    /*a record has room for an inline value after it, padded so that 
+    the next record is aligned*/
+    oSymTable->undoSize = sizeof(struct Undo) + (oSymTable->valueSize +
+        sizeof(void*) - 1) / sizeof(void*) * sizeof(void*);
+    oSymTable->undo = (char*)SymTable_alloc(oSymTable,
+        MIN_UNDO_CAPACITY * oSymTable->undoSize);
+    if (oSymTable->undo == NULL) {
+        return FALSE;
+    }
+    oSymTable->undoCount = 0;
+    oSymTable->undoCapacity = MIN_UNDO_CAPACITY;
+    return TRUE;
+}
+
+void SymTable_commit(SymTable_T oSymTable) {
+    assert(oSymTable != NULL);
+    SymTable_endTxn(oSymTable);
+
+    /*the one rehash that the transaction put off, straight to a size 
+    that fits every binding*/
+    if (oSymTable->counter > oSymTable->bucketCount) {
+        SymTable_grow(oSymTable, oSymTable->counter);
+    }
+    if (oSymTable->store != NULL) {
+        SymTable_packStore(oSymTable);
+    }
+}
+
+void SymTable_rollback(SymTable_T oSymTable) {
+    struct Undo *record;
+    struct Bind *bucket;
+    struct Bind *bind;
+    size_t uBucket;
+    size_t i;
+    assert(oSymTable != NULL);
+    assert(oSymTable->undo != NULL);
+
+    /*records are taken back newest first, so that each finds its 
+    binding as the change it records left it. Nothing has rehashed 
+    since, and every bucket that changed was copied from any clone 
+    when it changed, so nothing here needs memory*/
+    for (i = oSymTable->undoCount; i > 0; i--) {
+        record = SymTable_undoRecord(oSymTable, i - 1);
+        if (record->kind == UNDO_ADD) {
+            (void)SymTable_removeBind(oSymTable, record->key,
+                record->keyLength, record->hash, NULL, NULL);
+            SymTable_forgetKey(oSymTable, record->key,
+                record->keyLength);
+        }
+        else if (record->kind == UNDO_REPLACE) {
+            bind = SymTable_find(oSymTable, record->key,
+                record->keyLength, record->hash);
+            assert(bind != NULL);
+            SymTable_setValue(oSymTable, bind,
+                SymTable_undoValue(oSymTable, record));
+        }
+        else {
+            /*the bucket is as the removal left it: empty if the 
+            removal freed no bind, and otherwise needing one*/
+            uBucket = SymTable_index(oSymTable, record->hash,
+                oSymTable->bucketCount);
+            bucket = SymTable_own(oSymTable, uBucket);
+            assert(bucket != NULL);
+            bind = SymTable_link(oSymTable, bucket, record->key,
+                record->keyLength, record->hash,
+                SymTable_undoValue(oSymTable, record), record->spare);
+            assert(bind != NULL);
+            if (bind == bucket && record->spare != NULL) {
+                SymTable_release(oSymTable, record->spare);
+            }
+            else {
+                SymTable_indexBind(oSymTable, uBucket, bind);
+            }
+            if (oSymTable->store != NULL) {
+                oSymTable->keyBytes += SymTable_keySize(record->key,
+                    record->keyLength);
+            }
+            if (oSymTable->filter != NULL) {
+                SymTable_filterAdd(oSymTable, record->hash);
+            }
+            oSymTable->counter++;
+            record->kind = UNDO_ADD;
+        }
+    }
+    SymTable_endTxn(oSymTable);
+    if (oSymTable->store != NULL) {
+        SymTable_packStore(oSymTable);
+    }
+}
+
+int SymTable_upsert(SymTable_T oSymTable,
+    const char *pcKey, const void *pvValue) {
+    struct Bind *tmp;
+    char acEncoded[ENCODED_SIZE];
+    size_t uLength;
+    size_t uHash;
+    uint64_t uStart;
+    int iAdded;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    uStart = SymTable_profileStart(PROFILE_UPSERT);
+    uHash = SymTable_hashString(pcKey, &uLength);
+    tmp = NULL;
+    if (SymTable_encode(oSymTable, &pcKey, &uLength, TRUE, acEncoded)) {
+        tmp = SymTable_findOrAdd(oSymTable, pcKey, uLength, uHash,
+            pvValue, &iAdded);
+    }
+    if (tmp != NULL && !iAdded) {
+        tmp = SymTable_prepareChange(oSymTable, tmp, pcKey, uLength,
+            uHash);
+    }
+    if (tmp != NULL) {
+        SymTable_setValue(oSymTable, tmp, pvValue);
+    }
+    SymTable_profileEnd(PROFILE_UPSERT, uStart);
+    return tmp != NULL;
+}
+
+void **SymTable_getOrInsert(SymTable_T oSymTable,
+    const char *pcKey, const void *pvValue) {
+    struct Bind *tmp;
+    char acEncoded[ENCODED_SIZE];
+    size_t uLength;
+    size_t uHash;
+    uint64_t uStart;
+    int iAdded;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    uStart = SymTable_profileStart(PROFILE_GET_OR_INSERT);
+    uHash = SymTable_hashString(pcKey, &uLength);
+    tmp = NULL;
+    if (SymTable_encode(oSymTable, &pcKey, &uLength, TRUE, acEncoded)) {
+        tmp = SymTable_findOrAdd(oSymTable, pcKey, uLength, uHash,
+            pvValue, &iAdded);
+    }
+    if (tmp != NULL && !iAdded) {
+        tmp = SymTable_prepareChange(oSymTable, tmp, pcKey, uLength,
+            uHash);
+    }
+    SymTable_profileEnd(PROFILE_GET_OR_INSERT, uStart);
+    if (tmp == NULL) {
+        return NULL;
+    }
+    return (void**)&tmp->value;
+}
+
+void SymTable_map(SymTable_T oSymTable, void (*pfApply)
+    (const char *pcKey, void *pvValue, void *pvExtra), 
+    const void *pvExtra) {
+    size_t i;
+    struct Bind *current;
+    char acDecoded[MAX_SPLIT_KEY];
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+    for (i = 0; i < oSymTable->bucketCount; i++) {
+        current = SymTable_chain(oSymTable, i);
+        while (current != NULL) {
+            (*pfApply)(SymTable_decode(oSymTable, current, acDecoded), 
+                (void*) current->value, (void*) pvExtra);
+            current = current->next;
+        }   
+    }
+}
+
+/* Returns TRUE if pcKey lies in the half-open range [pcLo, pcHi), 
+   where a NULL bound is unbounded, and FALSE otherwise. */
+static int SymTable_inRange(const char *pcKey, const char *pcLo,
+    const char *pcHi) {
+    assert(pcKey != NULL);
+    if (pcLo != NULL && strcmp(pcKey, pcLo) < 0) {
+        return FALSE;
+    }
+    if (pcHi != NULL && strcmp(pcKey, pcHi) >= 0) {
+        return FALSE;
+    }
+    return TRUE;
+}
+
+void SymTable_rangeMap(SymTable_T oSymTable, const char *pcLo,
+    const char *pcHi, void (*pfApply)
+    (const char *pcKey, void *pvValue, void *pvExtra), 
+    const void *pvExtra) {
+    size_t i;
+    struct Bind *current;
+    const char *pcKey;
+    char acDecoded[MAX_SPLIT_KEY];
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+
+    /*a hash table keeps no order, so every bucket is filtered*/
+    for (i = 0; i < oSymTable->bucketCount; i++) {
+        for (current = SymTable_chain(oSymTable, i); current != NULL;
+            current = current->next) {
+            pcKey = SymTable_decode(oSymTable, current, acDecoded);
+            if (SymTable_inRange(pcKey, pcLo, pcHi)) {
+                (*pfApply)(pcKey, 
+                    (void*) current->value, (void*) pvExtra);
+            }
+        }
+    }
+}
+
+void SymTable_prefixMap(SymTable_T oSymTable, const char *pcPrefix,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra), 
+    const void *pvExtra) {
+    size_t i;
+    size_t uPrefixLength;
+    struct Bind *current;
+    const char *pcKey;
+    char acDecoded[MAX_SPLIT_KEY];
+    assert(oSymTable != NULL);
+    assert(pcPrefix != NULL);
+    assert(pfApply != NULL);
+    uPrefixLength = strlen(pcPrefix);
+    for (i = 0; i < oSymTable->bucketCount; i++) {
+        for (current = SymTable_chain(oSymTable, i); current != NULL;
+            current = current->next) {
+            pcKey = SymTable_decode(oSymTable, current, acDecoded);
+            if (strncmp(pcKey, pcPrefix, uPrefixLength) == 0) {
+                (*pfApply)(pcKey, 
+                    (void*) current->value, (void*) pvExtra);
+            }
+        }
+    }
+}
+
+/*most threads that SymTable_buildParallel and SymTable_mapParallel 
+use*/
+enum {MAX_THREADS = 256};
+
+/* Runs (*pfWork) on uThreadCount threads, passing the i-th thread a 
+   pointer to the i-th element of size uWorkerSize of the array 
+   pvWorkers; with a uWorkerSize of 0 every thread gets pvWorkers. 
+   Waits for all of them to finish. Work that no thread can be 
+   created for is done by the calling thread. */
+static void SymTable_runWorkers(void *(*pfWork)(void *pvWorker),
+    void *pvWorkers, size_t uWorkerSize, size_t uThreadCount) {
+    size_t i;
+    pthread_t *aThreads;
+    int *aiStarted;
+    assert(pfWork != NULL);
+    assert(pvWorkers != NULL);
+    aThreads = (pthread_t*)malloc(uThreadCount * sizeof(pthread_t));
+    aiStarted = (int*)calloc(uThreadCount, sizeof(int));
+
+    /*worker 0 always runs on the calling thread*/
+    for (i = 1; i < uThreadCount; i++) {
+        if (aThreads != NULL && aiStarted != NULL &&
+            pthread_create(&aThreads[i], NULL, pfWork,
+            (char*)pvWorkers + i * uWorkerSize) == 0) {
+            aiStarted[i] = TRUE;
+        }
+    }
+    for (i = 0; i < uThreadCount; i++) {
+        if (aiStarted == NULL || !aiStarted[i]) {
+            (void)(*pfWork)((char*)pvWorkers + i * uWorkerSize);
+        }
+    }
+    for (i = 1; i < uThreadCount; i++) {
+        if (aiStarted != NULL && aiStarted[i]) {
+            (void)pthread_join(aThreads[i], NULL);
+        }
+    }
+    free(aThreads);
+    free(aiStarted);
+}
+
+/* A Builder holds the state that the threads of 
+SymTable_buildParallel share. The input is split into one slice per 
+thread, and the buckets into one contiguous range per thread, called 
+a partition, so that no two threads ever touch the same chain*/
+struct Builder {
+    /*the table being built, whose bucket array is already sized*/
+    SymTable_T oSymTable;
+    /*points to the keys and values of the bindings to add*/
+    const char *const *ppcKeys;
+    const void *const *ppvValues;
+    /*number of bindings to add*/
+    size_t uCount;
+    /*number of threads, slices and partitions*/
+    size_t uThreadCount;
+    /*number of buckets in each partition but possibly the last*/
+    size_t uPartitionSize;
+    /*hash code and length of each key*/
+    size_t *auHashes;
+    size_t *auLengths;
+    /*indices of the keys, grouped by partition, in input order 
+    within each partition*/
+    size_t *auOrder;
+    /*entry [t * uThreadCount + p] first counts the keys of slice t 
+    that fall in partition p, then holds where they go in auOrder*/
+    size_t *auSlots;
+};
+
+/* A Worker is the share of a Builder's work done by one thread*/
+struct Worker {
+    /*points to the shared state*/
+    struct Builder *psBuilder;
+    /*the slice & partition that the worker owns*/
+    size_t uIndex;
+    /*number of binds the worker added to its partition*/
+    size_t uAdded;
+    /*TRUE if the worker ran out of memory*/
+    int iFailed;
+};
+
+/* Stores in *puFirst and *puLast the bounds [*puFirst, *puLast) of 
+   the slice of uCount items that worker uIndex of uThreadCount 
+   owns. */
+static void SymTable_slice(size_t uCount, size_t uThreadCount,
+    size_t uIndex, size_t *puFirst, size_t *puLast) {
+    assert(uIndex < uThreadCount);
+    *puFirst = uCount / uThreadCount * uIndex +
+        (uIndex < uCount % uThreadCount ? uIndex : uCount % uThreadCount);
+    *puLast = *puFirst + uCount / uThreadCount +
+        (uIndex < uCount % uThreadCount ? 1 : 0);
+}
+
+/* Returns the partition of psBuilder that holds the bucket for the 
+   key with hash code uHash. */
+static size_t SymTable_partition(const struct Builder *psBuilder,
+    size_t uHash) {
+    assert(psBuilder != NULL);
+    return SymTable_index(psBuilder->oSymTable, uHash,
+        psBuilder->oSymTable->bucketCount) / psBuilder->uPartitionSize;
+}
+
+/* Hashes the keys of the slice of the worker that pvWorker points 
+   to and counts how many of them fall in each partition. */
+static void *SymTable_hashSlice(void *pvWorker) {
+    struct Worker *psWorker = (struct Worker*)pvWorker;
+    struct Builder *psBuilder;
+    size_t *auCounts;
+    size_t i;
+    size_t uFirst;
+    size_t uLast;
+    assert(psWorker != NULL);
+    psBuilder = psWorker->psBuilder;
+    auCounts = psBuilder->auSlots +
+        psWorker->uIndex * psBuilder->uThreadCount;
+    SymTable_slice(psBuilder->uCount, psBuilder->uThreadCount,
+        psWorker->uIndex, &uFirst, &uLast);
+    for (i = uFirst; i < uLast; i++) {
+        assert(psBuilder->ppcKeys[i] != NULL);
+        psBuilder->auHashes[i] = SymTable_hashString
+            (psBuilder->ppcKeys[i], &psBuilder->auLengths[i]);
+        auCounts[SymTable_partition(psBuilder,
+            psBuilder->auHashes[i])]++;
+    }
+    return NULL;
+}
+
+/* Copies the index of each key of the slice of the worker that 
+   pvWorker points to into the part of auOrder for its partition. */
+static void *SymTable_scatterSlice(void *pvWorker) {
+    struct Worker *psWorker = (struct Worker*)pvWorker;
+    struct Builder *psBuilder;
+    size_t *auSlots;
+    size_t i;
+    size_t uFirst;
+    size_t uLast;
+    assert(psWorker != NULL);
+    psBuilder = psWorker->psBuilder;
+    auSlots = psBuilder->auSlots +
+        psWorker->uIndex * psBuilder->uThreadCount;
+    SymTable_slice(psBuilder->uCount, psBuilder->uThreadCount,
+        psWorker->uIndex, &uFirst, &uLast);
+    for (i = uFirst; i < uLast; i++) {
+        psBuilder->auOrder[auSlots[SymTable_partition(psBuilder,
+            psBuilder->auHashes[i])]++] = i;
+    }
+    return NULL;
+}
+
+/* Adds the keys of the partition of the worker that pvWorker points 
+   to into that partition's buckets, keeping the first occurrence of 
+   each key. */
+static void *SymTable_buildPartition(void *pvWorker) {
+    struct Worker *psWorker = (struct Worker*)pvWorker;
+    struct Builder *psBuilder;
+    SymTable_T oSymTable;
+    size_t uFirst;
+    size_t uLast;
+    size_t i;
+    size_t j;
+    assert(psWorker != NULL);
+    psBuilder = psWorker->psBuilder;
+    oSymTable = psBuilder->oSymTable;
+
+    /*the partition's indices end where the next partition's begin,
+    which auSlots holds after the scatter*/
+    uFirst = psWorker->uIndex == 0 ? 0 : psBuilder->auSlots
+        [(psBuilder->uThreadCount - 1) * psBuilder->uThreadCount +
+        psWorker->uIndex - 1];
+    uLast = psBuilder->auSlots[(psBuilder->uThreadCount - 1) *
+        psBuilder->uThreadCount + psWorker->uIndex];
+
+    for (i = uFirst; i < uLast; i++) {
+        j = psBuilder->auOrder[i];
+        if (SymTable_find(oSymTable, psBuilder->ppcKeys[j],
+            psBuilder->auLengths[j], psBuilder->auHashes[j]) != NULL) {
+            continue;
+        }
+        if (SymTable_newBind(oSymTable, SymTable_bucket(oSymTable,
+            oSymTable->buckets, SymTable_index(oSymTable,
+            psBuilder->auHashes[j], oSymTable->bucketCount)),
+            psBuilder->ppcKeys[j], psBuilder->auLengths[j],
+            psBuilder->auHashes[j], psBuilder->ppvValues[j]) == NULL) {
+            psWorker->iFailed = TRUE;
+            return NULL;
+        }
+        psWorker->uAdded++;
+    }
+    return NULL;
+}
+
+/* Gives oSymTable, which has never held a binding, a bucket array 
+   sized for uCount binds, so that adding that many never expands it. 
+   Returns FALSE if insufficient memory is available and TRUE 
+   otherwise. */
+static int SymTable_presize(SymTable_T oSymTable, size_t uCount) {
+    size_t numBucketCounts;
+    size_t i;
+    assert(oSymTable != NULL);
+    assert(oSymTable->buckets == NULL);
+    numBucketCounts = sizeof(auBucketCounts)/sizeof(auBucketCounts[0]);
+    for (i = 0; i < numBucketCounts - 1 && auBucketCounts[i] < uCount;
+        i++);
+    oSymTable->buckets = SymTable_allocBuckets(oSymTable,
+        auBucketCounts[i]);
+    if (oSymTable->buckets == NULL) {
+        return FALSE;
+    }
+    oSymTable->bucketCount = auBucketCounts[i];
+    return TRUE;
+}
+
+SymTable_T SymTable_buildParallel(const char *const *ppcKeys,
+    const void *const *ppvValues, size_t uCount,
+    size_t uThreadCount) {
+    SymTable_T oSymTable;
+    struct Builder sBuilder;
+    struct Worker *asWorkers;
+    size_t uNext;
+    size_t uStart;
+    size_t t;
+    size_t p;
+    int iFailed;
+    assert(uCount == 0 || ppcKeys != NULL);
+    assert(uCount == 0 || ppvValues != NULL);
+
+    oSymTable = SymTable_new();
+    if (oSymTable == NULL || uCount == 0) {
+        return oSymTable;
+    }
+
+    /*sizes the bucket array for uCount binds up front, so that the
+    build never expands it*/
+    if (!SymTable_presize(oSymTable, uCount)) {
+        SymTable_free(oSymTable);
+        return NULL;
+    }
+
+    /*every thread needs a slice of the input & a range of buckets*/
+    if (uThreadCount == 0) {
+        uThreadCount = 1;
+    }
+    if (uThreadCount > MAX_THREADS) {
+        uThreadCount = MAX_THREADS;
+    }
+    if (uThreadCount > uCount) {
+        uThreadCount = uCount;
+    }
+
+    sBuilder.oSymTable = oSymTable;
+    sBuilder.ppcKeys = ppcKeys;
+    sBuilder.ppvValues = ppvValues;
+    sBuilder.uCount = uCount;
+    sBuilder.uThreadCount = uThreadCount;
+    sBuilder.uPartitionSize =
+        (oSymTable->bucketCount + uThreadCount - 1) / uThreadCount;
+    sBuilder.auHashes = (size_t*)malloc(uCount * sizeof(size_t));
+    sBuilder.auLengths = (size_t*)malloc(uCount * sizeof(size_t));
+    sBuilder.auOrder = (size_t*)malloc(uCount * sizeof(size_t));
+    sBuilder.auSlots = (size_t*)calloc(uThreadCount * uThreadCount,
+        sizeof(size_t));
+    asWorkers = (struct Worker*)calloc(uThreadCount,
+        sizeof(struct Worker));
+    iFailed = sBuilder.auHashes == NULL || sBuilder.auLengths == NULL ||
+        sBuilder.auOrder == NULL || sBuilder.auSlots == NULL ||
+        asWorkers == NULL;
+
+    if (!iFailed) {
+        for (t = 0; t < uThreadCount; t++) {
+            asWorkers[t].psBuilder = &sBuilder;
+            asWorkers[t].uIndex = t;
+        }
+
+        /*hashes every key & counts the keys per slice & partition*/
+        SymTable_runWorkers(SymTable_hashSlice, asWorkers,
+            sizeof(struct Worker), uThreadCount);
+
+        /*turns the counts into offsets in auOrder: partition by
+        partition, and slice by slice within each partition, so that
+        each partition sees its keys in input order*/
+        uNext = 0;
+        for (p = 0; p < uThreadCount; p++) {
+            for (t = 0; t < uThreadCount; t++) {
+                uStart = uNext;
+                uNext += sBuilder.auSlots[t * uThreadCount + p];
+                sBuilder.auSlots[t * uThreadCount + p] = uStart;
+            }
+        }
+
+        SymTable_runWorkers(SymTable_scatterSlice, asWorkers,
+            sizeof(struct Worker), uThreadCount);
+        SymTable_runWorkers(SymTable_buildPartition, asWorkers,
+            sizeof(struct Worker), uThreadCount);
+
+        for (t = 0; t < uThreadCount; t++) {
+            oSymTable->counter += asWorkers[t].uAdded;
+            iFailed = iFailed || asWorkers[t].iFailed;
+        }
+    }
+
+    free(sBuilder.auHashes);
+    free(sBuilder.auLengths);
+    free(sBuilder.auOrder);
+    free(sBuilder.auSlots);
+    free(asWorkers);
+
+    /*a partially built table holds only complete binds, so it can be
+    freed like any other*/
+    if (iFailed) {
+        SymTable_free(oSymTable);
+        return NULL;
+    }
+
+    /*the workers leave long chains unindexed, as building an index 
+    would race on the table's array of indexes*/
+    SymTable_buildIndexes(oSymTable);
+    return oSymTable;
+}
+
+/* Returns the text of the uLength-byte file open as iFd, mapped 
+   privately and followed by a zero byte, or NULL if it cannot be 
+   mapped. The byte comes from an anonymous mapping that the file is 
+   mapped over, since a byte past the end of a file whose length is 
+   a multiple of the page size cannot be read. */
+static char *SymTable_mapText(int iFd, size_t uLength) {
+    char *pcText;
+    assert(uLength > 0);
+    pcText = (char*)mmap(NULL, uLength + 1, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (pcText == MAP_FAILED) {
+        return NULL;
+    }
+    if (mmap(pcText, uLength, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_FIXED, iFd, 0) == MAP_FAILED) {
+        (void)munmap(pcText, uLength + 1);
+        return NULL;
+    }
+    (void)madvise(pcText, uLength, MADV_SEQUENTIAL);
+    return pcText;
+}
+
+/* Returns an estimate of the number of lines of the uLength bytes of 
+   text at pcText, from the lines among its first SAMPLE_BYTES. */
+static size_t SymTable_estimateLines(const char *pcText,
+    size_t uLength) {
+    const char *pcNext;
+    const char *pcEnd;
+    size_t uSample;
+    size_t uLines = 0;
+    assert(pcText != NULL);
+    uSample = uLength < SAMPLE_BYTES ? uLength : SAMPLE_BYTES;
+    pcEnd = pcText + uSample;
+    for (pcNext = pcText; (pcNext = memchr(pcNext, '\n',
+        (size_t)(pcEnd - pcNext))) != NULL; pcNext++) {
+        uLines++;
+    }
+    return (size_t)((double)uLength / (double)uSample *
+        (double)uLines) + 1;
+}
+
+/* Adds a binding to oSymTable for each line of the uLength bytes of 
+   text at pcText, which lies in the table's pool and is followed by 
+   a zero byte, ending each key & value in place so that the binds 
+   point into the text. Returns FALSE if the text holds a '\0' or 
+   insufficient memory is available, and TRUE otherwise. */
+static int SymTable_addLines(SymTable_T oSymTable, char *pcText,
+    size_t uLength, char cSeparator) {
+    char *pcLine;
+    char *pcNext;
+    char *pcEnd;
+    char *pcSeparator;
+    char *pcValue;
+    size_t uLineLength;
+    size_t uKeyLength;
+    int iAdded;
+    assert(oSymTable != NULL);
+    assert(pcText != NULL);
+
+    pcEnd = pcText + uLength;
+    for (pcLine = pcText; pcLine < pcEnd; pcLine = pcNext + 1) {
+        pcNext = memchr(pcLine, '\n', (size_t)(pcEnd - pcLine));
+        if (pcNext == NULL) {
+            pcNext = pcEnd;
+        }
+        uLineLength = (size_t)(pcNext - pcLine);
+        if (uLineLength > 0 && pcLine[uLineLength - 1] == '\r') {
+            uLineLength--;
+        }
+        if (uLineLength == 0) {
+            continue;
+        }
+        if (memchr(pcLine, '\0', uLineLength) != NULL) {
+            return FALSE;
+        }
+
+        /*the key ends at the separator and the value at the end of 
+        the line; without a separator both end there*/
+        pcLine[uLineLength] = '\0';
+        pcSeparator = memchr(pcLine, cSeparator, uLineLength);
+        if (pcSeparator == NULL) {
+            uKeyLength = uLineLength;
+            pcValue = pcLine + uLineLength;
+        }
+        else {
+            *pcSeparator = '\0';
+            uKeyLength = (size_t)(pcSeparator - pcLine);
+            pcValue = pcSeparator + 1;
+        }
+        if (SymTable_findOrAdd(oSymTable, pcLine, uKeyLength,
+            SymTable_sipHash(pcLine, uKeyLength), pcValue, &iAdded) ==
+            NULL) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+SymTable_T SymTable_load(const char *pcPath, char cSeparator) {
+    SymTable_T oSymTable;
+    struct stat sStat;
+    size_t uLength;
+    int iFd;
+    assert(pcPath != NULL);
+    assert(cSeparator != '\n' && cSeparator != '\r' &&
+        cSeparator != '\0');
+
+    oSymTable = SymTable_new();
+    if (oSymTable == NULL) {
+        return NULL;
+    }
+    iFd = open(pcPath, O_RDONLY);
+    if (iFd < 0) {
+        SymTable_free(oSymTable);
+        return NULL;
+    }
+    if (fstat(iFd, &sStat) != 0 || !S_ISREG(sStat.st_mode)) {
+        (void)close(iFd);
+        SymTable_free(oSymTable);
+        return NULL;
+    }
+    uLength = (size_t)sStat.st_size;
+    if (uLength == 0) {
+        (void)close(iFd);
+        return oSymTable;
+    }
+
+    /*the pool is in place before the first key is added, so that 
+    every key in it is used in place & never freed*/
+    oSymTable->pool = (struct Pool*)SymTable_alloc(oSymTable,
+        sizeof(struct Pool));
+    if (oSymTable->pool != NULL) {
+        oSymTable->pool->text = SymTable_mapText(iFd, uLength);
+        if (oSymTable->pool->text == NULL) {
+            SymTable_release(oSymTable, oSymTable->pool);
+            oSymTable->pool = NULL;
+        }
+    }
+    (void)close(iFd);
+    if (oSymTable->pool == NULL) {
+        SymTable_free(oSymTable);
+        return NULL;
+    }
+    oSymTable->pool->refCount = 1;
+    oSymTable->pool->length = uLength;
+
+    /*a table that is built without expanding rehashes no keys*/
+    if (!SymTable_presize(oSymTable, SymTable_estimateLines(
+        oSymTable->pool->text, uLength)) ||
+        !SymTable_addLines(oSymTable, oSymTable->pool->text, uLength,
+        cSeparator)) {
+        SymTable_free(oSymTable);
+        return NULL;
+    }
+    return oSymTable;
+}
+
+/*number of chunks per thread that SymTable_mapParallel aims for, and 
+fewest buckets in a chunk*/
+enum {CHUNKS_PER_THREAD = 16, MIN_CHUNK_SIZE = 64};
+
+/* A Mapper holds the state that the threads of SymTable_mapParallel 
+share. The bucket array is cut into chunks that idle threads take in 
+turn, so that a thread stuck on long chains does not hold up the 
+rest*/
+struct Mapper {
+    /*the table being walked*/
+    SymTable_T oSymTable;
+    /*the function to apply & its extra parameter*/
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra);
+    const void *pvExtra;
+    /*number of buckets in a chunk*/
+    size_t uChunkSize;
+    /*first bucket that no thread has taken yet*/
+    size_t uNextBucket;
+    /*guards uNextBucket*/
+    pthread_mutex_t lock;
+};
+
+/* Takes chunks of buckets from the Mapper that pvMapper points to 
+   until none are left, applying the Mapper's function to every bind 
+   in them. */
+static void *SymTable_mapChunks(void *pvMapper) {
+    struct Mapper *psMapper = (struct Mapper*)pvMapper;
+    struct Bind *current;
+    char acDecoded[MAX_SPLIT_KEY];
+    size_t uFirst;
+    size_t uLast;
+    size_t i;
+    assert(psMapper != NULL);
+
+    for (;;) {
+        (void)pthread_mutex_lock(&psMapper->lock);
+        uFirst = psMapper->uNextBucket;
+        psMapper->uNextBucket += psMapper->uChunkSize;
+        (void)pthread_mutex_unlock(&psMapper->lock);
+
+        if (uFirst >= psMapper->oSymTable->bucketCount) {
+            return NULL;
+        }
+        uLast = uFirst + psMapper->uChunkSize;
+        if (uLast > psMapper->oSymTable->bucketCount) {
+            uLast = psMapper->oSymTable->bucketCount;
+        }
+
+        for (i = uFirst; i < uLast; i++) {
+            for (current = SymTable_chain(psMapper->oSymTable, i);
+                current != NULL; current = current->next) {
+                (*psMapper->pfApply)(SymTable_decode(
+                    psMapper->oSymTable, current, acDecoded),
+                    (void*)current->value, (void*)psMapper->pvExtra);
+            }
+        }
+    }
+}
+
+void SymTable_mapParallel(SymTable_T oSymTable, void (*pfApply)
+    (const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra, size_t uThreadCount) {
+    struct Mapper sMapper;
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+
+    if (uThreadCount > MAX_THREADS) {
+        uThreadCount = MAX_THREADS;
+    }
+
+    /*small tables are not worth starting threads for*/
+    if (uThreadCount <= 1 ||
+        oSymTable->bucketCount < 2 * MIN_CHUNK_SIZE) {
+        SymTable_map(oSymTable, pfApply, pvExtra);
+        return;
+    }
+
+    sMapper.oSymTable = oSymTable;
+    sMapper.pfApply = pfApply;
+    sMapper.pvExtra = pvExtra;
+    sMapper.uChunkSize =
+        oSymTable->bucketCount / (uThreadCount * CHUNKS_PER_THREAD);
+    if (sMapper.uChunkSize < MIN_CHUNK_SIZE) {
+        sMapper.uChunkSize = MIN_CHUNK_SIZE;
+    }
+    sMapper.uNextBucket = 0;
+    if (pthread_mutex_init(&sMapper.lock, NULL) != 0) {
+        SymTable_map(oSymTable, pfApply, pvExtra);
+        return;
+    }
+
+    /*every thread shares the one Mapper*/
+    SymTable_runWorkers(SymTable_mapChunks, &sMapper, 0, uThreadCount);
+    (void)pthread_mutex_destroy(&sMapper.lock);
+}
@@ -7,19 +7,41 @@
 #include <assert.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stdio.h>
 
 /*defines FALSE (0) and TRUE (1)*/
 enum {FALSE, TRUE};
 
 /* A SymTable structure is a "manager" structure that points
 to the first Bind and contains a counter that maintains the number
-of binds*/
+of binds, along with the allocator that all its memory comes from.
+A table and its clones share one list until they change it. A table
+made by SymTable_load keeps the values from its file in a pool*/
 struct SymTable
 {
     /*points to the first bind*/
     struct Bind *first;
+    /*counts the tables that share the list, or is NULL while the
+    list has never been shared with a clone*/
+    size_t *shares;
     /*tracks the number of binds*/
     size_t counter;
+    /*allocates & frees memory, given pvContext*/
+    void *(*pfAlloc)(size_t uSize, void *pvContext);
+    void (*pfFree)(void *pvBlock, void *pvContext);
+    void *pvContext;
+    /*bytes in each value stored right after its bind, or 0 if the
+    binds hold pointers to values*/
+    size_t valueSize;
+    /*holds a copy of the value that the last replace or remove took
+    out of an inline table, or is NULL*/
+    void *oldValue;
+    /*points to the text of the file that the table was loaded from,
+    or is NULL*/
+    struct Pool *pool;
+    /*points to a clone taken when the open transaction began, or is
+    NULL while no transaction is open*/
+    struct SymTable *snapshot;
 };
 
 /* A value and unique key is stored in a bind. Binds are linked
@@ -28,18 +50,109 @@ struct Bind
 {
     /*points to a string that represents the key*/
     char *key;
-    /*points to a value*/
+    /*length of the key, so that most mismatches are rejected
+    without comparing any characters*/
+    size_t keyLength;
+    /*points to a value, which in an inline table is the storage
+    right after the bind*/
     const void *value;
     /*points to the next bind in the linked list*/
     struct Bind *next;
 };
 
-SymTable_T SymTable_new(void)
+/* A Pool holds the text of a file that SymTable_load read, which the
+values of its lines point into. The text follows the header in the
+same block, with its lines ended in place. A table and its clones
+share the pool, so it is freed by the last of them to be freed*/
+struct Pool
+{
+    /*number of tables that read the pool*/
+    size_t refCount;
+};
+
+/* Returns uSize bytes from malloc. pvContext is unused. */
+static void *SymTable_defaultAlloc(size_t uSize, void *pvContext)
+{
+    (void)pvContext;
+    return malloc(uSize);
+}
+
+/* Returns pvBlock to free. pvContext is unused. */
+static void SymTable_defaultFree(void *pvBlock, void *pvContext)
+{
+    (void)pvContext;
+    free(pvBlock);
+}
+
+/* Returns uSize bytes from the allocator of oSymTable, or NULL if
+   insufficient memory is available. */
+static void *SymTable_alloc(SymTable_T oSymTable, size_t uSize)
+{
+    assert(oSymTable != NULL);
+    return (*oSymTable->pfAlloc)(uSize, oSymTable->pvContext);
+}
+
+/* Returns pvBlock to the allocator of oSymTable. */
+static void SymTable_release(SymTable_T oSymTable, void *pvBlock)
+{
+    assert(oSymTable != NULL);
+    (*oSymTable->pfFree)(pvBlock, oSymTable->pvContext);
+}
+
+/* Stores pvValue as the value of bind of oSymTable. An inline table
+   copies the value into the storage after the bind, or zeroes that
+   storage if pvValue is NULL. */
+static void SymTable_setValue(SymTable_T oSymTable, struct Bind *bind,
+                              const void *pvValue)
+{
+    assert(oSymTable != NULL);
+    assert(bind != NULL);
+    if (oSymTable->valueSize == 0)
+    {
+        bind->value = pvValue;
+    }
+    else if (pvValue == NULL)
+    {
+        memset((void *)bind->value, 0, oSymTable->valueSize);
+    }
+    else
+    {
+        memcpy((void *)bind->value, pvValue, oSymTable->valueSize);
+    }
+}
+
+/* Returns the value of bind of oSymTable as a replace or remove
+   hands it back: the pointer itself, or in an inline table a copy
+   in the table's old value. */
+static void *SymTable_saveValue(SymTable_T oSymTable,
+                                const struct Bind *bind)
+{
+    assert(oSymTable != NULL);
+    assert(bind != NULL);
+    if (oSymTable->valueSize == 0)
+    {
+        return (void *)bind->value;
+    }
+    memcpy(oSymTable->oldValue, bind->value, oSymTable->valueSize);
+    return oSymTable->oldValue;
+}
+
+/* Returns a new SymTable with no bindings whose memory comes from
+   pfAlloc & pfFree with pvContext, and that stores values of
+   uValueSize bytes in its binds, or pointers to values if uValueSize
+   is 0. Returns NULL if insufficient memory is available. */
+static SymTable_T SymTable_create(
+    void *(*pfAlloc)(size_t uSize, void *pvContext),
+    void (*pfFree)(void *pvBlock, void *pvContext), void *pvContext,
+    size_t uValueSize)
 {
     SymTable_T oSymTable;
+    assert(pfAlloc != NULL);
+    assert(pfFree != NULL);
 
     /*allocates memory for a new SymTable*/
-    oSymTable = (SymTable_T)malloc(sizeof(struct SymTable));
+    oSymTable = (SymTable_T)(*pfAlloc)(sizeof(struct SymTable),
+                                       pvContext);
     if (oSymTable == NULL)
     {
         return NULL;
@@ -47,27 +160,226 @@ SymTable_T SymTable_new(void)
 
     /*Sets the first bind to NULL and counter to 0*/
     oSymTable->first = NULL;
+    oSymTable->shares = NULL;
+    oSymTable->pool = NULL;
+    oSymTable->snapshot = NULL;
     oSymTable->counter = 0;
+    oSymTable->pfAlloc = pfAlloc;
+    oSymTable->pfFree = pfFree;
+    oSymTable->pvContext = pvContext;
+    oSymTable->valueSize = uValueSize;
+    oSymTable->oldValue = NULL;
+    if (uValueSize > 0)
+    {
+        oSymTable->oldValue = (*pfAlloc)(uValueSize, pvContext);
+        if (oSymTable->oldValue == NULL)
+        {
+            (*pfFree)(oSymTable, pvContext);
+            return NULL;
+        }
+    }
     return oSymTable;
 }
 
-void SymTable_free(SymTable_T oSymTable)
+SymTable_T SymTable_new(void)
+{
+    return SymTable_create(SymTable_defaultAlloc, SymTable_defaultFree,
+                           NULL, 0);
+}
+
+SymTable_T SymTable_newWithAllocator(
+    void *(*pfAlloc)(size_t uSize, void *pvContext),
+    void (*pfFree)(void *pvBlock, void *pvContext), void *pvContext)
+{
+    return SymTable_create(pfAlloc, pfFree, pvContext, 0);
+}
+
+SymTable_T SymTable_newInline(size_t uValueSize)
+{
+    assert(uValueSize > 0);
+    return SymTable_create(SymTable_defaultAlloc, SymTable_defaultFree,
+                           NULL, uValueSize);
+}
+
+/* A list has nowhere to share key prefixes, so a compact table is an
+   ordinary one. */
+SymTable_T SymTable_newCompact(void)
+{
+    return SymTable_new();
+}
+
+/* A list is searched key by key, which a filter would not save, so it
+   goes without one. */
+int SymTable_addFilter(SymTable_T oSymTable)
+{
+    assert(oSymTable != NULL);
+    return TRUE;
+}
+
+/* Frees the binds of the list that starts at first, which belongs to
+   oSymTable, and their keys. */
+static void SymTable_freeList(SymTable_T oSymTable, struct Bind *first)
 {
     struct Bind *bind;
     struct Bind *next;
     assert(oSymTable != NULL);
 
-    for (bind = oSymTable->first; bind != NULL; bind = next)
+    for (bind = first; bind != NULL; bind = next)
     {
         /* sets next to the bind's next target */
         next = bind->next;
 
         /*frees the keys & values */
-        free(bind->key);
-        free(bind);
+        SymTable_release(oSymTable, bind->key);
+        SymTable_release(oSymTable, bind);
+    }
+}
+
+/* Lets go of the list of oSymTable, freeing it unless a clone still
+   shares it. */
+static void SymTable_dropList(SymTable_T oSymTable)
+{
+    assert(oSymTable != NULL);
+    if (oSymTable->shares != NULL)
+    {
+        (*oSymTable->shares)--;
+        if (*oSymTable->shares > 0)
+        {
+            oSymTable->shares = NULL;
+            return;
+        }
+        SymTable_release(oSymTable, oSymTable->shares);
+        oSymTable->shares = NULL;
+    }
+    SymTable_freeList(oSymTable, oSymTable->first);
+}
+
+/* Makes the list of oSymTable the table's own, copying it with its
+   keys if a clone still shares it, so that it can be changed.
+   Returns FALSE and leaves oSymTable unchanged if insufficient
+   memory is available, and TRUE otherwise. Binds found before the
+   call may belong to the clone afterwards. */
+static int SymTable_own(SymTable_T oSymTable)
+{
+    struct Bind *first;
+    struct Bind **link;
+    struct Bind *bind;
+    struct Bind *copy;
+    char *key;
+    assert(oSymTable != NULL);
+
+    if (oSymTable->shares == NULL)
+    {
+        return TRUE;
+    }
+    if (*oSymTable->shares == 1)
+    {
+        SymTable_release(oSymTable, oSymTable->shares);
+        oSymTable->shares = NULL;
+        return TRUE;
+    }
+
+    /*copies the binds in order, each one whole before it is linked*/
+    first = NULL;
+    link = &first;
+    for (bind = oSymTable->first; bind != NULL; bind = bind->next)
+    {
+        key = SymTable_alloc(oSymTable, bind->keyLength + 1);
+        copy = (struct Bind *)SymTable_alloc(oSymTable,
+                                             sizeof(struct Bind) +
+                                                 oSymTable->valueSize);
+        if (key == NULL || copy == NULL)
+        {
+            if (key != NULL)
+            {
+                SymTable_release(oSymTable, key);
+            }
+            if (copy != NULL)
+            {
+                SymTable_release(oSymTable, copy);
+            }
+            SymTable_freeList(oSymTable, first);
+            return FALSE;
+        }
+        memcpy(key, bind->key, bind->keyLength + 1);
+        memcpy(copy, bind, sizeof(struct Bind) + oSymTable->valueSize);
+        copy->key = key;
+        if (oSymTable->valueSize != 0)
+        {
+            copy->value = copy + 1;
+        }
+        copy->next = NULL;
+        *link = copy;
+        link = &copy->next;
+    }
+    SymTable_dropList(oSymTable);
+    oSymTable->first = first;
+    return TRUE;
+}
+
+void SymTable_free(SymTable_T oSymTable)
+{
+    assert(oSymTable != NULL);
+    if (oSymTable->snapshot != NULL)
+    {
+        SymTable_free(oSymTable->snapshot);
     }
+    SymTable_dropList(oSymTable);
+    if (oSymTable->pool != NULL)
+    {
+        oSymTable->pool->refCount--;
+        if (oSymTable->pool->refCount == 0)
+        {
+            SymTable_release(oSymTable, oSymTable->pool);
+        }
+    }
+
     /*frees the overall SymTable after values are freed */
-    free(oSymTable);
+    SymTable_release(oSymTable, oSymTable->oldValue);
+    SymTable_release(oSymTable, oSymTable);
+}
+
+SymTable_T SymTable_clone(SymTable_T oSymTable)
+{
+    SymTable_T copy;
+    assert(oSymTable != NULL);
+    assert(oSymTable->snapshot == NULL);
+
+    copy = SymTable_create(oSymTable->pfAlloc, oSymTable->pfFree,
+                           oSymTable->pvContext, oSymTable->valueSize);
+    if (copy == NULL)
+    {
+        return NULL;
+    }
+
+    /*values in the pool must outlive the table, even if it is empty*/
+    copy->pool = oSymTable->pool;
+    if (copy->pool != NULL)
+    {
+        copy->pool->refCount++;
+    }
+    if (oSymTable->first == NULL)
+    {
+        return copy;
+    }
+
+    /*the clone reads the same list until either table changes it*/
+    if (oSymTable->shares == NULL)
+    {
+        oSymTable->shares = (size_t *)SymTable_alloc(oSymTable,
+                                                     sizeof(size_t));
+        if (oSymTable->shares == NULL)
+        {
+            SymTable_free(copy);
+            return NULL;
+        }
+        *oSymTable->shares = 1;
+    }
+    copy->first = oSymTable->first;
+    copy->counter = oSymTable->counter;
+    copy->shares = oSymTable->shares;
+    (*copy->shares)++;
+    return copy;
 }
 
 size_t SymTable_getLength(SymTable_T oSymTable)
@@ -76,150 +388,388 @@ size_t SymTable_getLength(SymTable_T oSymTable)
     return oSymTable->counter;
 }
 
-int SymTable_put(SymTable_T oSymTable,
-                 const char *pcKey, const void *pvValue)
+/* Returns the bind of oSymTable whose key is the uLength characters
+   at pcKey, or NULL if there is no such bind. */
+static struct Bind *SymTable_find(SymTable_T oSymTable,
+                                  const char *pcKey, size_t uLength)
+{
+    struct Bind *tmp;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    for (tmp = oSymTable->first; tmp != NULL; tmp = tmp->next)
+    {
+        if (tmp->keyLength == uLength &&
+            memcmp(tmp->key, pcKey, uLength) == 0)
+        {
+            return tmp;
+        }
+    }
+    return NULL;
+}
+
+/* Returns bind, the bind of oSymTable whose key is the uLength
+   characters at pcKey, or the table's own copy of it if it was shared
+   with a clone, ready to be changed. Returns NULL if insufficient
+   memory is available. */
+static struct Bind *SymTable_ownBind(SymTable_T oSymTable,
+                                     struct Bind *bind,
+                                     const char *pcKey, size_t uLength)
+{
+    assert(oSymTable != NULL);
+    assert(bind != NULL);
+    if (oSymTable->shares == NULL)
+    {
+        return bind;
+    }
+    if (!SymTable_own(oSymTable))
+    {
+        return NULL;
+    }
+    return SymTable_find(oSymTable, pcKey, uLength);
+}
+
+/* Returns the bind of oSymTable whose key is the uLength characters
+   at pcKey. If there is no such bind, first adds one whose value is
+   pvValue. Sets *piAdded to TRUE if the bind was added and FALSE
+   otherwise. Returns NULL and leaves oSymTable unchanged if
+   insufficient memory is available. */
+static struct Bind *SymTable_findOrAdd(SymTable_T oSymTable,
+                                       const char *pcKey, size_t uLength,
+                                       const void *pvValue, int *piAdded)
 {
     struct Bind *newBind;
     char *copy;
     assert(oSymTable != NULL);
     assert(pcKey != NULL);
+    assert(piAdded != NULL);
+    *piAdded = FALSE;
 
     /* first checks if pcKey exists already in SymTable*/
-    if (SymTable_contains(oSymTable, pcKey))
+    newBind = SymTable_find(oSymTable, pcKey, uLength);
+    if (newBind != NULL)
     {
-        return FALSE;
+        return newBind;
+    }
+    if (!SymTable_own(oSymTable))
+    {
+        return NULL;
     }
 
     /*Makes a Defensive Copy of the string that pcKey points to &
     stores the address of that copy in a new binding*/
-    copy = malloc(strlen(pcKey) + 1);
+    copy = SymTable_alloc(oSymTable, uLength + 1);
     if (copy == NULL)
     {
-        return FALSE;
+        return NULL;
     }
-    strcpy(copy, pcKey);
+    memcpy(copy, pcKey, uLength);
+    copy[uLength] = '\0';
 
-    /*allocates memory for the newBind*/
-    newBind = (struct Bind *)malloc(sizeof(struct Bind));
+    /*allocates memory for the newBind, with room for an inline value
+    right after it*/
+    newBind = (struct Bind *)SymTable_alloc(oSymTable,
+                                            sizeof(struct Bind) +
+                                                oSymTable->valueSize);
     if (newBind == NULL)
     {
-        free(copy);
-        return FALSE;
+        SymTable_release(oSymTable, copy);
+        return NULL;
     }
 
     /*assigns key and value*/
     newBind->key = (char *)copy;
-    newBind->value = (void *)pvValue;
+    newBind->keyLength = uLength;
+    newBind->value = newBind + 1;
+    SymTable_setValue(oSymTable, newBind, pvValue);
 
     /*inputs the newBind at the beginning of the SymTable*/
     newBind->next = oSymTable->first;
     oSymTable->first = newBind;
     oSymTable->counter++;
-    return TRUE;
+    *piAdded = TRUE;
+    return newBind;
+}
+
+/* Adds a binding whose key is the uLength characters at pcKey and
+   whose value is pvValue to oSymTable and returns TRUE, or returns
+   FALSE and leaves oSymTable unchanged if the key is already bound
+   or if insufficient memory is available. */
+static int SymTable_insert(SymTable_T oSymTable, const char *pcKey,
+                           size_t uLength, const void *pvValue)
+{
+    int iAdded;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    (void)SymTable_findOrAdd(oSymTable, pcKey, uLength, pvValue,
+                             &iAdded);
+    return iAdded;
+}
+
+int SymTable_put(SymTable_T oSymTable,
+                 const char *pcKey, const void *pvValue)
+{
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    return SymTable_insert(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+int SymTable_putN(SymTable_T oSymTable, const char *pcKey,
+                  size_t uLength, const void *pvValue)
+{
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    assert(memchr(pcKey, '\0', uLength) == NULL);
+    return SymTable_insert(oSymTable, pcKey, uLength, pvValue);
 }
 
 void *SymTable_replace(SymTable_T oSymTable,
                        const char *pcKey, const void *pvValue)
+{
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    return SymTable_replaceN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+void *SymTable_replaceN(SymTable_T oSymTable, const char *pcKey,
+                        size_t uLength, const void *pvValue)
 {
     struct Bind *tmp;
     void *val;
     assert(oSymTable != NULL);
     assert(pcKey != NULL);
-    val = NULL;
 
     /* checks if oSymTable contains the key */
-    if (SymTable_contains(oSymTable, pcKey) != 1)
+    tmp = SymTable_find(oSymTable, pcKey, uLength);
+    if (tmp == NULL)
     {
         return NULL;
     }
-
-    /* replaces the value with a given value */
-    for (tmp = oSymTable->first; tmp != NULL; tmp = tmp->next)
+    tmp = SymTable_ownBind(oSymTable, tmp, pcKey, uLength);
+    if (tmp == NULL)
     {
-        if (strcmp(tmp->key, pcKey) == 0)
-        {
-            val = (void *)(tmp->value);
-            tmp->value = pvValue;
-        }
+        return NULL;
     }
+
+    /* replaces the value with a given value */
+    val = SymTable_saveValue(oSymTable, tmp);
+    SymTable_setValue(oSymTable, tmp, pvValue);
     return val;
 }
 
 int SymTable_contains(SymTable_T oSymTable, const char *pcKey)
 {
-    struct Bind *tmp;
     assert(oSymTable != NULL);
     assert(pcKey != NULL);
-    for (tmp = oSymTable->first; tmp != NULL; tmp = tmp->next)
-    {
-        if (strcmp(tmp->key, pcKey) == 0)
-        {
-            return TRUE;
-        }
-    }
-    return FALSE;
+    return SymTable_find(oSymTable, pcKey, strlen(pcKey)) != NULL;
+}
+
+int SymTable_containsN(SymTable_T oSymTable, const char *pcKey,
+                       size_t uLength)
+{
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    assert(memchr(pcKey, '\0', uLength) == NULL);
+    return SymTable_find(oSymTable, pcKey, uLength) != NULL;
 }
 
 void *SymTable_get(SymTable_T oSymTable, const char *pcKey)
+{
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    return SymTable_getN(oSymTable, pcKey, strlen(pcKey));
+}
+
+void *SymTable_getN(SymTable_T oSymTable, const char *pcKey,
+                    size_t uLength)
 {
     struct Bind *tmp;
     assert(oSymTable != NULL);
     assert(pcKey != NULL);
-    if (SymTable_contains(oSymTable, pcKey))
+
+    /* gets the value */
+    tmp = SymTable_find(oSymTable, pcKey, uLength);
+    if (tmp == NULL)
     {
+        return NULL;
+    }
+    return (void *)(tmp->value);
+}
+
+void *SymTable_getFirst(SymTable_T *poSymTables, size_t uCount,
+                        const char *pcKey, size_t *puWhich)
+{
+    struct Bind *tmp;
+    size_t uLength;
+    size_t i;
+    assert(poSymTables != NULL || uCount == 0);
+    assert(pcKey != NULL);
 
-        /* gets the value */
-        for (tmp = oSymTable->first; tmp != NULL; tmp = tmp->next)
+    /* the key is measured once for all the tables */
+    uLength = strlen(pcKey);
+    for (i = 0; i < uCount; i++)
+    {
+        tmp = SymTable_find(poSymTables[i], pcKey, uLength);
+        if (tmp != NULL)
         {
-            if (strcmp(tmp->key, pcKey) == 0)
+            if (puWhich != NULL)
             {
-                return (void *)(tmp->value);
+                *puWhich = i;
             }
+            return (void*)tmp->value;
         }
     }
+    if (puWhich != NULL)
+    {
+        *puWhich = uCount;
+    }
     return NULL;
 }
 
 void *SymTable_remove(SymTable_T oSymTable, const char *pcKey)
+{
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    return SymTable_removeN(oSymTable, pcKey, strlen(pcKey));
+}
+
+void *SymTable_removeN(SymTable_T oSymTable, const char *pcKey,
+                       size_t uLength)
 {
     struct Bind *tmp;
     struct Bind *before;
     void *val;
     assert(oSymTable != NULL);
     assert(pcKey != NULL);
-
-    val = NULL;
     before = NULL;
 
-    /* checks if oSymTable contains the key */
-    if (SymTable_contains(oSymTable, pcKey))
+    /* loops to the first instance of the key, remembering the bind
+    before it */
+    for (tmp = oSymTable->first; tmp != NULL; before = tmp, tmp = tmp->next)
     {
-        /* loops to the first instace of pcKey, compares it */
-        for (tmp = oSymTable->first; tmp != NULL &&
-                                     strcmp(tmp->key, pcKey);
-             before = tmp, tmp = tmp->next);
-
-        /*handles first key case*/
-        if (before == NULL)
+        if (tmp->keyLength == uLength &&
+            memcmp(tmp->key, pcKey, uLength) == 0)
         {
-            val = (void *)tmp->value;
-            oSymTable->first = tmp->next;
+            break;
         }
+    }
+    if (tmp == NULL)
+    {
+        return NULL;
+    }
 
-        /*handles other key cases*/
-        else
+    /*a list shared with a clone is copied, and the bind found again*/
+    if (oSymTable->shares != NULL)
+    {
+        if (!SymTable_own(oSymTable))
         {
-            val = (void *)tmp->value;
-            before->next = tmp->next;
+            return NULL;
         }
+        return SymTable_removeN(oSymTable, pcKey, uLength);
+    }
+
+    /*handles first key case*/
+    if (before == NULL)
+    {
+        oSymTable->first = tmp->next;
+    }
 
-        /* frees the key, tmp, decrements counter, returns val*/
-        free(tmp->key);
-        free(tmp);
-        oSymTable->counter--;
-        return val;
+    /*handles other key cases*/
+    else
+    {
+        before->next = tmp->next;
     }
-    return NULL;
+
+    /* frees the key, tmp, decrements counter, returns val*/
+    val = SymTable_saveValue(oSymTable, tmp);
+    SymTable_release(oSymTable, tmp->key);
+    SymTable_release(oSymTable, tmp);
+    oSymTable->counter--;
+    return val;
+}
+
+/* A transaction keeps a clone of the table as it was when the
+   transaction began, which costs little since the two share their
+   memory until the table changes; rolling back swaps it in. */
+int SymTable_beginTxn(SymTable_T oSymTable)
+{
+    assert(oSymTable != NULL);
+    assert(oSymTable->snapshot == NULL);
+    oSymTable->snapshot = SymTable_clone(oSymTable);
+    return oSymTable->snapshot != NULL;
+}
+
+void SymTable_commit(SymTable_T oSymTable)
+{
+    assert(oSymTable != NULL);
+    assert(oSymTable->snapshot != NULL);
+    SymTable_free(oSymTable->snapshot);
+    oSymTable->snapshot = NULL;
+}
+
+void SymTable_rollback(SymTable_T oSymTable)
+{
+    struct SymTable changed;
+    SymTable_T snapshot;
+    assert(oSymTable != NULL);
+    assert(oSymTable->snapshot != NULL);
+
+    /*the table takes the snapshot's contents, and the snapshot the
+    changed ones, which are freed with it*/
+    snapshot = oSymTable->snapshot;
+    changed = *oSymTable;
+    *oSymTable = *snapshot;
+    *snapshot = changed;
+    snapshot->snapshot = NULL;
+    SymTable_free(snapshot);
+}
+
+/* A list has no resizes or chains to profile, so nothing is kept. */
+void SymTable_dumpProfile(FILE *psFile)
+{
+    assert(psFile != NULL);
+    fprintf(psFile,
+        "SymTable profile not kept by this implementation\n");
+}
+
+int SymTable_upsert(SymTable_T oSymTable,
+                    const char *pcKey, const void *pvValue)
+{
+    struct Bind *tmp;
+    int iAdded;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    tmp = SymTable_findOrAdd(oSymTable, pcKey, strlen(pcKey), pvValue,
+                             &iAdded);
+    if (tmp != NULL && !iAdded)
+    {
+        tmp = SymTable_ownBind(oSymTable, tmp, pcKey, strlen(pcKey));
+    }
+    if (tmp == NULL)
+    {
+        return FALSE;
+    }
+    SymTable_setValue(oSymTable, tmp, pvValue);
+    return TRUE;
+}
+
+void **SymTable_getOrInsert(SymTable_T oSymTable,
+                            const char *pcKey, const void *pvValue)
+{
+    struct Bind *tmp;
+    int iAdded;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    tmp = SymTable_findOrAdd(oSymTable, pcKey, strlen(pcKey), pvValue,
+                             &iAdded);
+    if (tmp != NULL && !iAdded)
+    {
+        tmp = SymTable_ownBind(oSymTable, tmp, pcKey, strlen(pcKey));
+    }
+    if (tmp == NULL)
+    {
+        return NULL;
+    }
+    return (void **)&tmp->value;
 }
 
 void SymTable_map(SymTable_T oSymTable,
@@ -235,4 +785,261 @@ void SymTable_map(SymTable_T oSymTable,
         (*pfApply)((void *)current->key,
                    (void *)current->value, (void *)pvExtra);
     }
-}
\ No newline at end of file
+}
+/* Returns TRUE if pcKey lies in the half-open range [pcLo, pcHi),
+   where a NULL bound is unbounded, and FALSE otherwise. */
+static int SymTable_inRange(const char *pcKey, const char *pcLo,
+                            const char *pcHi)
+{
+    assert(pcKey != NULL);
+    if (pcLo != NULL && strcmp(pcKey, pcLo) < 0)
+    {
+        return FALSE;
+    }
+    if (pcHi != NULL && strcmp(pcKey, pcHi) >= 0)
+    {
+        return FALSE;
+    }
+    return TRUE;
+}
+
+void SymTable_rangeMap(SymTable_T oSymTable, const char *pcLo,
+                       const char *pcHi,
+                       void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+                       const void *pvExtra)
+{
+    struct Bind *current;
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+
+    /* the list keeps no order, so every bind is filtered */
+    for (current = oSymTable->first; current != NULL;
+         current = current->next)
+    {
+        if (SymTable_inRange(current->key, pcLo, pcHi))
+        {
+            (*pfApply)((void *)current->key,
+                       (void *)current->value, (void *)pvExtra);
+        }
+    }
+}
+
+void SymTable_prefixMap(SymTable_T oSymTable, const char *pcPrefix,
+                        void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+                        const void *pvExtra)
+{
+    struct Bind *current;
+    size_t uPrefixLength;
+    assert(oSymTable != NULL);
+    assert(pcPrefix != NULL);
+    assert(pfApply != NULL);
+    uPrefixLength = strlen(pcPrefix);
+    for (current = oSymTable->first; current != NULL;
+         current = current->next)
+    {
+        if (strncmp(current->key, pcPrefix, uPrefixLength) == 0)
+        {
+            (*pfApply)((void *)current->key,
+                       (void *)current->value, (void *)pvExtra);
+        }
+    }
+}
+
+size_t SymTable_hashKey(const char *pcKey)
+{
+    assert(pcKey != NULL);
+    return SymTable_hashKeyN(pcKey, strlen(pcKey));
+}
+
+size_t SymTable_hashKeyN(const char *pcKey, size_t uLength)
+{
+    const size_t HASH_MULTIPLIER = 65599;
+    size_t u;
+    size_t uHash = 0;
+    assert(pcKey != NULL);
+    for (u = 0; u < uLength; u++)
+        uHash = uHash * HASH_MULTIPLIER + (size_t)pcKey[u];
+    return uHash;
+}
+
+/* the list does not use hash codes, so the WithHash functions only
+   check them */
+
+int SymTable_putWithHash(SymTable_T oSymTable,
+                         const char *pcKey, size_t uHash,
+                         const void *pvValue)
+{
+    assert(uHash == SymTable_hashKey(pcKey));
+    (void)uHash;
+    return SymTable_put(oSymTable, pcKey, pvValue);
+}
+
+int SymTable_containsWithHash(SymTable_T oSymTable,
+                              const char *pcKey, size_t uHash)
+{
+    assert(uHash == SymTable_hashKey(pcKey));
+    (void)uHash;
+    return SymTable_contains(oSymTable, pcKey);
+}
+
+void *SymTable_getWithHash(SymTable_T oSymTable,
+                           const char *pcKey, size_t uHash)
+{
+    assert(uHash == SymTable_hashKey(pcKey));
+    (void)uHash;
+    return SymTable_get(oSymTable, pcKey);
+}
+
+SymTable_T SymTable_buildParallel(const char *const *ppcKeys,
+                                  const void *const *ppvValues,
+                                  size_t uCount, size_t uThreadCount)
+{
+    SymTable_T oSymTable;
+    size_t i;
+    assert(uCount == 0 || ppcKeys != NULL);
+    assert(uCount == 0 || ppvValues != NULL);
+
+    /* a list cannot be split between threads, so it is built by the
+    calling thread alone */
+    (void)uThreadCount;
+    oSymTable = SymTable_new();
+    if (oSymTable == NULL)
+    {
+        return NULL;
+    }
+    for (i = 0; i < uCount; i++)
+    {
+        assert(ppcKeys[i] != NULL);
+        if (!SymTable_put(oSymTable, ppcKeys[i], ppvValues[i]) &&
+            !SymTable_contains(oSymTable, ppcKeys[i]))
+        {
+            SymTable_free(oSymTable);
+            return NULL;
+        }
+    }
+    return oSymTable;
+}
+
+/* Adds a binding to oSymTable for each line of the uLength bytes of
+   text at pcText, which is followed by a zero byte, ending each key &
+   value in place. Returns FALSE if the text holds a '\0' or
+   insufficient memory is available, and TRUE otherwise. */
+static int SymTable_addLines(SymTable_T oSymTable, char *pcText,
+                             size_t uLength, char cSeparator)
+{
+    char *pcLine;
+    char *pcNext;
+    char *pcEnd;
+    char *pcSeparator;
+    char *pcValue;
+    size_t uLineLength;
+    assert(oSymTable != NULL);
+    assert(pcText != NULL);
+
+    pcEnd = pcText + uLength;
+    for (pcLine = pcText; pcLine < pcEnd; pcLine = pcNext + 1)
+    {
+        pcNext = memchr(pcLine, '\n', (size_t)(pcEnd - pcLine));
+        if (pcNext == NULL)
+        {
+            pcNext = pcEnd;
+        }
+        uLineLength = (size_t)(pcNext - pcLine);
+        if (uLineLength > 0 && pcLine[uLineLength - 1] == '\r')
+        {
+            uLineLength--;
+        }
+        if (uLineLength == 0)
+        {
+            continue;
+        }
+        if (memchr(pcLine, '\0', uLineLength) != NULL)
+        {
+            return FALSE;
+        }
+
+        /*the key ends at the separator and the value at the end of
+        the line; without a separator both end there*/
+        pcLine[uLineLength] = '\0';
+        pcSeparator = memchr(pcLine, cSeparator, uLineLength);
+        pcValue = pcLine + uLineLength;
+        if (pcSeparator != NULL)
+        {
+            *pcSeparator = '\0';
+            pcValue = pcSeparator + 1;
+        }
+        if (!SymTable_put(oSymTable, pcLine, pcValue) &&
+            !SymTable_contains(oSymTable, pcLine))
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+SymTable_T SymTable_load(const char *pcPath, char cSeparator)
+{
+    SymTable_T oSymTable;
+    FILE *psFile;
+    char *pcText;
+    long lLength;
+    assert(pcPath != NULL);
+    assert(cSeparator != '\n' && cSeparator != '\r' &&
+           cSeparator != '\0');
+
+    oSymTable = SymTable_new();
+    if (oSymTable == NULL)
+    {
+        return NULL;
+    }
+    psFile = fopen(pcPath, "rb");
+    if (psFile == NULL)
+    {
+        SymTable_free(oSymTable);
+        return NULL;
+    }
+
+    /* the whole file is read into the pool, followed by a zero byte
+    that ends a last line without a newline */
+    lLength = -1;
+    if (fseek(psFile, 0, SEEK_END) == 0)
+    {
+        lLength = ftell(psFile);
+    }
+    if (lLength >= 0 && fseek(psFile, 0, SEEK_SET) == 0)
+    {
+        oSymTable->pool = (struct Pool *)SymTable_alloc(
+            oSymTable, sizeof(struct Pool) + (size_t)lLength + 1);
+    }
+    if (oSymTable->pool != NULL)
+    {
+        oSymTable->pool->refCount = 1;
+        pcText = (char *)(oSymTable->pool + 1);
+        pcText[lLength] = '\0';
+        if (fread(pcText, 1, (size_t)lLength, psFile) != (size_t)lLength ||
+            !SymTable_addLines(oSymTable, pcText, (size_t)lLength,
+                               cSeparator))
+        {
+            (void)fclose(psFile);
+            SymTable_free(oSymTable);
+            return NULL;
+        }
+    }
+    (void)fclose(psFile);
+    if (oSymTable->pool == NULL)
+    {
+        SymTable_free(oSymTable);
+        return NULL;
+    }
+    return oSymTable;
+}
+
+void SymTable_mapParallel(SymTable_T oSymTable,
+                          void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+                          const void *pvExtra, size_t uThreadCount)
+{
+    /* a list can only be walked from its first bind, so it is walked
+    by the calling thread alone */
+    (void)uThreadCount;
+    SymTable_map(oSymTable, pfApply, pvExtra);
+}
@@ -0,0 +1,275 @@
+/*-------------------------------------------------------------------*/
+/* symtabletyped.h                                                   */
+/* Author: Arnold Jiang                                              */
+/*-------------------------------------------------------------------*/
+
+#ifndef SYMTABLETYPED_INCLUDED
+#define SYMTABLETYPED_INCLUDED
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* SYMTABLE_DEFINE(name, KeyT, ValueT, hashFn, eqFn) defines a table
+type name_T whose bindings each hold a key of type KeyT and a value
+of type ValueT, both stored in the table itself, along with static
+inline functions name_new, name_free, name_getLength, name_put,
+name_get, name_contains, name_remove and name_map that work like
+their SymTable counterparts. hashFn(key) must return the same size_t
+for keys that eqFn(key1, key2) calls equal, and eqFn must return
+nonzero for equal keys and 0 otherwise. Both may be functions or
+macros, and are expanded where the table's functions are, so a
+compiler can inline them into the caller's loops, which calls
+through a SymTable_T cannot do. The macro is used once per table
+type, at file scope.
+
+The table keeps its bindings in one array of slots, found by linear
+probing from the slot that a key's hash code picks, and doubles the
+array before it is more than seven eighths full. The table copies
+keys & values by assignment: a key that is a pointer, such as a
+string, must stay valid while it is bound.
+
+    name_T name_new(void)
+        returns a new table with no bindings, or NULL if insufficient
+        memory is available.
+    void name_free(name_T oTable)
+        frees all memory occupied by oTable.
+    size_t name_getLength(name_T oTable)
+        returns the number of bindings in oTable.
+    int name_put(name_T oTable, KeyT key, ValueT value)
+        adds a binding of key to value and returns 1 (TRUE) if oTable
+        does not bind key, and otherwise leaves oTable unchanged and
+        returns 0 (FALSE). Also returns 0 (FALSE) if insufficient
+        memory is available.
+    ValueT *name_get(name_T oTable, KeyT key)
+        returns a pointer to the value that oTable binds key to, or
+        NULL if it binds none. The value may be changed through the
+        pointer, which stays valid until the next name_put or
+        name_remove.
+    int name_contains(name_T oTable, KeyT key)
+        returns 1 (TRUE) if oTable binds key, and 0 (FALSE) otherwise.
+    int name_remove(name_T oTable, KeyT key, ValueT *pValue)
+        removes the binding of key from oTable, stores its value in
+        *pValue unless pValue is NULL, and returns 1 (TRUE), or leaves
+        oTable unchanged and returns 0 (FALSE) if it binds no key.
+    void name_map(name_T oTable, void (*pfApply)(KeyT key,
+        ValueT *pValue, void *pvExtra), const void *pvExtra)
+        calls (*pfApply)(key, pValue, pvExtra) for each binding in
+        oTable, in no particular order. *pfApply may change the value
+        but must not add or remove bindings. */
+#define SYMTABLE_DEFINE(name, KeyT, ValueT, hashFn, eqFn)             \
+                                                                      \
+/*a slot whose hash is 0 holds no binding, so the hash codes that    \
+the table stores are never 0*/                                        \
+struct name##Slot {                                                   \
+    size_t hash;                                                      \
+    KeyT key;                                                         \
+    ValueT value;                                                     \
+};                                                                    \
+                                                                      \
+/*the slots, allocated by the first put, and one less than their     \
+count, which is a power of two*/                                      \
+struct name {                                                         \
+    struct name##Slot *slots;                                         \
+    size_t mask;                                                      \
+    size_t count;                                                     \
+};                                                                    \
+                                                                      \
+typedef struct name *name##_T;                                        \
+                                                                      \
+static inline size_t name##_hash(KeyT key) {                          \
+    size_t uHash;                                                     \
+    uHash = (size_t)(hashFn(key));                                    \
+    return uHash == 0 ? 1 : uHash;                                    \
+}                                                                     \
+                                                                      \
+static inline name##_T name##_new(void) {                             \
+    name##_T oTable;                                                  \
+    oTable = (name##_T)malloc(sizeof(struct name));                   \
+    if (oTable == NULL) {                                             \
+        return NULL;                                                  \
+    }                                                                 \
+    oTable->slots = NULL;                                             \
+    oTable->mask = 0;                                                 \
+    oTable->count = 0;                                                \
+    return oTable;                                                    \
+}                                                                     \
+                                                                      \
+static inline void name##_free(name##_T oTable) {                     \
+    free(oTable->slots);                                              \
+    free(oTable);                                                     \
+}                                                                     \
+                                                                      \
+static inline size_t name##_getLength(name##_T oTable) {              \
+    return oTable->count;                                             \
+}                                                                     \
+                                                                      \
+/*returns the slot that binds key, whose hash code is uHash, or NULL*/\
+static inline struct name##Slot *name##_find(name##_T oTable,         \
+    KeyT key, size_t uHash) {                                         \
+    size_t i;                                                         \
+    if (oTable->slots == NULL) {                                      \
+        return NULL;                                                  \
+    }                                                                 \
+    for (i = uHash & oTable->mask; oTable->slots[i].hash != 0;        \
+        i = (i + 1) & oTable->mask) {                                 \
+        if (oTable->slots[i].hash == uHash &&                         \
+            (eqFn(oTable->slots[i].key, key))) {                      \
+            return &oTable->slots[i];                                 \
+        }                                                             \
+    }                                                                 \
+    return NULL;                                                      \
+}                                                                     \
+                                                                      \
+/*returns the first empty slot on the probe path of uHash*/           \
+static inline struct name##Slot *name##_vacancy(name##_T oTable,      \
+    size_t uHash) {                                                   \
+    size_t i;                                                         \
+    for (i = uHash & oTable->mask; oTable->slots[i].hash != 0;        \
+        i = (i + 1) & oTable->mask);                                  \
+    return &oTable->slots[i];                                         \
+}                                                                     \
+                                                                      \
+/*doubles the slots, or returns 0 (FALSE) if there is no memory*/     \
+static inline int name##_grow(name##_T oTable) {                      \
+    struct name##Slot *old;                                           \
+    size_t uOldCount;                                                 \
+    size_t uCount;                                                    \
+    size_t i;                                                         \
+    old = oTable->slots;                                              \
+    uOldCount = old == NULL ? 0 : oTable->mask + 1;                   \
+    uCount = old == NULL ? 8 : 2 * uOldCount;                         \
+    oTable->slots = (struct name##Slot*)calloc(uCount,                \
+        sizeof(struct name##Slot));                                   \
+    if (oTable->slots == NULL) {                                      \
+        oTable->slots = old;                                          \
+        return 0;                                                     \
+    }                                                                 \
+    oTable->mask = uCount - 1;                                        \
+    for (i = 0; i < uOldCount; i++) {                                 \
+        if (old[i].hash != 0) {                                       \
+            *name##_vacancy(oTable, old[i].hash) = old[i];            \
+        }                                                             \
+    }                                                                 \
+    free(old);                                                        \
+    return 1;                                                         \
+}                                                                     \
+                                                                      \
+static inline int name##_put(name##_T oTable, KeyT key,               \
+    ValueT value) {                                                   \
+    struct name##Slot *slot;                                          \
+    size_t uHash;                                                     \
+    uHash = name##_hash(key);                                         \
+    if (name##_find(oTable, key, uHash) != NULL) {                    \
+        return 0;                                                     \
+    }                                                                 \
+    if ((oTable->slots == NULL ||                                     \
+        8 * (oTable->count + 1) > 7 * (oTable->mask + 1)) &&          \
+        !name##_grow(oTable)) {                                       \
+        return 0;                                                     \
+    }                                                                 \
+    slot = name##_vacancy(oTable, uHash);                             \
+    slot->hash = uHash;                                               \
+    slot->key = key;                                                  \
+    slot->value = value;                                              \
+    oTable->count++;                                                  \
+    return 1;                                                         \
+}                                                                     \
+                                                                      \
+static inline ValueT *name##_get(name##_T oTable, KeyT key) {         \
+    struct name##Slot *slot;                                          \
+    slot = name##_find(oTable, key, name##_hash(key));                \
+    return slot == NULL ? NULL : &slot->value;                        \
+}                                                                     \
+                                                                      \
+static inline int name##_contains(name##_T oTable, KeyT key) {        \
+    return name##_find(oTable, key, name##_hash(key)) != NULL;        \
+}                                                                     \
+                                                                      \
+/*empties the slot, moving back each later slot of the run after it  \
+that its probe path reaches it through, so that no lookup meets a    \
+gap before its key*/                                                  \
+static inline int name##_remove(name##_T oTable, KeyT key,            \
+    ValueT *pValue) {                                                 \
+    struct name##Slot *slot;                                          \
+    size_t i;                                                         \
+    size_t j;                                                         \
+    slot = name##_find(oTable, key, name##_hash(key));                \
+    if (slot == NULL) {                                               \
+        return 0;                                                     \
+    }                                                                 \
+    if (pValue != NULL) {                                             \
+        *pValue = slot->value;                                        \
+    }                                                                 \
+    i = (size_t)(slot - oTable->slots);                               \
+    for (j = (i + 1) & oTable->mask; oTable->slots[j].hash != 0;      \
+        j = (j + 1) & oTable->mask) {                                 \
+        if (((j - oTable->slots[j].hash) & oTable->mask) >=           \
+            ((j - i) & oTable->mask)) {                               \
+            oTable->slots[i] = oTable->slots[j];                      \
+            i = j;                                                    \
+        }                                                             \
+    }                                                                 \
+    oTable->slots[i].hash = 0;                                        \
+    oTable->count--;                                                  \
+    return 1;                                                         \
+}                                                                     \
+                                                                      \
+static inline void name##_map(name##_T oTable, void (*pfApply)        \
+    (KeyT key, ValueT *pValue, void *pvExtra), const void *pvExtra) { \
+    size_t i;                                                         \
+    if (oTable->slots == NULL) {                                      \
+        return;                                                       \
+    }                                                                 \
+    for (i = 0; i <= oTable->mask; i++) {                             \
+        if (oTable->slots[i].hash != 0) {                             \
+            (*pfApply)(oTable->slots[i].key, &oTable->slots[i].value, \
+                (void*)pvExtra);                                      \
+        }                                                             \
+    }                                                                 \
+}                                                                     \
+                                                                      \
+typedef int name##_Defined
+
+/* Returns a hash code for the integer uKey, such as an interned ID,
+   whose every bit depends on every bit of uKey, so that keys that
+   differ only in their high bits, or are multiples of a power of
+   two, still spread over the slots. */
+static inline size_t SymTable_hashInteger(uint64_t uKey) {
+    uKey ^= uKey >> 30;
+    uKey *= UINT64_C(0xBF58476D1CE4E5B9);
+    uKey ^= uKey >> 27;
+    uKey *= UINT64_C(0x94D049BB133111EB);
+    uKey ^= uKey >> 31;
+    return (size_t)uKey;
+}
+
+/* Returns 1 (TRUE) if uKey1 and uKey2 are equal, and 0 (FALSE)
+   otherwise. */
+static inline int SymTable_equalIntegers(uint64_t uKey1,
+    uint64_t uKey2) {
+    return uKey1 == uKey2;
+}
+
+/* Returns a hash code for the string pcKey, by FNV-1a. Unlike
+   SymTable_hashKey it is not keyed with a secret, so it is only for
+   keys that no one can choose in order to make them collide; a table
+   of keys from untrusted input should use SymTable_hashKey. */
+static inline size_t SymTable_hashText(const char *pcKey) {
+    uint64_t uHash;
+    uHash = UINT64_C(0xCBF29CE484222325);
+    for (; *pcKey != '\0'; pcKey++) {
+        uHash = (uHash ^ (unsigned char)*pcKey) *
+            UINT64_C(0x100000001B3);
+    }
+    return SymTable_hashInteger(uHash);
+}
+
+/* Returns 1 (TRUE) if the strings pcKey1 and pcKey2 are equal, and 0
+   (FALSE) otherwise. */
+static inline int SymTable_equalText(const char *pcKey1,
+    const char *pcKey2) {
+    return strcmp(pcKey1, pcKey2) == 0;
+}
+
+#endif
@@ -0,0 +1,403 @@
+/*--------------------------------------------------------------------*/
+/* testdurabletable.c                                                 */
+/* Author: Arnold Jiang                                               */
+/*--------------------------------------------------------------------*/
+
+/* fork() and waitpid() are POSIX */
+#define _POSIX_C_SOURCE 200112L
+
+#include "durabletable.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+/*--------------------------------------------------------------------*/
+
+#define ASSURE(i) assure(i, __LINE__)
+
+/* The tests keep their table in PATH.log and PATH.snapshot in the
+   current directory, and remove both when they are done. */
+
+#define PATH "testdurabletable.tmp"
+
+/*--------------------------------------------------------------------*/
+
+/* If !iSuccessful, print a message to stdout indicating that the
+   test at line iLineNum failed. */
+
+static void assure(int iSuccessful, int iLineNum)
+{
+   if (! iSuccessful)
+   {
+      printf("Test at line %d failed.\n", iLineNum);
+      fflush(stdout);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Remove the files of the table kept under PATH. */
+
+static void removeFiles(void)
+{
+   (void)remove(PATH ".log");
+   (void)remove(PATH ".snapshot");
+   (void)remove(PATH ".snapshot.tmp");
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the size of the file pcPath in bytes, or -1 if there is no
+   such file. */
+
+static long fileSize(const char *pcPath)
+{
+   struct stat sStat;
+
+   if (stat(pcPath, &sStat) != 0)
+      return -1;
+   return (long)sStat.st_size;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the long value of the binding with key pcKey in
+   oDurableTable, or -1 if there is no such binding. */
+
+static long getLong(DurableTable_T oDurableTable, const char *pcKey)
+{
+   long *plValue;
+
+   plValue = (long*)DurableTable_get(oDurableTable, pcKey);
+   if (plValue == NULL)
+      return -1;
+   return *plValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add the long value of the binding to the long that pvExtra points
+   to. pcKey is unused. */
+
+static void sumValues(const char *pcKey, void *pvValue, void *pvExtra)
+{
+   assert(pcKey != NULL);
+   assert(pvValue != NULL);
+   assert(pvExtra != NULL);
+
+   *(long*)pvExtra += *(long*)pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test that puts, replaces and removes survive closing and opening
+   the table again. */
+
+static void testReopen(void)
+{
+   DurableTable_T oDurableTable;
+   long lValue;
+   long *plValue;
+   long lSum;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing that changes survive reopening the table.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   removeFiles();
+   oDurableTable = DurableTable_open(PATH, sizeof(long));
+   ASSURE(oDurableTable != NULL);
+   ASSURE(DurableTable_getLength(oDurableTable) == 0);
+
+   lValue = 2;
+   ASSURE(DurableTable_put(oDurableTable, "Jeter", &lValue));
+   lValue = 3;
+   ASSURE(DurableTable_put(oDurableTable, "Ruth", &lValue));
+   ASSURE(! DurableTable_put(oDurableTable, "Ruth", &lValue));
+   lValue = 4;
+   ASSURE(DurableTable_put(oDurableTable, "Gehrig", &lValue));
+   ASSURE(DurableTable_put(oDurableTable, "", NULL));
+   lValue = 33;
+   plValue = (long*)DurableTable_replace(oDurableTable, "Ruth", &lValue);
+   ASSURE(plValue != NULL && *plValue == 3);
+   ASSURE(DurableTable_replace(oDurableTable, "Mantle", &lValue)
+      == NULL);
+   plValue = (long*)DurableTable_remove(oDurableTable, "Gehrig");
+   ASSURE(plValue != NULL && *plValue == 4);
+   ASSURE(DurableTable_remove(oDurableTable, "Gehrig") == NULL);
+   ASSURE(DurableTable_close(oDurableTable));
+
+   oDurableTable = DurableTable_open(PATH, sizeof(long));
+   ASSURE(oDurableTable != NULL);
+   ASSURE(DurableTable_getLength(oDurableTable) == 3);
+   ASSURE(getLong(oDurableTable, "Jeter") == 2);
+   ASSURE(getLong(oDurableTable, "Ruth") == 33);
+   ASSURE(getLong(oDurableTable, "") == 0);
+   ASSURE(! DurableTable_contains(oDurableTable, "Gehrig"));
+   lSum = 0;
+   DurableTable_map(oDurableTable, sumValues, &lSum);
+   ASSURE(lSum == 35);
+
+   /* Removing a key and adding it back must replay in order. */
+   ASSURE(DurableTable_remove(oDurableTable, "Jeter") != NULL);
+   lValue = 22;
+   ASSURE(DurableTable_put(oDurableTable, "Jeter", &lValue));
+   ASSURE(DurableTable_close(oDurableTable));
+
+   oDurableTable = DurableTable_open(PATH, sizeof(long));
+   ASSURE(oDurableTable != NULL);
+   ASSURE(DurableTable_getLength(oDurableTable) == 3);
+   ASSURE(getLong(oDurableTable, "Jeter") == 22);
+   ASSURE(DurableTable_close(oDurableTable));
+
+   /* The files hold longs, so they are not a table of ints. */
+   ASSURE(DurableTable_open(PATH, sizeof(long) + 1) == NULL);
+
+   removeFiles();
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test that a process that dies without closing its table loses only
+   the changes it made after its last sync, and that the changes in
+   the log come back whole and in order, whatever point the process
+   died at. iKeyCount keys are put in all. */
+
+static void testCrash(int iKeyCount)
+{
+   DurableTable_T oDurableTable;
+   char acKey[32];
+   pid_t iPid;
+   int iStatus;
+   long lValue;
+   int iSurvivors;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a process that dies without closing its table.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   removeFiles();
+   iPid = fork();
+   ASSURE(iPid >= 0);
+   if (iPid == 0)
+   {
+      oDurableTable = DurableTable_open(PATH, sizeof(long));
+      if (oDurableTable == NULL)
+         _exit(EXIT_FAILURE);
+      lValue = 1;
+      (void)DurableTable_put(oDurableTable, "synced", &lValue);
+      if (! DurableTable_sync(oDurableTable))
+         _exit(EXIT_FAILURE);
+      (void)DurableTable_remove(oDurableTable, "synced");
+      for (i = 0; i < iKeyCount; i++)
+      {
+         sprintf(acKey, "key%d", i);
+         lValue = i;
+         (void)DurableTable_put(oDurableTable, acKey, &lValue);
+      }
+      _exit(EXIT_SUCCESS);
+   }
+   ASSURE(waitpid(iPid, &iStatus, 0) == iPid);
+   ASSURE(WIFEXITED(iStatus) && WEXITSTATUS(iStatus) == EXIT_SUCCESS);
+
+   /* Whatever groups were written hold a prefix of the changes. */
+   oDurableTable = DurableTable_open(PATH, sizeof(long));
+   ASSURE(oDurableTable != NULL);
+   if (oDurableTable == NULL)
+      return;
+   iSurvivors = (int)DurableTable_getLength(oDurableTable);
+   if (DurableTable_contains(oDurableTable, "synced"))
+   {
+      ASSURE(iSurvivors == 1);
+      iSurvivors = 0;
+   }
+   for (i = 0; i < iKeyCount; i++)
+   {
+      sprintf(acKey, "key%d", i);
+      ASSURE(getLong(oDurableTable, acKey) == (i < iSurvivors ? i : -1));
+   }
+   ASSURE(DurableTable_close(oDurableTable));
+   removeFiles();
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test that a record cut short or damaged at the end of the log is
+   dropped, and that the changes made after it are kept. */
+
+static void testTornTail(void)
+{
+   DurableTable_T oDurableTable;
+   FILE *psFile;
+   long lValue;
+   long lGoodSize;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a log whose last record was cut short.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   removeFiles();
+   oDurableTable = DurableTable_open(PATH, sizeof(long));
+   ASSURE(oDurableTable != NULL);
+   lValue = 1;
+   ASSURE(DurableTable_put(oDurableTable, "first", &lValue));
+   ASSURE(DurableTable_sync(oDurableTable));
+   lGoodSize = fileSize(PATH ".log");
+   lValue = 2;
+   ASSURE(DurableTable_put(oDurableTable, "second", &lValue));
+   ASSURE(DurableTable_close(oDurableTable));
+
+   /* Damage one byte of the value of the second record. */
+   psFile = fopen(PATH ".log", "r+b");
+   ASSURE(psFile != NULL);
+   ASSURE(fseek(psFile, lGoodSize + 8, SEEK_SET) == 0);
+   ASSURE(putc('x', psFile) != EOF);
+   ASSURE(fclose(psFile) == 0);
+
+   oDurableTable = DurableTable_open(PATH, sizeof(long));
+   ASSURE(oDurableTable != NULL);
+   ASSURE(DurableTable_getLength(oDurableTable) == 1);
+   ASSURE(getLong(oDurableTable, "first") == 1);
+   ASSURE(fileSize(PATH ".log") == lGoodSize);
+   ASSURE(DurableTable_close(oDurableTable));
+
+   /* Append half of a record, as a crash in a write would. */
+   psFile = fopen(PATH ".log", "ab");
+   ASSURE(psFile != NULL);
+   ASSURE(fwrite("S\005thi", 1, 5, psFile) == 5);
+   ASSURE(fclose(psFile) == 0);
+
+   oDurableTable = DurableTable_open(PATH, sizeof(long));
+   ASSURE(oDurableTable != NULL);
+   ASSURE(DurableTable_getLength(oDurableTable) == 1);
+   lValue = 3;
+   ASSURE(DurableTable_put(oDurableTable, "third", &lValue));
+   ASSURE(DurableTable_close(oDurableTable));
+
+   oDurableTable = DurableTable_open(PATH, sizeof(long));
+   ASSURE(oDurableTable != NULL);
+   ASSURE(DurableTable_getLength(oDurableTable) == 2);
+   ASSURE(getLong(oDurableTable, "third") == 3);
+   ASSURE(DurableTable_close(oDurableTable));
+
+   /* A log that does not start with the header is not a log. */
+   psFile = fopen(PATH ".log", "r+b");
+   ASSURE(psFile != NULL);
+   ASSURE(putc('x', psFile) != EOF);
+   ASSURE(fclose(psFile) == 0);
+   ASSURE(DurableTable_open(PATH, sizeof(long)) == NULL);
+
+   removeFiles();
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test that a checkpoint empties the log, and that the snapshot and
+   the changes logged after it together hold the table. iKeyCount
+   keys are put. */
+
+static void testCheckpoint(int iKeyCount)
+{
+   DurableTable_T oDurableTable;
+   char acKey[32];
+   long lEmptySize;
+   long lValue;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing checkpoints.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   removeFiles();
+   oDurableTable = DurableTable_open(PATH, sizeof(long));
+   ASSURE(oDurableTable != NULL);
+   lEmptySize = fileSize(PATH ".log");
+   for (i = 0; i < iKeyCount; i++)
+   {
+      sprintf(acKey, "key%d", i);
+      lValue = i;
+      ASSURE(DurableTable_put(oDurableTable, acKey, &lValue));
+   }
+   ASSURE(DurableTable_checkpoint(oDurableTable));
+   ASSURE(fileSize(PATH ".log") == lEmptySize);
+   ASSURE(fileSize(PATH ".snapshot") > lEmptySize);
+   ASSURE(fileSize(PATH ".snapshot.tmp") == -1);
+
+   /* Change every other key after the checkpoint. */
+   for (i = 0; i < iKeyCount; i += 2)
+   {
+      sprintf(acKey, "key%d", i);
+      if (i % 4 == 0)
+         ASSURE(DurableTable_remove(oDurableTable, acKey) != NULL);
+      else
+      {
+         lValue = -i;
+         ASSURE(DurableTable_replace(oDurableTable, acKey, &lValue)
+            != NULL);
+      }
+   }
+   ASSURE(DurableTable_close(oDurableTable));
+
+   oDurableTable = DurableTable_open(PATH, sizeof(long));
+   ASSURE(oDurableTable != NULL);
+   if (oDurableTable == NULL)
+      return;
+   ASSURE(DurableTable_getLength(oDurableTable)
+      == (size_t)(iKeyCount - (iKeyCount + 3) / 4));
+   for (i = 0; i < iKeyCount; i++)
+   {
+      sprintf(acKey, "key%d", i);
+      if (i % 4 == 0)
+         ASSURE(getLong(oDurableTable, acKey) == -1);
+      else if (i % 2 == 0)
+         ASSURE(getLong(oDurableTable, acKey) == -i);
+      else
+         ASSURE(getLong(oDurableTable, acKey) == i);
+   }
+
+   /* A second checkpoint replaces the first. */
+   ASSURE(DurableTable_checkpoint(oDurableTable));
+   ASSURE(DurableTable_close(oDurableTable));
+   oDurableTable = DurableTable_open(PATH, sizeof(long));
+   ASSURE(oDurableTable != NULL);
+   ASSURE(DurableTable_getLength(oDurableTable)
+      == (size_t)(iKeyCount - (iKeyCount + 3) / 4));
+   ASSURE(DurableTable_close(oDurableTable));
+
+   removeFiles();
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the DurableTable ADT.  Write the output of the tests to stdout.
+   argv[1], if present, is the number of keys the larger tests put. */
+
+int main(int argc, char *argv[])
+{
+   int iKeyCount = 20000;
+
+   if (argc == 2 && sscanf(argv[1], "%d", &iKeyCount) != 1)
+   {
+      fprintf(stderr, "key count must be numeric\n");
+      exit(EXIT_FAILURE);
+   }
+
+   testReopen();
+   testCrash(iKeyCount);
+   testTornTail();
+   testCheckpoint(iKeyCount);
+
+   printf("------------------------------------------------------\n");
+   printf("End of %s.\n", argv[0]);
+   return 0;
+}
@@ -0,0 +1,171 @@
+/*--------------------------------------------------------------------*/
+/* testscopetable.c                                                   */
+/* Author: Arnold Jiang                                               */
+/*--------------------------------------------------------------------*/
+
+#include "scopetable.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+/*--------------------------------------------------------------------*/
+
+#define ASSURE(i) assure(i, __LINE__)
+
+/*--------------------------------------------------------------------*/
+
+/* If !iSuccessful, print a message to stdout indicating that the
+   test at line iLineNum failed. */
+
+static void assure(int iSuccessful, int iLineNum)
+{
+   if (! iSuccessful)
+   {
+      printf("Test at line %d failed.\n", iLineNum);
+      fflush(stdout);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test binding, shadowing, and uncovering keys across scopes. */
+
+static void testShadowing(void)
+{
+   ScopeTable_T oScopeTable;
+   char acGlobal[] = "global";
+   char acLocal[] = "local";
+   char acInner[] = "inner";
+   char *pcValue;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing shadowing across nested scopes.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oScopeTable = ScopeTable_new();
+   ASSURE(oScopeTable != NULL);
+   ASSURE(ScopeTable_getDepth(oScopeTable) == 0);
+
+   iSuccessful = ScopeTable_bind(oScopeTable, "x", acGlobal);
+   ASSURE(iSuccessful);
+   iSuccessful = ScopeTable_bind(oScopeTable, "x", acLocal);
+   ASSURE(! iSuccessful);
+
+   iSuccessful = ScopeTable_enterScope(oScopeTable);
+   ASSURE(iSuccessful);
+   ASSURE(ScopeTable_getDepth(oScopeTable) == 1);
+
+   pcValue = (char*)ScopeTable_lookup(oScopeTable, "x");
+   ASSURE(pcValue == acGlobal);
+
+   iSuccessful = ScopeTable_bind(oScopeTable, "x", acLocal);
+   ASSURE(iSuccessful);
+   iSuccessful = ScopeTable_bind(oScopeTable, "y", acLocal);
+   ASSURE(iSuccessful);
+
+   pcValue = (char*)ScopeTable_lookup(oScopeTable, "x");
+   ASSURE(pcValue == acLocal);
+
+   iSuccessful = ScopeTable_enterScope(oScopeTable);
+   ASSURE(iSuccessful);
+   iSuccessful = ScopeTable_bind(oScopeTable, "x", acInner);
+   ASSURE(iSuccessful);
+
+   pcValue = (char*)ScopeTable_lookup(oScopeTable, "x");
+   ASSURE(pcValue == acInner);
+   pcValue = (char*)ScopeTable_lookup(oScopeTable, "y");
+   ASSURE(pcValue == acLocal);
+
+   ScopeTable_exitScope(oScopeTable);
+   pcValue = (char*)ScopeTable_lookup(oScopeTable, "x");
+   ASSURE(pcValue == acLocal);
+
+   ScopeTable_exitScope(oScopeTable);
+   ASSURE(ScopeTable_getDepth(oScopeTable) == 0);
+   pcValue = (char*)ScopeTable_lookup(oScopeTable, "x");
+   ASSURE(pcValue == acGlobal);
+   ASSURE(! ScopeTable_contains(oScopeTable, "y"));
+   pcValue = (char*)ScopeTable_lookup(oScopeTable, "y");
+   ASSURE(pcValue == NULL);
+
+   /* Leave bindings in open scopes for ScopeTable_free(). */
+   iSuccessful = ScopeTable_enterScope(oScopeTable);
+   ASSURE(iSuccessful);
+   iSuccessful = ScopeTable_bind(oScopeTable, "x", acInner);
+   ASSURE(iSuccessful);
+
+   ScopeTable_free(oScopeTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test a ScopeTable object with iDepth nested scopes that each bind
+   the same key and a key of their own. */
+
+static void testDeepNesting(int iDepth)
+{
+   enum {MAX_KEY_LENGTH = 16};
+
+   ScopeTable_T oScopeTable;
+   char acKey[MAX_KEY_LENGTH];
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing deeply nested scopes.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oScopeTable = ScopeTable_new();
+   ASSURE(oScopeTable != NULL);
+
+   for (i = 1; i <= iDepth; i++)
+   {
+      iSuccessful = ScopeTable_enterScope(oScopeTable);
+      ASSURE(iSuccessful);
+      iSuccessful = ScopeTable_bind(oScopeTable, "shared", &acKey[0]);
+      ASSURE(iSuccessful);
+      sprintf(acKey, "k%d", i);
+      iSuccessful = ScopeTable_bind(oScopeTable, acKey, NULL);
+      ASSURE(iSuccessful);
+   }
+   ASSURE(ScopeTable_getDepth(oScopeTable) == (size_t)iDepth);
+
+   for (i = iDepth; i >= 1; i--)
+   {
+      sprintf(acKey, "k%d", i);
+      ASSURE(ScopeTable_contains(oScopeTable, acKey));
+      ASSURE(ScopeTable_contains(oScopeTable, "shared"));
+      ScopeTable_exitScope(oScopeTable);
+      ASSURE(! ScopeTable_contains(oScopeTable, acKey));
+   }
+   ASSURE(! ScopeTable_contains(oScopeTable, "shared"));
+
+   ScopeTable_free(oScopeTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the ScopeTable ADT.  Write the output of the tests to stdout.
+   argv[1], if present, is the number of nested scopes to use. */
+
+int main(int argc, char *argv[])
+{
+   int iDepth = 1000;
+
+   if (argc == 2 && sscanf(argv[1], "%d", &iDepth) != 1)
+   {
+      fprintf(stderr, "depth must be numeric\n");
+      exit(EXIT_FAILURE);
+   }
+
+   testShadowing();
+   testDeepNesting(iDepth);
+
+   printf("------------------------------------------------------\n");
+   printf("End of %s.\n", argv[0]);
+   return 0;
+}
@@ -0,0 +1,254 @@
+/*--------------------------------------------------------------------*/
+/* testshardtable.c                                                   */
+/* Author: Arnold Jiang                                               */
+/*--------------------------------------------------------------------*/
+
+#include "shardtable.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+
+/*--------------------------------------------------------------------*/
+
+#define ASSURE(i) assure(i, __LINE__)
+
+/*--------------------------------------------------------------------*/
+
+/* If !iSuccessful, print a message to stdout indicating that the
+   test at line iLineNum failed. */
+
+static void assure(int iSuccessful, int iLineNum)
+{
+   if (! iSuccessful)
+   {
+      printf("Test at line %d failed.\n", iLineNum);
+      fflush(stdout);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Increment the size_t that pvExtra points to. pcKey and pvValue
+   are unused. */
+
+static void countBinding(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   assert(pcKey != NULL);
+   assert(pvExtra != NULL);
+   (void)pvValue;
+
+   (*(size_t*)pvExtra)++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the ShardTable functions from a single thread. */
+
+static void testBasics(void)
+{
+   ShardTable_T oShardTable;
+   char acJeter[] = "Jeter";
+   char acRuth[] = "Ruth";
+   char acGehrig[] = "Gehrig";
+   char *pcValue;
+   size_t uCount;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the ShardTable functions from one thread.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oShardTable = ShardTable_new(5);
+   ASSURE(oShardTable != NULL);
+   ASSURE(ShardTable_getLength(oShardTable) == 0);
+
+   iSuccessful = ShardTable_put(oShardTable, "Jeter", acJeter);
+   ASSURE(iSuccessful);
+   iSuccessful = ShardTable_put(oShardTable, "Ruth", acRuth);
+   ASSURE(iSuccessful);
+   iSuccessful = ShardTable_put(oShardTable, "Ruth", acGehrig);
+   ASSURE(! iSuccessful);
+   iSuccessful = ShardTable_put(oShardTable, "", acGehrig);
+   ASSURE(iSuccessful);
+   ASSURE(ShardTable_getLength(oShardTable) == 3);
+
+   ASSURE(ShardTable_contains(oShardTable, "Jeter"));
+   ASSURE(ShardTable_contains(oShardTable, ""));
+   ASSURE(! ShardTable_contains(oShardTable, "Gehrig"));
+
+   pcValue = (char*)ShardTable_get(oShardTable, "Ruth");
+   ASSURE(pcValue == acRuth);
+   pcValue = (char*)ShardTable_get(oShardTable, "Gehrig");
+   ASSURE(pcValue == NULL);
+
+   pcValue = (char*)ShardTable_replace(oShardTable, "Ruth", acGehrig);
+   ASSURE(pcValue == acRuth);
+   pcValue = (char*)ShardTable_get(oShardTable, "Ruth");
+   ASSURE(pcValue == acGehrig);
+   pcValue = (char*)ShardTable_replace(oShardTable, "Gehrig", acRuth);
+   ASSURE(pcValue == NULL);
+
+   uCount = 0;
+   ShardTable_map(oShardTable, countBinding, &uCount);
+   ASSURE(uCount == 3);
+
+   pcValue = (char*)ShardTable_remove(oShardTable, "Jeter");
+   ASSURE(pcValue == acJeter);
+   pcValue = (char*)ShardTable_remove(oShardTable, "Jeter");
+   ASSURE(pcValue == NULL);
+   ASSURE(ShardTable_getLength(oShardTable) == 2);
+
+   ShardTable_free(oShardTable);
+
+   /* A single shard and an oversized request must both work. */
+   oShardTable = ShardTable_new(0);
+   ASSURE(oShardTable != NULL);
+   iSuccessful = ShardTable_put(oShardTable, "Jeter", acJeter);
+   ASSURE(iSuccessful);
+   ASSURE(ShardTable_get(oShardTable, "Jeter") == acJeter);
+   ShardTable_free(oShardTable);
+
+   oShardTable = ShardTable_new(100000);
+   ASSURE(oShardTable != NULL);
+   iSuccessful = ShardTable_put(oShardTable, "Jeter", acJeter);
+   ASSURE(iSuccessful);
+   ASSURE(ShardTable_get(oShardTable, "Jeter") == acJeter);
+   ShardTable_free(oShardTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* A Writer is one thread of testConcurrentPuts(). */
+
+struct Writer
+{
+   /* The table that every thread writes to. */
+   ShardTable_T oShardTable;
+
+   /* The number of this thread. */
+   int iWriter;
+
+   /* The number of keys this thread puts. */
+   int iKeyCount;
+
+   /* The number of puts that failed. */
+   int iFailures;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Put the keys of the Writer that pvWriter points to, and then put
+   them again, which must fail. Return NULL. */
+
+static void *putKeys(void *pvWriter)
+{
+   enum {MAX_KEY_LENGTH = 24};
+
+   struct Writer *psWriter = (struct Writer*)pvWriter;
+   char acKey[MAX_KEY_LENGTH];
+   int i;
+
+   for (i = 0; i < psWriter->iKeyCount; i++)
+   {
+      sprintf(acKey, "%d.%d", psWriter->iWriter, i);
+      if (! ShardTable_put(psWriter->oShardTable, acKey, psWriter))
+         psWriter->iFailures++;
+   }
+   for (i = 0; i < psWriter->iKeyCount; i++)
+   {
+      sprintf(acKey, "%d.%d", psWriter->iWriter, i);
+      if (ShardTable_put(psWriter->oShardTable, acKey, NULL))
+         psWriter->iFailures++;
+   }
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test iWriterCount threads that each put iKeyCount keys of their
+   own into one ShardTable at the same time. */
+
+static void testConcurrentPuts(int iWriterCount, int iKeyCount)
+{
+   enum {MAX_WRITERS = 16, MAX_KEY_LENGTH = 24};
+
+   ShardTable_T oShardTable;
+   struct Writer asWriters[MAX_WRITERS];
+   pthread_t aThreads[MAX_WRITERS];
+   int aiStarted[MAX_WRITERS];
+   char acKey[MAX_KEY_LENGTH];
+   size_t uCount;
+   int i;
+   int j;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing concurrent puts into one ShardTable.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   if (iWriterCount > MAX_WRITERS)
+      iWriterCount = MAX_WRITERS;
+
+   oShardTable = ShardTable_new(16);
+   ASSURE(oShardTable != NULL);
+
+   for (i = 0; i < iWriterCount; i++)
+   {
+      asWriters[i].oShardTable = oShardTable;
+      asWriters[i].iWriter = i;
+      asWriters[i].iKeyCount = iKeyCount;
+      asWriters[i].iFailures = 0;
+      aiStarted[i] =
+         pthread_create(&aThreads[i], NULL, putKeys, &asWriters[i]) == 0;
+      if (! aiStarted[i])
+         (void)putKeys(&asWriters[i]);
+   }
+   for (i = 0; i < iWriterCount; i++)
+   {
+      if (aiStarted[i])
+         (void)pthread_join(aThreads[i], NULL);
+      ASSURE(asWriters[i].iFailures == 0);
+   }
+
+   ASSURE(ShardTable_getLength(oShardTable)
+      == (size_t)iWriterCount * (size_t)iKeyCount);
+   uCount = 0;
+   ShardTable_map(oShardTable, countBinding, &uCount);
+   ASSURE(uCount == (size_t)iWriterCount * (size_t)iKeyCount);
+
+   for (i = 0; i < iWriterCount; i++)
+      for (j = 0; j < iKeyCount; j++)
+      {
+         sprintf(acKey, "%d.%d", i, j);
+         ASSURE(ShardTable_get(oShardTable, acKey) == &asWriters[i]);
+      }
+
+   ShardTable_free(oShardTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the ShardTable ADT.  Write the output of the tests to stdout.
+   argv[1], if present, is the number of keys each thread puts. */
+
+int main(int argc, char *argv[])
+{
+   int iKeyCount = 20000;
+
+   if (argc == 2 && sscanf(argv[1], "%d", &iKeyCount) != 1)
+   {
+      fprintf(stderr, "key count must be numeric\n");
+      exit(EXIT_FAILURE);
+   }
+
+   testBasics();
+   testConcurrentPuts(8, iKeyCount);
+
+   printf("------------------------------------------------------\n");
+   printf("End of %s.\n", argv[0]);
+   return 0;
+}
@@ -269,163 +269,1931 @@ static void testKeyComparison(void)
 
 /*--------------------------------------------------------------------*/
 
-/* Test handling of key ownership. */
+/* Test the SymTable_hashKey() function and the functions that take
+   a precomputed hash code. */
 
-static void testKeyOwnership(void)
+static void testHashedKeys(void)
 {
-   enum {MAX_KEY_LENGTH = 10};
-
    SymTable_T oSymTable;
-   char acKey[MAX_KEY_LENGTH];
+   char acJeter[] = "Jeter";
+   char acJeter2[] = "Jeter";
+   char acMantle[] = "Mantle";
+   char acShortstop[] = "Shortstop";
+   char acCenterField[] = "Center Field";
+   size_t uJeterHash;
+   size_t uMantleHash;
    char *pcValue;
    int iSuccessful;
-   char acCenterField[] = "CenterField";
+   int iFound;
 
    printf("------------------------------------------------------\n");
-   printf("Testing key ownership.\n");
+   printf("Testing the functions that take precomputed hash codes.\n");
    printf("No output should appear here:\n");
    fflush(stdout);
 
+   uJeterHash = SymTable_hashKey(acJeter);
+   ASSURE(uJeterHash == SymTable_hashKey(acJeter2));
+   uMantleHash = SymTable_hashKey(acMantle);
+
    oSymTable = SymTable_new();
    ASSURE(oSymTable != NULL);
-   strcpy(acKey, "Mantle");
-   iSuccessful = SymTable_put(oSymTable, acKey, acCenterField);
+
+   iFound = SymTable_containsWithHash(oSymTable, acJeter, uJeterHash);
+   ASSURE(! iFound);
+
+   iSuccessful = SymTable_putWithHash(oSymTable, acJeter, uJeterHash,
+      acShortstop);
    ASSURE(iSuccessful);
-   strcpy(acKey, "xxx");
-   pcValue = (char*)SymTable_get(oSymTable, "Mantle");
+   iSuccessful = SymTable_putWithHash(oSymTable, acJeter2, uJeterHash,
+      acCenterField);
+   ASSURE(! iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, acMantle, acCenterField);
+   ASSURE(iSuccessful);
+
+   iFound = SymTable_containsWithHash(oSymTable, acJeter2, uJeterHash);
+   ASSURE(iFound);
+   pcValue = (char*)SymTable_getWithHash(oSymTable, acJeter2,
+      uJeterHash);
+   ASSURE(pcValue == acShortstop);
+   pcValue = (char*)SymTable_getWithHash(oSymTable, acMantle,
+      uMantleHash);
    ASSURE(pcValue == acCenterField);
+   pcValue = (char*)SymTable_get(oSymTable, acJeter);
+   ASSURE(pcValue == acShortstop);
+
+   pcValue = (char*)SymTable_remove(oSymTable, acJeter);
+   ASSURE(pcValue == acShortstop);
+   iFound = SymTable_containsWithHash(oSymTable, acJeter, uJeterHash);
+   ASSURE(! iFound);
+   pcValue = (char*)SymTable_getWithHash(oSymTable, acJeter,
+      uJeterHash);
+   ASSURE(pcValue == NULL);
 
    SymTable_free(oSymTable);
 }
 
 /*--------------------------------------------------------------------*/
 
-/* Test the SymTable_remove() function. */
+/* Test the functions that take a key as a pointer and a length. */
 
-static void testRemove(void)
+static void testLengthKeys(void)
 {
    SymTable_T oSymTable;
-   char acJeter[] = "Jeter";
-   char acMantle[] = "Mantle";
-   char acGehrig[] = "Gehrig";
-   char acRuth[] = "Ruth";
+   char acBuffer[] = "JeterMantleRuth";
    char acShortstop[] = "Shortstop";
    char acCenterField[] = "Center Field";
-   char acFirstBase[] = "First Base";
    char acRightField[] = "Right Field";
-
    char *pcValue;
-   int iFound;
-   size_t uLength;
    int iSuccessful;
+   int iFound;
 
    printf("------------------------------------------------------\n");
-   printf("Testing the SymTable_remove() function.\n");
+   printf("Testing the functions that take a key and its length.\n");
    printf("No output should appear here:\n");
    fflush(stdout);
 
+   ASSURE(SymTable_hashKeyN(acBuffer, 5) == SymTable_hashKey("Jeter"));
+
    oSymTable = SymTable_new();
    ASSURE(oSymTable != NULL);
 
-   iSuccessful = SymTable_put(oSymTable, acJeter, acShortstop);
+   iSuccessful = SymTable_putN(oSymTable, acBuffer, 5, acShortstop);
    ASSURE(iSuccessful);
-
-   iSuccessful = SymTable_put(oSymTable, acMantle, acCenterField);
+   iSuccessful = SymTable_putN(oSymTable, acBuffer + 5, 6,
+      acCenterField);
    ASSURE(iSuccessful);
-
-   iSuccessful = SymTable_put(oSymTable, acGehrig, acFirstBase);
+   iSuccessful = SymTable_put(oSymTable, "Jeter", acRightField);
+   ASSURE(! iSuccessful);
+   iSuccessful = SymTable_putN(oSymTable, acBuffer + 11, 4,
+      acRightField);
    ASSURE(iSuccessful);
+   ASSURE(SymTable_getLength(oSymTable) == 3);
 
-   iSuccessful = SymTable_put(oSymTable, acRuth, acRightField);
-   ASSURE(iSuccessful);
+   /* The buffer still holds all three names, so only the length
+      separates the keys. */
+   pcValue = (char*)SymTable_get(oSymTable, "Jeter");
+   ASSURE(pcValue == acShortstop);
+   pcValue = (char*)SymTable_getN(oSymTable, acBuffer + 5, 6);
+   ASSURE(pcValue == acCenterField);
+   iFound = SymTable_containsN(oSymTable, acBuffer, 3);
+   ASSURE(! iFound);
+   iFound = SymTable_containsN(oSymTable, acBuffer, 0);
+   ASSURE(! iFound);
+   iFound = SymTable_containsN(oSymTable, acBuffer + 11, 4);
+   ASSURE(iFound);
 
-   uLength = SymTable_getLength(oSymTable);
-   ASSURE(uLength == 4);
+   pcValue = (char*)SymTable_replaceN(oSymTable, acBuffer + 5, 6,
+      acShortstop);
+   ASSURE(pcValue == acCenterField);
+   pcValue = (char*)SymTable_get(oSymTable, "Mantle");
+   ASSURE(pcValue == acShortstop);
+   pcValue = (char*)SymTable_replaceN(oSymTable, acBuffer + 5, 4,
+      acShortstop);
+   ASSURE(pcValue == NULL);
 
-   pcValue = (char*)SymTable_remove(oSymTable, acJeter);
+   pcValue = (char*)SymTable_removeN(oSymTable, acBuffer, 5);
    ASSURE(pcValue == acShortstop);
+   pcValue = (char*)SymTable_removeN(oSymTable, acBuffer, 5);
+   ASSURE(pcValue == NULL);
+   iFound = SymTable_contains(oSymTable, "Jeter");
+   ASSURE(! iFound);
+   ASSURE(SymTable_getLength(oSymTable) == 2);
 
-   uLength = SymTable_getLength(oSymTable);
-   ASSURE(uLength == 3);
+   printf("Mantle and Ruth should appear here:\n");
+   fflush(stdout);
+   SymTable_map(oSymTable, printBinding, "%s\t%s\n");
 
-   iFound = SymTable_contains(oSymTable, acJeter);
-   ASSURE(! iFound);
+   SymTable_free(oSymTable);
+}
 
-   pcValue = (char*)SymTable_remove(oSymTable, acRuth);
-   ASSURE(pcValue == acRightField);
+/*--------------------------------------------------------------------*/
 
-   uLength = SymTable_getLength(oSymTable);
-   ASSURE(uLength == 2);
+/* Test the SymTable_upsert() and SymTable_getOrInsert() functions. */
 
-   iFound = SymTable_contains(oSymTable, acRuth);
-   ASSURE(! iFound);
+static void testUpsert(void)
+{
+   enum {WORD_COUNT = 7};
 
-   pcValue = (char*)SymTable_remove(oSymTable, "Clemens");
-   ASSURE(pcValue == NULL);
+   SymTable_T oSymTable;
+   const char *apcWords[WORD_COUNT] =
+      {"a", "b", "a", "c", "a", "b", "a"};
+   char acShortstop[] = "Shortstop";
+   char acCenterField[] = "Center Field";
+   char acTally[WORD_COUNT + 1];
+   char *pcValue;
+   void **ppvSlot;
+   int iSuccessful;
+   int i;
 
-   uLength = SymTable_getLength(oSymTable);
-   ASSURE(uLength == 2);
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_upsert() and SymTable_getOrInsert()\n");
+   printf("functions.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
 
-   iFound = SymTable_contains(oSymTable, "Clemens");
-   ASSURE(! iFound);
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
 
-   pcValue = (char*)SymTable_remove(oSymTable, acRuth);
-   ASSURE(pcValue == NULL);
+   iSuccessful = SymTable_upsert(oSymTable, "Jeter", acShortstop);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_getLength(oSymTable) == 1);
+   pcValue = (char*)SymTable_get(oSymTable, "Jeter");
+   ASSURE(pcValue == acShortstop);
 
-   uLength = SymTable_getLength(oSymTable);
-   ASSURE(uLength == 2);
+   iSuccessful = SymTable_upsert(oSymTable, "Jeter", acCenterField);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_getLength(oSymTable) == 1);
+   pcValue = (char*)SymTable_get(oSymTable, "Jeter");
+   ASSURE(pcValue == acCenterField);
 
-   iFound = SymTable_contains(oSymTable, acRuth);
-   ASSURE(! iFound);
+   ppvSlot = SymTable_getOrInsert(oSymTable, "Jeter", acShortstop);
+   ASSURE(ppvSlot != NULL);
+   ASSURE((ppvSlot != NULL) && (*ppvSlot == acCenterField));
+   ASSURE(SymTable_getLength(oSymTable) == 1);
+
+   /* Count the words by advancing a pointer into acTally in place. */
+   for (i = 0; i < WORD_COUNT; i++)
+   {
+      ppvSlot = SymTable_getOrInsert(oSymTable, apcWords[i], acTally);
+      ASSURE(ppvSlot != NULL);
+      if (ppvSlot != NULL)
+         *ppvSlot = (char*)*ppvSlot + 1;
+   }
+   ASSURE(SymTable_getLength(oSymTable) == 4);
+   pcValue = (char*)SymTable_get(oSymTable, "a");
+   ASSURE(pcValue == acTally + 4);
+   pcValue = (char*)SymTable_get(oSymTable, "b");
+   ASSURE(pcValue == acTally + 2);
+   pcValue = (char*)SymTable_get(oSymTable, "c");
+   ASSURE(pcValue == acTally + 1);
 
    SymTable_free(oSymTable);
 }
 
 /*--------------------------------------------------------------------*/
 
-/* Test the SymTable_map() function. */
+/* A Pool counts the blocks that a SymTable allocates through it, and
+   refuses to allocate once it has allocated uLimit blocks, or to
+   allocate any block larger than uMaxSize bytes. */
 
-static void testMap(void)
+struct Pool
+{
+   size_t uLive;
+   size_t uAllocated;
+   size_t uLimit;
+   size_t uMaxSize;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Allocate uSize bytes for the Pool that pvPool points to, or
+   return NULL if its limits do not allow that. */
+
+static void *poolAlloc(size_t uSize, void *pvPool)
+{
+   struct Pool *psPool = (struct Pool*)pvPool;
+   void *pvBlock;
+
+   assert(psPool != NULL);
+
+   if (psPool->uAllocated == psPool->uLimit ||
+       uSize > psPool->uMaxSize)
+      return NULL;
+   pvBlock = malloc(uSize);
+   if (pvBlock != NULL)
+   {
+      psPool->uAllocated++;
+      psPool->uLive++;
+   }
+   return pvBlock;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free pvBlock, which poolAlloc() allocated for the Pool that pvPool
+   points to. */
+
+static void poolFree(void *pvBlock, void *pvPool)
+{
+   struct Pool *psPool = (struct Pool*)pvPool;
+
+   assert(psPool != NULL);
+
+   if (pvBlock == NULL)
+      return;
+   assert(psPool->uLive > 0);
+   psPool->uLive--;
+   free(pvBlock);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTable_newWithAllocator() function. */
+
+static void testAllocator(void)
 {
+   enum {KEY_COUNT = 1000, MAX_KEY_LENGTH = 10};
+
    SymTable_T oSymTable;
-   char acJeter[] = "Jeter";
-   char acMantle[] = "Mantle";
-   char acGehrig[] = "Gehrig";
-   char acRuth[] = "Ruth";
-   char acShortstop[] = "Shortstop";
-   char acCenterField[] = "Center Field";
-   char acFirstBase[] = "First Base";
-   char acRightField[] = "Right Field";
+   struct Pool sPool;
+   char acKey[MAX_KEY_LENGTH];
+   size_t uLimit;
+   int iSuccessful;
+   int iPutCount;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_newWithAllocator() function.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   /* Every block must come from the pool and go back to it. */
+   sPool.uLive = 0;
+   sPool.uAllocated = 0;
+   sPool.uLimit = (size_t)-1;
+   sPool.uMaxSize = (size_t)-1;
+   oSymTable = SymTable_newWithAllocator(poolAlloc, poolFree, &sPool);
+   ASSURE(oSymTable != NULL);
+   ASSURE(sPool.uLive > 0);
+
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, &sPool);
+      ASSURE(iSuccessful);
+   }
+   for (i = 0; i < KEY_COUNT; i += 2)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_remove(oSymTable, acKey) == &sPool);
+   }
+   ASSURE(SymTable_getLength(oSymTable) == KEY_COUNT / 2);
+   ASSURE(sPool.uAllocated > KEY_COUNT);
+
+   SymTable_free(oSymTable);
+   ASSURE(sPool.uLive == 0);
+
+   /* Running out of memory at any point must leave a table that
+      holds exactly the bindings that were put, and leaks nothing. */
+   for (uLimit = 0; uLimit < 80; uLimit++)
+   {
+      sPool.uLive = 0;
+      sPool.uAllocated = 0;
+      sPool.uLimit = uLimit;
+      sPool.uMaxSize = (size_t)-1;
+      oSymTable = SymTable_newWithAllocator(poolAlloc, poolFree,
+         &sPool);
+      if (oSymTable == NULL)
+      {
+         ASSURE(sPool.uLive == 0);
+         continue;
+      }
+
+      iPutCount = 0;
+      for (i = 0; i < KEY_COUNT; i++)
+      {
+         sprintf(acKey, "%d", i);
+         if (! SymTable_put(oSymTable, acKey, &sPool))
+            break;
+         iPutCount++;
+      }
+      ASSURE(SymTable_getLength(oSymTable) == (size_t)iPutCount);
+      for (i = 0; i < iPutCount; i++)
+      {
+         sprintf(acKey, "%d", i);
+         ASSURE(SymTable_get(oSymTable, acKey) == &sPool);
+      }
+      sprintf(acKey, "%d", iPutCount);
+      ASSURE(! SymTable_contains(oSymTable, acKey));
+
+      SymTable_free(oSymTable);
+      ASSURE(sPool.uLive == 0);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* A Point is a value that testInline() stores inside a SymTable. */
+
+struct Point
+{
+   int iX;
+   int iY;
+   char cTag;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Move the Point that pvValue points to one to the right, and
+   increment the size_t that pvExtra points to. pcKey is unused. */
+
+static void shiftPoint(const char *pcKey, void *pvValue, void *pvExtra)
+{
+   assert(pcKey != NULL);
+   assert(pvValue != NULL);
+   assert(pvExtra != NULL);
+
+   ((struct Point*)pvValue)->iX++;
+   (*(size_t*)pvExtra)++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTable_newInline() function. */
+
+static void testInline(void)
+{
+   enum {KEY_COUNT = 5000, MAX_KEY_LENGTH = 10};
 
+   SymTable_T oSymTable;
+   struct Point sPoint;
+   struct Point *psPoint;
+   char acKey[MAX_KEY_LENGTH];
+   void **ppvSlot;
+   size_t uCount;
    int iSuccessful;
+   int i;
 
    printf("------------------------------------------------------\n");
-   printf("Testing the SymTable_map() function.\n");
+   printf("Testing the SymTable_newInline() function.\n");
+   printf("No output should appear here:\n");
    fflush(stdout);
 
-   oSymTable = SymTable_new();
+   oSymTable = SymTable_newInline(sizeof(struct Point));
    ASSURE(oSymTable != NULL);
 
-   iSuccessful = SymTable_put(oSymTable, acJeter, acShortstop);
+   /* The table must copy values in, not keep the caller's pointer. */
+   sPoint.iX = 1;
+   sPoint.iY = 2;
+   sPoint.cTag = 'a';
+   iSuccessful = SymTable_put(oSymTable, "Ruth", &sPoint);
    ASSURE(iSuccessful);
-
-   iSuccessful = SymTable_put(oSymTable, acMantle, acCenterField);
+   sPoint.iX = 99;
+   psPoint = (struct Point*)SymTable_get(oSymTable, "Ruth");
+   ASSURE(psPoint != NULL);
+   ASSURE(psPoint != &sPoint);
+   ASSURE(psPoint->iX == 1 && psPoint->iY == 2 && psPoint->cTag == 'a');
+
+   /* A NULL value must be stored as zeroes. */
+   iSuccessful = SymTable_put(oSymTable, "Gehrig", NULL);
    ASSURE(iSuccessful);
-
-   iSuccessful = SymTable_put(oSymTable, acGehrig, acFirstBase);
+   psPoint = (struct Point*)SymTable_get(oSymTable, "Gehrig");
+   ASSURE(psPoint != NULL);
+   ASSURE(psPoint->iX == 0 && psPoint->iY == 0 && psPoint->cTag == 0);
+
+   /* replace and remove must hand back the old value. */
+   sPoint.iX = 3;
+   psPoint = (struct Point*)SymTable_replace(oSymTable, "Ruth", &sPoint);
+   ASSURE(psPoint != NULL);
+   ASSURE(psPoint->iX == 1 && psPoint->iY == 2);
+   psPoint = (struct Point*)SymTable_get(oSymTable, "Ruth");
+   ASSURE(psPoint->iX == 3 && psPoint->iY == 2);
+   ASSURE(SymTable_replace(oSymTable, "Jeter", &sPoint) == NULL);
+
+   iSuccessful = SymTable_upsert(oSymTable, "Ruth", NULL);
    ASSURE(iSuccessful);
+   psPoint = (struct Point*)SymTable_get(oSymTable, "Ruth");
+   ASSURE(psPoint->iX == 0 && psPoint->iY == 0);
+
+   ppvSlot = SymTable_getOrInsert(oSymTable, "Mantle", NULL);
+   ASSURE(ppvSlot != NULL);
+   ((struct Point*)*ppvSlot)->iY = 7;
+   psPoint = (struct Point*)SymTable_get(oSymTable, "Mantle");
+   ASSURE(psPoint->iX == 0 && psPoint->iY == 7);
+
+   psPoint = (struct Point*)SymTable_remove(oSymTable, "Mantle");
+   ASSURE(psPoint != NULL);
+   ASSURE(psPoint->iY == 7);
+   ASSURE(! SymTable_contains(oSymTable, "Mantle"));
+   ASSURE(SymTable_remove(oSymTable, "Mantle") == NULL);
+   SymTable_free(oSymTable);
 
-   iSuccessful = SymTable_put(oSymTable, acRuth, acRightField);
-   ASSURE(iSuccessful);
+   /* Values must survive the table growing, and map must pass out
+      the stored values themselves. */
+   oSymTable = SymTable_newInline(sizeof(struct Point));
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      sPoint.iX = i;
+      sPoint.iY = -i;
+      sPoint.cTag = (char)(i % 128);
+      iSuccessful = SymTable_put(oSymTable, acKey, &sPoint);
+      ASSURE(iSuccessful);
+   }
+   uCount = 0;
+   SymTable_map(oSymTable, shiftPoint, &uCount);
+   ASSURE(uCount == KEY_COUNT);
+   for (i = 0; i < KEY_COUNT; i += 2)
+   {
+      sprintf(acKey, "%d", i);
+      psPoint = (struct Point*)SymTable_remove(oSymTable, acKey);
+      ASSURE(psPoint != NULL);
+      ASSURE(psPoint->iX == i + 1 && psPoint->iY == -i);
+   }
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      psPoint = (struct Point*)SymTable_get(oSymTable, acKey);
+      if (i % 2 == 0)
+         ASSURE(psPoint == NULL);
+      else
+      {
+         ASSURE(psPoint != NULL);
+         ASSURE(psPoint->iX == i + 1 && psPoint->iY == -i &&
+            psPoint->cTag == (char)(i % 128));
+      }
+   }
+   SymTable_free(oSymTable);
+}
 
-   printf("Four players and their positions should appear here:\n");
-   fflush(stdout);
-   SymTable_map(oSymTable, printBinding, "%s\t%s\n");
+/*--------------------------------------------------------------------*/
 
-   printf("Four players and their positions should appear here:\n");
+/* Test the SymTable_buildParallel() function with uThreadCount
+   threads. */
+
+static void testBuildParallel(size_t uThreadCount)
+{
+   enum {KEY_COUNT = 3000, DISTINCT_KEY_COUNT = 2000,
+      MAX_KEY_LENGTH = 10};
+
+   SymTable_T oSymTable;
+   char (*pacKeys)[MAX_KEY_LENGTH];
+   const char **ppcKeys;
+   const void **ppvValues;
+   char acKey[MAX_KEY_LENGTH];
+   char *pcValue;
+   int iSuccessful;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_buildParallel() function.\n");
+   printf("No output should appear here:\n");
    fflush(stdout);
-   SymTable_map(oSymTable, printBindingSimple, NULL);
 
+   pacKeys = malloc(KEY_COUNT * sizeof(*pacKeys));
+   ppcKeys = (const char**)malloc(KEY_COUNT * sizeof(char*));
+   ppvValues = (const void**)malloc(KEY_COUNT * sizeof(void*));
+   ASSURE(pacKeys != NULL && ppcKeys != NULL && ppvValues != NULL);
+   if (pacKeys == NULL || ppcKeys == NULL || ppvValues == NULL)
+      exit(EXIT_FAILURE);
+
+   /* The last KEY_COUNT - DISTINCT_KEY_COUNT keys repeat earlier
+      ones, with values that must not be kept. */
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(pacKeys[i], "%d", i % DISTINCT_KEY_COUNT);
+      ppcKeys[i] = pacKeys[i];
+      ppvValues[i] = pacKeys[i];
+   }
+
+   oSymTable = SymTable_buildParallel(ppcKeys, ppvValues, KEY_COUNT,
+      uThreadCount);
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_getLength(oSymTable) == DISTINCT_KEY_COUNT);
+
+   for (i = 0; i < DISTINCT_KEY_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      pcValue = (char*)SymTable_get(oSymTable, acKey);
+      ASSURE(pcValue == pacKeys[i]);
+   }
+
+   /* The table must keep working once built. */
+   iSuccessful = SymTable_put(oSymTable, "Jeter", acKey);
+   ASSURE(iSuccessful);
+   pcValue = (char*)SymTable_remove(oSymTable, "0");
+   ASSURE(pcValue == pacKeys[0]);
+   ASSURE(SymTable_getLength(oSymTable) == DISTINCT_KEY_COUNT);
+   SymTable_free(oSymTable);
+
+   oSymTable = SymTable_buildParallel(NULL, NULL, 0, uThreadCount);
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_getLength(oSymTable) == 0);
+   SymTable_free(oSymTable);
+
+   free(pacKeys);
+   free(ppcKeys);
+   free(ppvValues);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Write the iLength characters at pcText to the file pcPath,
+   replacing its contents. */
+
+static void writeFile(const char *pcPath, const char *pcText,
+   int iLength)
+{
+   FILE *psFile;
+
+   psFile = fopen(pcPath, "wb");
+   ASSURE(psFile != NULL);
+   if (psFile == NULL)
+      exit(EXIT_FAILURE);
+   ASSURE(fwrite(pcText, 1, (size_t)iLength, psFile)
+      == (size_t)iLength);
+   ASSURE(fclose(psFile) == 0);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTable_load() function, loading iBindingCount
+   bindings from a larger file. */
+
+static void testLoad(int iBindingCount)
+{
+   static const char acText[] =
+      "Jeter,shortstop\n"
+      "Ruth,right field\r\n"
+      "\n"
+      "Jeter,first occurrence is kept\n"
+      "Gehrig\n"
+      ",empty key\n"
+      "Mantle,center,field\n"
+      "Berra,catcher";
+   static const char acNull[] = "Jeter,short\0stop\n";
+   const char *pcPath = "testsymtable.tmp";
+   SymTable_T oSymTable;
+   SymTable_T oClone;
+   FILE *psFile;
+   char acKey[32];
+   char acValue[32];
+   char *pcValue;
+   int iSuccessful;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_load() function.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   writeFile(pcPath, acText, (int)sizeof(acText) - 1);
+   oSymTable = SymTable_load(pcPath, ',');
+   ASSURE(oSymTable != NULL);
+   if (oSymTable == NULL)
+      return;
+   ASSURE(SymTable_getLength(oSymTable) == 6);
+   pcValue = (char*)SymTable_get(oSymTable, "Jeter");
+   ASSURE(pcValue != NULL && strcmp(pcValue, "shortstop") == 0);
+   pcValue = (char*)SymTable_get(oSymTable, "Ruth");
+   ASSURE(pcValue != NULL && strcmp(pcValue, "right field") == 0);
+   pcValue = (char*)SymTable_get(oSymTable, "Gehrig");
+   ASSURE(pcValue != NULL && strcmp(pcValue, "") == 0);
+   pcValue = (char*)SymTable_get(oSymTable, "");
+   ASSURE(pcValue != NULL && strcmp(pcValue, "empty key") == 0);
+   pcValue = (char*)SymTable_get(oSymTable, "Mantle");
+   ASSURE(pcValue != NULL && strcmp(pcValue, "center,field") == 0);
+   pcValue = (char*)SymTable_get(oSymTable, "Berra");
+   ASSURE(pcValue != NULL && strcmp(pcValue, "catcher") == 0);
+
+   /* The values must outlive the file, the table, and its keys. */
+   ASSURE(remove(pcPath) == 0);
+   oClone = SymTable_clone(oSymTable);
+   ASSURE(oClone != NULL);
+   pcValue = (char*)SymTable_remove(oSymTable, "Ruth");
+   ASSURE(pcValue != NULL && strcmp(pcValue, "right field") == 0);
+   iSuccessful = SymTable_put(oSymTable, "Ruth", "pitcher");
+   ASSURE(iSuccessful);
+   SymTable_free(oSymTable);
+   if (oClone != NULL)
+   {
+      pcValue = (char*)SymTable_get(oClone, "Ruth");
+      ASSURE(pcValue != NULL && strcmp(pcValue, "right field") == 0);
+      pcValue = (char*)SymTable_remove(oClone, "Jeter");
+      ASSURE(pcValue != NULL && strcmp(pcValue, "shortstop") == 0);
+      ASSURE(SymTable_getLength(oClone) == 5);
+      SymTable_free(oClone);
+   }
+
+   /* Missing, empty, and unreadable files. */
+   ASSURE(SymTable_load(pcPath, ',') == NULL);
+   writeFile(pcPath, acText, 0);
+   oSymTable = SymTable_load(pcPath, ',');
+   ASSURE(oSymTable != NULL);
+   if (oSymTable != NULL)
+   {
+      ASSURE(SymTable_getLength(oSymTable) == 0);
+      SymTable_free(oSymTable);
+   }
+   writeFile(pcPath, acNull, (int)sizeof(acNull) - 1);
+   ASSURE(SymTable_load(pcPath, ',') == NULL);
+
+   /* A larger file, tab separated, that ends with a newline. */
+   psFile = fopen(pcPath, "wb");
+   ASSURE(psFile != NULL);
+   if (psFile == NULL)
+      exit(EXIT_FAILURE);
+   for (i = 0; i < iBindingCount; i++)
+      fprintf(psFile, "symbol%d\t%d\n", i, i * 7);
+   ASSURE(fclose(psFile) == 0);
+   oSymTable = SymTable_load(pcPath, '\t');
+   ASSURE(oSymTable != NULL);
+   if (oSymTable != NULL)
+   {
+      ASSURE(SymTable_getLength(oSymTable) == (size_t)iBindingCount);
+      for (i = 0; i < iBindingCount; i++)
+      {
+         sprintf(acKey, "symbol%d", i);
+         sprintf(acValue, "%d", i * 7);
+         pcValue = (char*)SymTable_get(oSymTable, acKey);
+         ASSURE(pcValue != NULL && strcmp(pcValue, acValue) == 0);
+      }
+      for (i = 0; i < iBindingCount; i += 2)
+      {
+         sprintf(acKey, "symbol%d", i);
+         ASSURE(SymTable_remove(oSymTable, acKey) != NULL);
+      }
+      ASSURE(SymTable_getLength(oSymTable)
+         == (size_t)(iBindingCount / 2));
+      SymTable_free(oSymTable);
+   }
+   ASSURE(remove(pcPath) == 0);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add one to the int that pvValue points to. pcKey and pvExtra are
+   unused. Distinct bindings have distinct ints, so this is safe to
+   call from several threads at once. */
+
+static void incrementBinding(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   assert(pcKey != NULL);
+   assert(pvValue != NULL);
+   assert(pvExtra == NULL);
+
+   (*(int*)pvValue)++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTable_mapParallel() function with iBindingCount
+   bindings and uThreadCount threads. */
+
+static void testMapParallel(int iBindingCount, size_t uThreadCount)
+{
+   enum {MAX_KEY_LENGTH = 10};
+
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   int *piVisits;
+   int iSuccessful;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_mapParallel() function.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   piVisits = (int*)calloc((size_t)iBindingCount + 1, sizeof(int));
+   ASSURE(piVisits != NULL);
+   if (piVisits == NULL)
+      exit(EXIT_FAILURE);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   SymTable_mapParallel(oSymTable, incrementBinding, NULL,
+      uThreadCount);
+
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, &piVisits[i]);
+      ASSURE(iSuccessful);
+   }
+
+   /* Each binding must be visited exactly once. */
+   SymTable_mapParallel(oSymTable, incrementBinding, NULL,
+      uThreadCount);
+   for (i = 0; i < iBindingCount; i++)
+      ASSURE(piVisits[i] == 1);
+
+   SymTable_free(oSymTable);
+   free(piVisits);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test handling of key ownership. */
+
+static void testKeyOwnership(void)
+{
+   enum {MAX_KEY_LENGTH = 10};
+
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   char *pcValue;
+   int iSuccessful;
+   char acCenterField[] = "CenterField";
+
+   printf("------------------------------------------------------\n");
+   printf("Testing key ownership.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   strcpy(acKey, "Mantle");
+   iSuccessful = SymTable_put(oSymTable, acKey, acCenterField);
+   ASSURE(iSuccessful);
+   strcpy(acKey, "xxx");
+   pcValue = (char*)SymTable_get(oSymTable, "Mantle");
+   ASSURE(pcValue == acCenterField);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTable_remove() function. */
+
+static void testRemove(void)
+{
+   SymTable_T oSymTable;
+   char acJeter[] = "Jeter";
+   char acMantle[] = "Mantle";
+   char acGehrig[] = "Gehrig";
+   char acRuth[] = "Ruth";
+   char acShortstop[] = "Shortstop";
+   char acCenterField[] = "Center Field";
+   char acFirstBase[] = "First Base";
+   char acRightField[] = "Right Field";
+
+   char *pcValue;
+   int iFound;
+   size_t uLength;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_remove() function.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   iSuccessful = SymTable_put(oSymTable, acJeter, acShortstop);
+   ASSURE(iSuccessful);
+
+   iSuccessful = SymTable_put(oSymTable, acMantle, acCenterField);
+   ASSURE(iSuccessful);
+
+   iSuccessful = SymTable_put(oSymTable, acGehrig, acFirstBase);
+   ASSURE(iSuccessful);
+
+   iSuccessful = SymTable_put(oSymTable, acRuth, acRightField);
+   ASSURE(iSuccessful);
+
+   uLength = SymTable_getLength(oSymTable);
+   ASSURE(uLength == 4);
+
+   pcValue = (char*)SymTable_remove(oSymTable, acJeter);
+   ASSURE(pcValue == acShortstop);
+
+   uLength = SymTable_getLength(oSymTable);
+   ASSURE(uLength == 3);
+
+   iFound = SymTable_contains(oSymTable, acJeter);
+   ASSURE(! iFound);
+
+   pcValue = (char*)SymTable_remove(oSymTable, acRuth);
+   ASSURE(pcValue == acRightField);
+
+   uLength = SymTable_getLength(oSymTable);
+   ASSURE(uLength == 2);
+
+   iFound = SymTable_contains(oSymTable, acRuth);
+   ASSURE(! iFound);
+
+   pcValue = (char*)SymTable_remove(oSymTable, "Clemens");
+   ASSURE(pcValue == NULL);
+
+   uLength = SymTable_getLength(oSymTable);
+   ASSURE(uLength == 2);
+
+   iFound = SymTable_contains(oSymTable, "Clemens");
+   ASSURE(! iFound);
+
+   pcValue = (char*)SymTable_remove(oSymTable, acRuth);
+   ASSURE(pcValue == NULL);
+
+   uLength = SymTable_getLength(oSymTable);
+   ASSURE(uLength == 2);
+
+   iFound = SymTable_contains(oSymTable, acRuth);
+   ASSURE(! iFound);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTable_map() function. */
+
+static void testMap(void)
+{
+   SymTable_T oSymTable;
+   char acJeter[] = "Jeter";
+   char acMantle[] = "Mantle";
+   char acGehrig[] = "Gehrig";
+   char acRuth[] = "Ruth";
+   char acShortstop[] = "Shortstop";
+   char acCenterField[] = "Center Field";
+   char acFirstBase[] = "First Base";
+   char acRightField[] = "Right Field";
+
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_map() function.\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   iSuccessful = SymTable_put(oSymTable, acJeter, acShortstop);
+   ASSURE(iSuccessful);
+
+   iSuccessful = SymTable_put(oSymTable, acMantle, acCenterField);
+   ASSURE(iSuccessful);
+
+   iSuccessful = SymTable_put(oSymTable, acGehrig, acFirstBase);
+   ASSURE(iSuccessful);
+
+   iSuccessful = SymTable_put(oSymTable, acRuth, acRightField);
+   ASSURE(iSuccessful);
+
+   printf("Four players and their positions should appear here:\n");
+   fflush(stdout);
+   SymTable_map(oSymTable, printBinding, "%s\t%s\n");
+
+   printf("Four players and their positions should appear here:\n");
+   fflush(stdout);
+   SymTable_map(oSymTable, printBindingSimple, NULL);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Count the binding whose key is pcKey and whose string value is
+   pvValue in the size_t that pvExtra points to, making sure that the
+   value contains the same characters as the key. */
+
+static void countBinding(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   assert(pcKey != NULL);
+   assert(pvValue != NULL);
+   assert(pvExtra != NULL);
+
+   ASSURE(strcmp(pcKey, (char*)pvValue) == 0);
+   (*(size_t*)pvExtra)++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTable_rangeMap() and SymTable_prefixMap() functions. */
+
+static void testRangeMap(void)
+{
+   SymTable_T oSymTable;
+   char acA[] = "com.shop.a";
+   char acB[] = "com.shop.b";
+   char acModule[] = "com.shop.module.x";
+   char acShop[] = "com.shop";
+   char acOther[] = "com.other";
+   char acOrg[] = "org.x";
+   size_t uCount;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_rangeMap() and SymTable_prefixMap()\n");
+   printf("functions.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   uCount = 0;
+   SymTable_prefixMap(oSymTable, "com", countBinding, &uCount);
+   ASSURE(uCount == 0);
+
+   iSuccessful = SymTable_put(oSymTable, acA, acA);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, acB, acB);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, acModule, acModule);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, acShop, acShop);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, acOther, acOther);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, acOrg, acOrg);
+   ASSURE(iSuccessful);
+
+   uCount = 0;
+   SymTable_prefixMap(oSymTable, "com.shop.", countBinding, &uCount);
+   ASSURE(uCount == 3);
+
+   uCount = 0;
+   SymTable_prefixMap(oSymTable, "com.shop", countBinding, &uCount);
+   ASSURE(uCount == 4);
+
+   uCount = 0;
+   SymTable_prefixMap(oSymTable, "", countBinding, &uCount);
+   ASSURE(uCount == 6);
+
+   uCount = 0;
+   SymTable_prefixMap(oSymTable, "net.", countBinding, &uCount);
+   ASSURE(uCount == 0);
+
+   uCount = 0;
+   SymTable_rangeMap(oSymTable, acA, "com.shop.m", countBinding,
+      &uCount);
+   ASSURE(uCount == 2);
+
+   uCount = 0;
+   SymTable_rangeMap(oSymTable, "com.shop.b", acModule, countBinding,
+      &uCount);
+   ASSURE(uCount == 1);
+
+   uCount = 0;
+   SymTable_rangeMap(oSymTable, NULL, "com.shop", countBinding,
+      &uCount);
+   ASSURE(uCount == 1);
+
+   uCount = 0;
+   SymTable_rangeMap(oSymTable, "com.shop.m", NULL, countBinding,
+      &uCount);
+   ASSURE(uCount == 2);
+
+   uCount = 0;
+   SymTable_rangeMap(oSymTable, NULL, NULL, countBinding, &uCount);
+   ASSURE(uCount == 6);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test a SymTable whose allocator refuses blocks of more than 1 KB,
+   so that a hash table cannot grow past its smallest bucket array
+   and its chains grow long. */
+
+static void testLongChains(void)
+{
+   enum {KEY_COUNT = 280, MAX_KEY_LENGTH = 10};
+
+   SymTable_T oSymTable;
+   struct Pool sPool;
+   static char aacKeys[KEY_COUNT][MAX_KEY_LENGTH];
+   static char aacCopies[KEY_COUNT][MAX_KEY_LENGTH];
+   size_t uCount;
+   int iSuccessful;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a SymTable with long chains.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   sPool.uLive = 0;
+   sPool.uAllocated = 0;
+   sPool.uLimit = (size_t)-1;
+   sPool.uMaxSize = 1024;
+   oSymTable = SymTable_newWithAllocator(poolAlloc, poolFree, &sPool);
+   ASSURE(oSymTable != NULL);
+
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(aacKeys[i], "%d", i);
+      strcpy(aacCopies[i], aacKeys[i]);
+      iSuccessful = SymTable_put(oSymTable, aacKeys[i], aacKeys[i]);
+      ASSURE(iSuccessful);
+   }
+   ASSURE(SymTable_getLength(oSymTable) == KEY_COUNT);
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      ASSURE(SymTable_get(oSymTable, aacKeys[i]) == aacKeys[i]);
+      iSuccessful = SymTable_put(oSymTable, aacKeys[i], aacCopies[i]);
+      ASSURE(! iSuccessful);
+   }
+   ASSURE(! SymTable_contains(oSymTable, "-1"));
+   ASSURE(SymTable_get(oSymTable, "") == NULL);
+
+   /* Removing most keys must leave the rest intact, and the removed
+      keys must be able to come back. */
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      if (i % 4 == 0)
+         continue;
+      ASSURE(SymTable_remove(oSymTable, aacKeys[i]) == aacKeys[i]);
+      ASSURE(SymTable_remove(oSymTable, aacKeys[i]) == NULL);
+   }
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      if (i % 4 == 0)
+         ASSURE(SymTable_get(oSymTable, aacKeys[i]) == aacKeys[i]);
+      else
+         ASSURE(! SymTable_contains(oSymTable, aacKeys[i]));
+   }
+   uCount = 0;
+   SymTable_map(oSymTable, countBinding, &uCount);
+   ASSURE(uCount == (KEY_COUNT + 3) / 4);
+
+   for (i = KEY_COUNT - 1; i >= 0; i--)
+   {
+      if (i % 4 != 0)
+      {
+         iSuccessful = SymTable_put(oSymTable, aacKeys[i], aacKeys[i]);
+         ASSURE(iSuccessful);
+      }
+      else
+         ASSURE(SymTable_replace(oSymTable, aacKeys[i], aacCopies[i])
+            == aacKeys[i]);
+   }
+   for (i = 0; i < KEY_COUNT; i++)
+      ASSURE(SymTable_get(oSymTable, aacKeys[i])
+         == (i % 4 == 0 ? aacCopies[i] : aacKeys[i]));
+
+   /* Emptying the table must free every chain. */
+   for (i = 0; i < KEY_COUNT; i++)
+      ASSURE(SymTable_remove(oSymTable, aacKeys[(i * 3) % KEY_COUNT])
+         != NULL);
+   ASSURE(SymTable_getLength(oSymTable) == 0);
+   SymTable_free(oSymTable);
+   ASSURE(sPool.uLive == 0);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTable_clone() function on a table that holds
+   iKeyCount keys, whose memory comes from a pool whose allocator
+   refuses blocks of more than uMaxSize bytes. */
+
+static void testCloneOf(int iKeyCount, size_t uMaxSize)
+{
+   enum {MAX_KEY_COUNT = 3000, MAX_KEY_LENGTH = 10};
+
+   SymTable_T oSymTable;
+   SymTable_T oClone;
+   SymTable_T oClone2;
+   struct Pool sPool;
+   static char aacKeys[2 * MAX_KEY_COUNT][MAX_KEY_LENGTH];
+   static char aacCopies[2 * MAX_KEY_COUNT][MAX_KEY_LENGTH];
+   size_t uCount;
+   size_t uLimit;
+   int iSuccessful;
+   int i;
+
+   assert(iKeyCount <= MAX_KEY_COUNT);
+
+   sPool.uLive = 0;
+   sPool.uAllocated = 0;
+   sPool.uLimit = (size_t)-1;
+   sPool.uMaxSize = uMaxSize;
+   oSymTable = SymTable_newWithAllocator(poolAlloc, poolFree, &sPool);
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < 2 * iKeyCount; i++)
+   {
+      sprintf(aacKeys[i], "%d", i);
+      strcpy(aacCopies[i], aacKeys[i]);
+   }
+   for (i = 0; i < iKeyCount; i++)
+   {
+      iSuccessful = SymTable_put(oSymTable, aacKeys[i], aacKeys[i]);
+      ASSURE(iSuccessful);
+   }
+
+   /* The clone must start out with the same bindings. */
+   oClone = SymTable_clone(oSymTable);
+   ASSURE(oClone != NULL);
+   ASSURE(SymTable_getLength(oClone) == (size_t)iKeyCount);
+   for (i = 0; i < iKeyCount; i++)
+      ASSURE(SymTable_get(oClone, aacKeys[i]) == aacKeys[i]);
+
+   /* Changes to the clone must not show in the original. */
+   for (i = 0; i < iKeyCount; i++)
+   {
+      if (i % 3 == 0)
+         ASSURE(SymTable_remove(oClone, aacKeys[i]) == aacKeys[i]);
+      else if (i % 3 == 1)
+         ASSURE(SymTable_replace(oClone, aacKeys[i], aacCopies[i])
+            == aacKeys[i]);
+   }
+   for (i = iKeyCount; i < iKeyCount + iKeyCount / 2; i++)
+   {
+      iSuccessful = SymTable_put(oClone, aacKeys[i], aacKeys[i]);
+      ASSURE(iSuccessful);
+   }
+   ASSURE(SymTable_getLength(oSymTable) == (size_t)iKeyCount);
+   for (i = 0; i < iKeyCount + iKeyCount / 2; i++)
+      ASSURE(SymTable_get(oSymTable, aacKeys[i])
+         == (i < iKeyCount ? aacKeys[i] : NULL));
+   uCount = 0;
+   SymTable_map(oSymTable, countBinding, &uCount);
+   ASSURE(uCount == (size_t)iKeyCount);
+
+   /* Changes to the original must not show in the clone. */
+   for (i = 0; i < iKeyCount; i += 5)
+   {
+      iSuccessful = SymTable_upsert(oSymTable, aacKeys[i], aacCopies[i]);
+      ASSURE(iSuccessful);
+   }
+   ASSURE(SymTable_remove(oSymTable, aacKeys[1]) == aacKeys[1]);
+   for (i = 0; i < iKeyCount + iKeyCount / 2; i++)
+   {
+      if (i >= iKeyCount)
+         ASSURE(SymTable_get(oClone, aacKeys[i]) == aacKeys[i]);
+      else if (i % 3 == 0)
+         ASSURE(! SymTable_contains(oClone, aacKeys[i]));
+      else
+         ASSURE(SymTable_get(oClone, aacKeys[i])
+            == (i % 3 == 1 ? aacCopies[i] : aacKeys[i]));
+   }
+
+   /* A clone of a clone must grow without disturbing its source. */
+   oClone2 = SymTable_clone(oClone);
+   ASSURE(oClone2 != NULL);
+   uCount = SymTable_getLength(oClone);
+   for (i = 0; i < 2 * iKeyCount; i++)
+      (void)SymTable_upsert(oClone2, aacKeys[i], aacCopies[i]);
+   ASSURE(SymTable_getLength(oClone2) == (size_t)(2 * iKeyCount));
+   ASSURE(SymTable_getLength(oClone) == uCount);
+   for (i = 0; i < 2 * iKeyCount; i++)
+      ASSURE(SymTable_get(oClone2, aacKeys[i]) == aacCopies[i]);
+   ASSURE(SymTable_get(oClone, aacKeys[2]) == aacKeys[2]);
+   ASSURE(! SymTable_contains(oClone, aacKeys[3]));
+
+   /* The tables must be freeable in any order. */
+   SymTable_free(oSymTable);
+   ASSURE(SymTable_get(oClone, aacKeys[4]) == aacCopies[4]);
+   SymTable_free(oClone2);
+   uCount = 0;
+   SymTable_map(oClone, countBinding, &uCount);
+   ASSURE(uCount == SymTable_getLength(oClone));
+   SymTable_free(oClone);
+   ASSURE(sPool.uLive == 0);
+
+   /* Running out of memory while changing a clone must leave both
+      tables as they were, and leak nothing. */
+   for (uLimit = 0; uLimit < 40; uLimit++)
+   {
+      sPool.uLimit = (size_t)-1;
+      oSymTable = SymTable_newWithAllocator(poolAlloc, poolFree,
+         &sPool);
+      ASSURE(oSymTable != NULL);
+      for (i = 0; i < iKeyCount; i++)
+         (void)SymTable_put(oSymTable, aacKeys[i], aacKeys[i]);
+
+      sPool.uLimit = sPool.uAllocated + uLimit;
+      oClone = SymTable_clone(oSymTable);
+      if (oClone != NULL)
+      {
+         for (i = 0; i < iKeyCount; i += 7)
+            if (SymTable_remove(oClone, aacKeys[i]) == NULL)
+               ASSURE(SymTable_get(oClone, aacKeys[i]) == aacKeys[i]);
+         for (i = 1; i < iKeyCount; i += 7)
+            if (SymTable_replace(oClone, aacKeys[i], aacCopies[i])
+               == NULL)
+               ASSURE(SymTable_get(oClone, aacKeys[i]) == aacKeys[i]);
+         for (i = iKeyCount; i < 2 * iKeyCount; i += 7)
+            if (! SymTable_put(oClone, aacKeys[i], aacKeys[i]))
+               ASSURE(! SymTable_contains(oClone, aacKeys[i]));
+      }
+      ASSURE(SymTable_getLength(oSymTable) == (size_t)iKeyCount);
+      for (i = 0; i < 2 * iKeyCount; i++)
+         ASSURE(SymTable_get(oSymTable, aacKeys[i])
+            == (i < iKeyCount ? aacKeys[i] : NULL));
+
+      sPool.uLimit = (size_t)-1;
+      if (oClone != NULL)
+         SymTable_free(oClone);
+      SymTable_free(oSymTable);
+      ASSURE(sPool.uLive == 0);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTable_clone() function. */
+
+static void testClone(void)
+{
+   SymTable_T oSymTable;
+   SymTable_T oClone;
+   struct Point sPoint;
+   struct Point *psPoint;
+   void **ppvSlot;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_clone() function.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   /* A clone of an empty table must be an empty table of its own. */
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   oClone = SymTable_clone(oSymTable);
+   ASSURE(oClone != NULL);
+   ASSURE(SymTable_getLength(oClone) == 0);
+   iSuccessful = SymTable_put(oClone, "Ruth", "Ruth");
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_getLength(oSymTable) == 0);
+   ASSURE(! SymTable_contains(oSymTable, "Ruth"));
+   SymTable_free(oSymTable);
+   SymTable_free(oClone);
+
+   testCloneOf(5, (size_t)-1);
+   testCloneOf(3000, (size_t)-1);
+
+   /* Long chains stay long, with indexes, in a hash table whose
+      allocator refuses large blocks. */
+   testCloneOf(280, 1024);
+
+   /* The slot of a clone of an inline table must be its own. */
+   oSymTable = SymTable_newInline(sizeof(struct Point));
+   ASSURE(oSymTable != NULL);
+   sPoint.iX = 1;
+   sPoint.iY = 2;
+   sPoint.cTag = 'a';
+   iSuccessful = SymTable_put(oSymTable, "Ruth", &sPoint);
+   ASSURE(iSuccessful);
+   oClone = SymTable_clone(oSymTable);
+   ASSURE(oClone != NULL);
+   ppvSlot = SymTable_getOrInsert(oClone, "Ruth", NULL);
+   ASSURE(ppvSlot != NULL);
+   ((struct Point*)*ppvSlot)->iX = 5;
+   psPoint = (struct Point*)SymTable_get(oClone, "Ruth");
+   ASSURE(psPoint->iX == 5 && psPoint->iY == 2 && psPoint->cTag == 'a');
+   psPoint = (struct Point*)SymTable_get(oSymTable, "Ruth");
+   ASSURE(psPoint->iX == 1 && psPoint->iY == 2 && psPoint->cTag == 'a');
+   sPoint.iX = 9;
+   psPoint = (struct Point*)SymTable_replace(oSymTable, "Ruth", &sPoint);
+   ASSURE(psPoint->iX == 1);
+   psPoint = (struct Point*)SymTable_remove(oClone, "Ruth");
+   ASSURE(psPoint->iX == 5);
+   psPoint = (struct Point*)SymTable_get(oSymTable, "Ruth");
+   ASSURE(psPoint->iX == 9);
+   SymTable_free(oSymTable);
+   SymTable_free(oClone);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTable_newCompact() function with iKeyCount qualified
+   keys, which share a few prefixes, and keys that are not split. */
+
+static void testCompact(int iKeyCount)
+{
+   enum {MAX_KEY_COUNT = 3000, MAX_KEY_LENGTH = 40, LONG_KEY = 300,
+      ROUND_COUNT = 8};
+
+   SymTable_T oSymTable;
+   SymTable_T oClone;
+   static char aacKeys[MAX_KEY_COUNT][MAX_KEY_LENGTH];
+   static char aacCopies[MAX_KEY_COUNT][MAX_KEY_LENGTH];
+   char acLong[LONG_KEY + 1];
+   char acLongCopy[LONG_KEY + 1];
+   char acEmpty[] = "";
+   char acPlain[] = "plain";
+   char acSlash[] = "src/main.c";
+   char acNet[] = "net.x";
+   size_t uCount;
+   int iSuccessful;
+   int iRound;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_newCompact() function.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   assert(iKeyCount <= MAX_KEY_COUNT);
+
+   for (i = 0; i < iKeyCount; i++)
+   {
+      sprintf(aacKeys[i], "com.shop.module%d.Name%d", i % 7, i);
+      strcpy(aacCopies[i], aacKeys[i]);
+   }
+   for (i = 0; i < LONG_KEY; i++)
+      acLong[i] = (char)(i % 10 == 9 ? '.' : 'a' + i % 26);
+   acLong[LONG_KEY] = '\0';
+   strcpy(acLongCopy, acLong);
+
+   oSymTable = SymTable_newCompact();
+   ASSURE(oSymTable != NULL);
+   ASSURE(! SymTable_contains(oSymTable, aacKeys[0]));
+   ASSURE(SymTable_remove(oSymTable, aacKeys[0]) == NULL);
+
+   for (i = 0; i < iKeyCount; i++)
+   {
+      iSuccessful = SymTable_put(oSymTable, aacKeys[i], aacKeys[i]);
+      ASSURE(iSuccessful);
+   }
+   iSuccessful = SymTable_put(oSymTable, aacKeys[0], aacCopies[0]);
+   ASSURE(! iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, acEmpty, acEmpty);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, acPlain, acPlain);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, acSlash, acSlash);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, acLong, acLong);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_getLength(oSymTable) == (size_t)iKeyCount + 4);
+
+   /* Every key must be found by its characters alone, however it is
+      passed in. */
+   for (i = 0; i < iKeyCount; i++)
+   {
+      ASSURE(SymTable_get(oSymTable, aacCopies[i]) == aacKeys[i]);
+      ASSURE(SymTable_getWithHash(oSymTable, aacCopies[i],
+         SymTable_hashKey(aacCopies[i])) == aacKeys[i]);
+   }
+   ASSURE(SymTable_get(oSymTable, "") == acEmpty);
+   ASSURE(SymTable_get(oSymTable, "plain") == acPlain);
+   ASSURE(SymTable_get(oSymTable, "src/main.c") == acSlash);
+   ASSURE(SymTable_get(oSymTable, acLongCopy) == acLong);
+   ASSURE(SymTable_containsN(oSymTable, "src/main.cpp", 10));
+   ASSURE(! SymTable_containsN(oSymTable, "src/main.cpp", 11));
+   ASSURE(SymTable_getN(oSymTable, acLongCopy, LONG_KEY) == acLong);
+
+   /* Keys whose prefix no key has must miss. */
+   ASSURE(! SymTable_contains(oSymTable, "net.shop.module0.Name0"));
+   ASSURE(! SymTable_containsWithHash(oSymTable, "org.x",
+      SymTable_hashKey("org.x")));
+   ASSURE(SymTable_get(oSymTable, "com.shop.Name0") == NULL);
+   ASSURE(SymTable_replace(oSymTable, "com.Name0", acPlain) == NULL);
+   ASSURE(SymTable_remove(oSymTable, "src/Name0") == NULL);
+   ASSURE(SymTable_get(oSymTable, "com.shop.module0.Name1") == NULL);
+
+   /* The map functions must see every key whole. */
+   uCount = 0;
+   SymTable_map(oSymTable, countBinding, &uCount);
+   ASSURE(uCount == (size_t)iKeyCount + 4);
+   uCount = 0;
+   SymTable_mapParallel(oSymTable, countBinding, &uCount, 1);
+   ASSURE(uCount == (size_t)iKeyCount + 4);
+   uCount = 0;
+   SymTable_prefixMap(oSymTable, "com.shop.module1.", countBinding,
+      &uCount);
+   ASSURE(uCount == (size_t)(iKeyCount + 5) / 7);
+   uCount = 0;
+   SymTable_rangeMap(oSymTable, "com.shop.module6.", "plain",
+      countBinding, &uCount);
+   ASSURE(uCount == (size_t)(iKeyCount + 1) / 7);
+
+   /* Values must change in place. */
+   ASSURE(SymTable_replace(oSymTable, aacCopies[1], aacCopies[1])
+      == aacKeys[1]);
+   iSuccessful = SymTable_upsert(oSymTable, aacCopies[1], aacKeys[1]);
+   ASSURE(iSuccessful);
+   ASSURE(* SymTable_getOrInsert(oSymTable, aacCopies[1], NULL)
+      == aacKeys[1]);
+   ASSURE(SymTable_getLength(oSymTable) == (size_t)iKeyCount + 4);
+
+   /* A clone must keep its keys when the original drops them. */
+   oClone = SymTable_clone(oSymTable);
+   ASSURE(oClone != NULL);
+   for (i = 0; i < iKeyCount; i += 2)
+      ASSURE(SymTable_remove(oSymTable, aacCopies[i]) == aacKeys[i]);
+   ASSURE(SymTable_remove(oSymTable, acLongCopy) == acLong);
+   iSuccessful = SymTable_put(oClone, acNet, acNet);
+   ASSURE(iSuccessful);
+   ASSURE(! SymTable_contains(oSymTable, "net.x"));
+   SymTable_free(oSymTable);
+   for (i = 0; i < iKeyCount; i++)
+      ASSURE(SymTable_get(oClone, aacCopies[i]) == aacKeys[i]);
+   uCount = 0;
+   SymTable_map(oClone, countBinding, &uCount);
+   ASSURE(uCount == (size_t)iKeyCount + 5);
+   ASSURE(SymTable_remove(oClone, "net.x") == acNet);
+
+   /* Keys that come & go must not use up memory, and must survive
+      the table's store being packed. */
+   for (iRound = 0; iRound < ROUND_COUNT; iRound++)
+   {
+      for (i = 0; i < iKeyCount; i++)
+         ASSURE(SymTable_remove(oClone, aacCopies[i]) == aacKeys[i]);
+      ASSURE(SymTable_getLength(oClone) == 4);
+      for (i = 0; i < iKeyCount; i++)
+      {
+         iSuccessful = SymTable_put(oClone, aacKeys[i], aacKeys[i]);
+         ASSURE(iSuccessful);
+      }
+   }
+   for (i = 0; i < iKeyCount; i++)
+      ASSURE(SymTable_get(oClone, aacCopies[i]) == aacKeys[i]);
+   ASSURE(SymTable_get(oClone, acLongCopy) == acLong);
+   uCount = 0;
+   SymTable_map(oClone, countBinding, &uCount);
+   ASSURE(uCount == (size_t)iKeyCount + 4);
+   SymTable_free(oClone);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTable_addFilter() function with iKeyCount keys, and
+   as many keys that are never put. */
+
+static void testFilter(int iKeyCount)
+{
+   enum {MAX_KEY_COUNT = 3000, MAX_KEY_LENGTH = 10, ROUND_COUNT = 4};
+
+   SymTable_T oSymTable;
+   SymTable_T oClone;
+   struct Pool sPool;
+   static char aacKeys[MAX_KEY_COUNT][MAX_KEY_LENGTH];
+   static char aacMisses[MAX_KEY_COUNT][MAX_KEY_LENGTH];
+   int iSuccessful;
+   int iRound;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_addFilter() function.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   assert(iKeyCount <= MAX_KEY_COUNT);
+
+   for (i = 0; i < iKeyCount; i++)
+   {
+      sprintf(aacKeys[i], "%d", i);
+      sprintf(aacMisses[i], "x%d", i);
+   }
+
+   /* A filter added to an empty table must follow it as it grows. */
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   iSuccessful = SymTable_addFilter(oSymTable);
+   ASSURE(iSuccessful);
+   ASSURE(! SymTable_contains(oSymTable, aacKeys[0]));
+   for (i = 0; i < iKeyCount; i++)
+   {
+      iSuccessful = SymTable_put(oSymTable, aacKeys[i], aacKeys[i]);
+      ASSURE(iSuccessful);
+   }
+   iSuccessful = SymTable_addFilter(oSymTable);
+   ASSURE(iSuccessful);
+   for (i = 0; i < iKeyCount; i++)
+   {
+      ASSURE(SymTable_contains(oSymTable, aacKeys[i]));
+      ASSURE(SymTable_get(oSymTable, aacKeys[i]) == aacKeys[i]);
+      ASSURE(! SymTable_contains(oSymTable, aacMisses[i]));
+      ASSURE(SymTable_remove(oSymTable, aacMisses[i]) == NULL);
+   }
+
+   /* Keys that come & go must be found exactly while they are
+      there, however often the filter is built again. */
+   for (iRound = 0; iRound < ROUND_COUNT; iRound++)
+   {
+      for (i = iRound % 2; i < iKeyCount; i += 2)
+         ASSURE(SymTable_remove(oSymTable, aacKeys[i]) == aacKeys[i]);
+      for (i = 0; i < iKeyCount; i++)
+         ASSURE(SymTable_contains(oSymTable, aacKeys[i])
+            == (i % 2 != iRound % 2));
+      for (i = iRound % 2; i < iKeyCount; i += 2)
+      {
+         iSuccessful = SymTable_put(oSymTable, aacKeys[i], aacKeys[i]);
+         ASSURE(iSuccessful);
+      }
+   }
+   ASSURE(SymTable_getLength(oSymTable) == (size_t)iKeyCount);
+
+   /* A clone must share the filter without seeing the original's
+      keys, or showing its own to the original. */
+   oClone = SymTable_clone(oSymTable);
+   ASSURE(oClone != NULL);
+   for (i = 0; i < iKeyCount; i += 3)
+   {
+      iSuccessful = SymTable_put(oClone, aacMisses[i], aacMisses[i]);
+      ASSURE(iSuccessful);
+   }
+   for (i = 1; i < iKeyCount; i += 3)
+   {
+      iSuccessful = SymTable_put(oSymTable, aacMisses[i], aacMisses[i]);
+      ASSURE(iSuccessful);
+   }
+   for (i = 0; i < iKeyCount; i++)
+   {
+      ASSURE(SymTable_contains(oClone, aacMisses[i]) == (i % 3 == 0));
+      ASSURE(SymTable_contains(oSymTable, aacMisses[i])
+         == (i % 3 == 1));
+      ASSURE(SymTable_contains(oClone, aacKeys[i]));
+   }
+   SymTable_free(oSymTable);
+   SymTable_free(oClone);
+
+   /* A filter that there is no memory for must leave the table as it
+      was. */
+   sPool.uLive = 0;
+   sPool.uAllocated = 0;
+   sPool.uLimit = (size_t)-1;
+   sPool.uMaxSize = (size_t)-1;
+   oSymTable = SymTable_newWithAllocator(poolAlloc, poolFree, &sPool);
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < iKeyCount; i++)
+   {
+      iSuccessful = SymTable_put(oSymTable, aacKeys[i], aacKeys[i]);
+      ASSURE(iSuccessful);
+   }
+   sPool.uLimit = sPool.uAllocated;
+   (void)SymTable_addFilter(oSymTable);
+   sPool.uLimit = (size_t)-1;
+   for (i = 0; i < iKeyCount; i++)
+   {
+      ASSURE(SymTable_get(oSymTable, aacKeys[i]) == aacKeys[i]);
+      ASSURE(! SymTable_contains(oSymTable, aacMisses[i]));
+   }
+   SymTable_free(oSymTable);
+   ASSURE(sPool.uLive == 0);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTable_getFirst() function on a chain of tables of
+   every kind, which bind iKeyCount keys between them. */
+
+static void testGetFirst(int iKeyCount)
+{
+   enum {TABLE_COUNT = 5, MAX_KEY_COUNT = 3000, MAX_KEY_LENGTH = 20};
+
+   SymTable_T aoSymTables[TABLE_COUNT];
+   static char aacKeys[MAX_KEY_COUNT][MAX_KEY_LENGTH];
+   char acA[] = "a.x";
+   char acB[] = "b";
+   size_t uWhich;
+   int iSuccessful;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_getFirst() function.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   assert(iKeyCount <= MAX_KEY_COUNT);
+
+   /* No tables hold no keys. */
+   uWhich = 7;
+   ASSURE(SymTable_getFirst(NULL, 0, acA, &uWhich) == NULL);
+   ASSURE(uWhich == 0);
+
+   aoSymTables[0] = SymTable_new();
+   aoSymTables[1] = SymTable_newCompact();
+   aoSymTables[2] = SymTable_new();
+   ASSURE(aoSymTables[0] != NULL && aoSymTables[1] != NULL &&
+      aoSymTables[2] != NULL);
+   iSuccessful = SymTable_addFilter(aoSymTables[2]);
+   ASSURE(iSuccessful);
+
+   /* Key i is bound to itself in table i % 3, and table 2, with its
+      clone, binds every key. */
+   for (i = 0; i < iKeyCount; i++)
+   {
+      sprintf(aacKeys[i], "mod%d.sym%d", i % 11, i);
+      iSuccessful = SymTable_put(aoSymTables[i % 3], aacKeys[i],
+         aacKeys[i]);
+      ASSURE(iSuccessful);
+   }
+   for (i = 0; i < iKeyCount; i++)
+      if (i % 3 < 2)
+      {
+         iSuccessful = SymTable_put(aoSymTables[2], aacKeys[i], acB);
+         ASSURE(iSuccessful);
+      }
+   aoSymTables[3] = SymTable_clone(aoSymTables[2]);
+   aoSymTables[4] = SymTable_new();
+   ASSURE(aoSymTables[3] != NULL && aoSymTables[4] != NULL);
+   iSuccessful = SymTable_put(aoSymTables[4], acA, acA);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(aoSymTables[0], acB, NULL);
+   ASSURE(iSuccessful);
+
+   for (i = 0; i < iKeyCount; i++)
+   {
+      uWhich = TABLE_COUNT;
+      ASSURE(SymTable_getFirst(aoSymTables, TABLE_COUNT, aacKeys[i],
+         &uWhich) == aacKeys[i]);
+      ASSURE(uWhich == (size_t)(i % 3));
+      ASSURE(SymTable_getFirst(aoSymTables + 3, 2, aacKeys[i], &uWhich)
+         == (i % 3 == 2 ? aacKeys[i] : acB));
+      ASSURE(uWhich == 0);
+   }
+
+   /* A NULL value must be told from a missing key by *puWhich. */
+   ASSURE(SymTable_getFirst(aoSymTables, TABLE_COUNT, acB, &uWhich)
+      == NULL);
+   ASSURE(uWhich == 0);
+   ASSURE(SymTable_getFirst(aoSymTables, TABLE_COUNT, "mod0.none",
+      &uWhich) == NULL);
+   ASSURE(uWhich == TABLE_COUNT);
+   ASSURE(SymTable_getFirst(aoSymTables, TABLE_COUNT, "a.x", &uWhich)
+      == acA);
+   ASSURE(uWhich == 4);
+   ASSURE(SymTable_getFirst(aoSymTables, 4, "a.x", NULL) == NULL);
+
+   for (i = 0; i < TABLE_COUNT; i++)
+      SymTable_free(aoSymTables[i]);
+}
+
+/* Make the changes that testTxn() makes to oSymTable in a
+   transaction: of iKeyCount keys, of which the first half are bound,
+   bind the rest, rebind every fourth one to pcValue, unbind every
+   third one, and bind every sixth one again. If iMustSucceed, each
+   change must succeed; otherwise any may fail for lack of memory. */
+
+static void changeTable(SymTable_T oSymTable, int iKeyCount,
+   const char *pcValue, int iMustSucceed)
+{
+   enum {MAX_KEY_LENGTH = 10};
+
+   char acKey[MAX_KEY_LENGTH];
+   int iSuccessful;
+   int i;
+
+   for (i = iKeyCount / 2; i < iKeyCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, pcValue);
+      ASSURE(iSuccessful || ! iMustSucceed);
+   }
+   for (i = 0; i < iKeyCount; i += 4)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_replace(oSymTable, acKey, pcValue) != NULL;
+      ASSURE(iSuccessful || ! iMustSucceed);
+   }
+   for (i = 0; i < iKeyCount; i += 3)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_remove(oSymTable, acKey) != NULL;
+      ASSURE(iSuccessful || ! iMustSucceed);
+   }
+   for (i = 0; i < iKeyCount; i += 6)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_upsert(oSymTable, acKey, pcValue);
+      ASSURE(iSuccessful || ! iMustSucceed);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Check that oSymTable holds what changeTable() leaves in it if
+   iChanged, and otherwise the first half of iKeyCount keys, each
+   bound to pcOld. */
+
+static void checkTable(SymTable_T oSymTable, int iKeyCount,
+   const char *pcOld, const char *pcNew, int iChanged)
+{
+   enum {MAX_KEY_LENGTH = 10};
+
+   char acKey[MAX_KEY_LENGTH];
+   size_t uLength;
+   int i;
+
+   uLength = 0;
+   for (i = 0; i < iKeyCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      if (! iChanged)
+      {
+         ASSURE(SymTable_get(oSymTable, acKey)
+            == (i < iKeyCount / 2 ? pcOld : NULL));
+         ASSURE(SymTable_contains(oSymTable, acKey)
+            == (i < iKeyCount / 2));
+      }
+      else if (i % 3 == 0 && i % 6 != 0)
+         ASSURE(! SymTable_contains(oSymTable, acKey));
+      else
+         ASSURE(SymTable_get(oSymTable, acKey)
+            == (i < iKeyCount / 2 && i % 4 != 0 && i % 6 != 0 ?
+               pcOld : pcNew));
+      if (SymTable_contains(oSymTable, acKey))
+         uLength++;
+   }
+   ASSURE(SymTable_getLength(oSymTable) == uLength);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTable_beginTxn(), SymTable_commit(), and
+   SymTable_rollback() functions on tables of every kind, which bind
+   up to iKeyCount keys. */
+
+static void testTxn(int iKeyCount)
+{
+   enum {KIND_COUNT = 3, POOL_KEY_COUNT = 200, MAX_KEY_LENGTH = 10};
+
+   SymTable_T oSymTable;
+   struct Pool sPool;
+   struct Point sPoint;
+   struct Point *psPoint;
+   char acKey[MAX_KEY_LENGTH];
+   char acOld[] = "old";
+   char acNew[] = "new";
+   size_t uExtra;
+   int iSuccessful;
+   int iKind;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_beginTxn(), SymTable_commit(), and\n");
+   printf("SymTable_rollback() functions.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   /* A rollback must undo every change, which the transaction must
+      see while it is open, and a commit must keep them all. */
+   for (iKind = 0; iKind < KIND_COUNT; iKind++)
+   {
+      oSymTable = iKind == 1 ? SymTable_newCompact() : SymTable_new();
+      ASSURE(oSymTable != NULL);
+      if (iKind == 2)
+      {
+         iSuccessful = SymTable_addFilter(oSymTable);
+         ASSURE(iSuccessful);
+      }
+
+      iSuccessful = SymTable_beginTxn(oSymTable);
+      ASSURE(iSuccessful);
+      SymTable_rollback(oSymTable);
+      ASSURE(SymTable_getLength(oSymTable) == 0);
+
+      for (i = 0; i < iKeyCount / 2; i++)
+      {
+         sprintf(acKey, "%d", i);
+         iSuccessful = SymTable_put(oSymTable, acKey, acOld);
+         ASSURE(iSuccessful);
+      }
+      iSuccessful = SymTable_beginTxn(oSymTable);
+      ASSURE(iSuccessful);
+      changeTable(oSymTable, iKeyCount, acNew, 1);
+      checkTable(oSymTable, iKeyCount, acOld, acNew, 1);
+      SymTable_rollback(oSymTable);
+      checkTable(oSymTable, iKeyCount, acOld, acNew, 0);
+
+      iSuccessful = SymTable_beginTxn(oSymTable);
+      ASSURE(iSuccessful);
+      changeTable(oSymTable, iKeyCount, acNew, 1);
+      SymTable_commit(oSymTable);
+      checkTable(oSymTable, iKeyCount, acOld, acNew, 1);
+
+      /* A table freed in a transaction keeps nothing from it. */
+      iSuccessful = SymTable_beginTxn(oSymTable);
+      ASSURE(iSuccessful);
+      ASSURE(SymTable_remove(oSymTable, "1") == acOld);
+      SymTable_free(oSymTable);
+   }
+
+   /* A rollback must bring back the values of an inline table. */
+   oSymTable = SymTable_newInline(sizeof(struct Point));
+   ASSURE(oSymTable != NULL);
+   sPoint.cTag = 'a';
+   for (i = 0; i < iKeyCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      sPoint.iX = i;
+      sPoint.iY = -i;
+      iSuccessful = SymTable_put(oSymTable, acKey, &sPoint);
+      ASSURE(iSuccessful);
+   }
+   iSuccessful = SymTable_beginTxn(oSymTable);
+   ASSURE(iSuccessful);
+   sPoint.iX = 0;
+   sPoint.iY = 0;
+   sPoint.cTag = 'b';
+   for (i = 0; i < iKeyCount; i += 2)
+   {
+      sprintf(acKey, "%d", i);
+      psPoint = (struct Point*)SymTable_replace(oSymTable, acKey,
+         &sPoint);
+      ASSURE(psPoint != NULL && psPoint->iX == i);
+   }
+   for (i = 0; i < iKeyCount; i += 3)
+   {
+      sprintf(acKey, "%d", i);
+      psPoint = (struct Point*)SymTable_remove(oSymTable, acKey);
+      ASSURE(psPoint != NULL && psPoint->iY == (i % 2 == 0 ? 0 : -i));
+   }
+   SymTable_rollback(oSymTable);
+   ASSURE(SymTable_getLength(oSymTable) == (size_t)iKeyCount);
+   for (i = 0; i < iKeyCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      psPoint = (struct Point*)SymTable_get(oSymTable, acKey);
+      ASSURE(psPoint != NULL);
+      ASSURE(psPoint->iX == i && psPoint->iY == -i &&
+         psPoint->cTag == 'a');
+   }
+   SymTable_free(oSymTable);
+
+   /* Running out of memory during a transaction must leave changes
+      that can still all be rolled back, without any more memory, and
+      leaks nothing. */
+   for (uExtra = 0; uExtra < 60; uExtra++)
+   {
+      sPool.uLive = 0;
+      sPool.uAllocated = 0;
+      sPool.uLimit = (size_t)-1;
+      sPool.uMaxSize = (size_t)-1;
+      oSymTable = SymTable_newWithAllocator(poolAlloc, poolFree,
+         &sPool);
+      ASSURE(oSymTable != NULL);
+      for (i = 0; i < POOL_KEY_COUNT / 2; i++)
+      {
+         sprintf(acKey, "%d", i);
+         iSuccessful = SymTable_put(oSymTable, acKey, acOld);
+         ASSURE(iSuccessful);
+      }
+      sPool.uLimit = sPool.uAllocated + uExtra;
+      if (SymTable_beginTxn(oSymTable))
+      {
+         changeTable(oSymTable, POOL_KEY_COUNT, acNew, 0);
+         SymTable_rollback(oSymTable);
+      }
+      checkTable(oSymTable, POOL_KEY_COUNT, acOld, acNew, 0);
+      SymTable_free(oSymTable);
+      ASSURE(sPool.uLive == 0);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTable_dumpProfile() function. */
+
+static void testDumpProfile(void)
+{
+   SymTable_T oSymTable;
+   FILE *psFile;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_dumpProfile() function.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   /* Whether or not a profile is kept, the dump must say something,
+      and leave the tables as they were. */
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   iSuccessful = SymTable_put(oSymTable, "Ruth", "RF");
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_get(oSymTable, "Gehrig") == NULL);
+   psFile = tmpfile();
+   ASSURE(psFile != NULL);
+   SymTable_dumpProfile(psFile);
+   ASSURE(ftell(psFile) > 0);
+   ASSURE(fclose(psFile) == 0);
+   ASSURE(SymTable_getLength(oSymTable) == 1);
+   ASSURE(strcmp((char*)SymTable_get(oSymTable, "Ruth"), "RF") == 0);
    SymTable_free(oSymTable);
 }
 
@@ -951,9 +2719,25 @@ int main(int argc, char *argv[])
 
    testBasics();
    testKeyComparison();
+   testHashedKeys();
+   testLengthKeys();
+   testUpsert();
+   testAllocator();
+   testInline();
+   testLongChains();
+   testClone();
+   testCompact(3000);
+   testFilter(3000);
+   testGetFirst(3000);
+   testTxn(3000);
+   testDumpProfile();
+   testBuildParallel(4);
+   testLoad(iBindingCount);
    testKeyOwnership();
    testRemove();
    testMap();
+   testRangeMap();
+   testMapParallel(iBindingCount, 4);
    testEmptyTable();
    testEmptyKey();
    testNullValue();
@@ -0,0 +1,256 @@
+/*--------------------------------------------------------------------*/
+/* testsymtableprofile.c                                              */
+/* Author: Arnold Jiang                                               */
+/*--------------------------------------------------------------------*/
+
+#include "symtable.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+
+/*--------------------------------------------------------------------*/
+
+#define ASSURE(i) assure(i, __LINE__)
+
+/*--------------------------------------------------------------------*/
+
+enum {MAX_KEY_LENGTH = 16, MAX_LINE_LENGTH = 256};
+
+/* The calls that the profile reports for one operation. */
+
+struct Report
+{
+   unsigned long long ulCalls;
+   unsigned long long ulTimed;
+   unsigned long long ulP50;
+   unsigned long long ulP99;
+   unsigned long long ulP999;
+   unsigned long long ulMax;
+};
+
+/* What a worker thread looks up: iKeyCount keys of oSymTable, each
+   iRounds times. */
+
+struct Work
+{
+   SymTable_T oSymTable;
+   int iKeyCount;
+   int iRounds;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* If !iSuccessful, print a message to stdout indicating that the
+   test at line iLineNum failed. */
+
+static void assure(int iSuccessful, int iLineNum)
+{
+   if (! iSuccessful)
+   {
+      printf("Test at line %d failed.\n", iLineNum);
+      fflush(stdout);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Get every key of the Work that pvWork points to, in every round.
+   Return NULL. */
+
+static void *getKeys(void *pvWork)
+{
+   struct Work *psWork = (struct Work*)pvWork;
+   char acKey[MAX_KEY_LENGTH];
+   int iRound;
+   int i;
+
+   assert(psWork != NULL);
+
+   for (iRound = 0; iRound < psWork->iRounds; iRound++)
+      for (i = 0; i < psWork->iKeyCount; i++)
+      {
+         sprintf(acKey, "%d", i);
+         ASSURE(SymTable_get(psWork->oSymTable, acKey) != NULL);
+      }
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Read the line for operation pcName from the profile in psFile into
+   *psReport. Return 1 (TRUE) if there is such a line, and 0 (FALSE)
+   otherwise. */
+
+static int readReport(FILE *psFile, const char *pcName,
+   struct Report *psReport)
+{
+   char acLine[MAX_LINE_LENGTH];
+   char acName[MAX_LINE_LENGTH];
+
+   assert(psFile != NULL);
+   assert(pcName != NULL);
+   assert(psReport != NULL);
+
+   rewind(psFile);
+   while (fgets(acLine, sizeof(acLine), psFile) != NULL)
+   {
+      memset(psReport, 0, sizeof(*psReport));
+      if (sscanf(acLine, "%255s %llu %llu %llu %llu %llu %llu", acName,
+             &psReport->ulCalls, &psReport->ulTimed, &psReport->ulP50,
+             &psReport->ulP99, &psReport->ulP999, &psReport->ulMax) >= 2
+          && strcmp(acName, pcName) == 0)
+         return 1;
+   }
+   return 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of lines of the profile in psFile that begin
+   with pcPrefix. */
+
+static int countLines(FILE *psFile, const char *pcPrefix)
+{
+   char acLine[MAX_LINE_LENGTH];
+   int iCount = 0;
+
+   assert(psFile != NULL);
+   assert(pcPrefix != NULL);
+
+   rewind(psFile);
+   while (fgets(acLine, sizeof(acLine), psFile) != NULL)
+      if (strncmp(acLine, pcPrefix, strlen(pcPrefix)) == 0)
+         iCount++;
+   return iCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return how many of ulCalls calls that one thread makes of one
+   operation are timed: the first, and one in 64 after it. */
+
+static unsigned long long timedCalls(unsigned long long ulCalls)
+{
+   return (ulCalls + 63) / 64;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Check that *psReport reports ulCalls calls, of which ulTimed were
+   timed, and that their latencies are in order. */
+
+static void checkReport(const struct Report *psReport,
+   unsigned long long ulCalls, unsigned long long ulTimed)
+{
+   assert(psReport != NULL);
+
+   ASSURE(psReport->ulCalls == ulCalls);
+   ASSURE(psReport->ulTimed == ulTimed);
+   ASSURE(psReport->ulP50 <= psReport->ulP99);
+   ASSURE(psReport->ulP99 <= psReport->ulP999);
+   ASSURE(psReport->ulP999 <= psReport->ulMax);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the profile that SymTable_dumpProfile() writes, after
+   iKeyCount puts, and gets of each key from this thread and from
+   another one. */
+
+static void testProfile(int iKeyCount)
+{
+   enum {ROUND_COUNT = 3};
+
+   SymTable_T oSymTable;
+   struct Work sWork;
+   struct Report sReport;
+   pthread_t sThread;
+   FILE *psFile;
+   char acKey[MAX_KEY_LENGTH];
+   int iSuccessful;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_dumpProfile() function.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < iKeyCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, oSymTable);
+      ASSURE(iSuccessful);
+   }
+   for (i = 0; i < iKeyCount; i++)
+   {
+      sprintf(acKey, "x%d", i);
+      ASSURE(! SymTable_contains(oSymTable, acKey));
+   }
+
+   /* The gets of both threads must be counted together. */
+   sWork.oSymTable = oSymTable;
+   sWork.iKeyCount = iKeyCount;
+   sWork.iRounds = ROUND_COUNT;
+   ASSURE(pthread_create(&sThread, NULL, getKeys, &sWork) == 0);
+   ASSURE(pthread_join(sThread, NULL) == 0);
+   sWork.iRounds = 1;
+   (void)getKeys(&sWork);
+
+   psFile = tmpfile();
+   ASSURE(psFile != NULL);
+   SymTable_dumpProfile(psFile);
+
+   ASSURE(countLines(psFile, "SymTable profile of 2 thread(s)") == 1);
+   ASSURE(readReport(psFile, "put", &sReport));
+   checkReport(&sReport, (unsigned long long)iKeyCount,
+      timedCalls((unsigned long long)iKeyCount));
+   ASSURE(readReport(psFile, "contains", &sReport));
+   checkReport(&sReport, (unsigned long long)iKeyCount,
+      timedCalls((unsigned long long)iKeyCount));
+
+   /* Each thread samples its own calls. */
+   ASSURE(readReport(psFile, "get", &sReport));
+   checkReport(&sReport,
+      (unsigned long long)iKeyCount * (ROUND_COUNT + 1),
+      timedCalls((unsigned long long)iKeyCount * ROUND_COUNT) +
+      timedCalls((unsigned long long)iKeyCount));
+   ASSURE(! readReport(psFile, "remove", &sReport));
+
+   /* Growing to hold the keys resized the table, every time. */
+   ASSURE(readReport(psFile, "expand", &sReport));
+   ASSURE(sReport.ulCalls > 0 && sReport.ulTimed == sReport.ulCalls);
+   ASSURE(countLines(psFile, "resize to ") > 0);
+   ASSURE(countLines(psFile, "resize to ") <= 8);
+   ASSURE(countLines(psFile, "resize to ") <= (int)sReport.ulCalls);
+
+   ASSURE(fclose(psFile) == 0);
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+   int iKeyCount = 5000;
+
+   if (argc == 2 && sscanf(argv[1], "%d", &iKeyCount) != 1)
+   {
+      fprintf(stderr, "key count must be numeric\n");
+      exit(EXIT_FAILURE);
+   }
+   if (iKeyCount <= 0)
+   {
+      fprintf(stderr, "key count must be positive\n");
+      exit(EXIT_FAILURE);
+   }
+
+   testProfile(iKeyCount);
+
+   printf("------------------------------------------------------\n");
+   printf("End of %s.\n", argv[0]);
+   return 0;
+}
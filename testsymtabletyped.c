@@ -0,0 +1,290 @@
+/*--------------------------------------------------------------------*/
+/* testsymtabletyped.c                                                */
+/* Author: Arnold Jiang                                               */
+/*--------------------------------------------------------------------*/
+
+#include "symtabletyped.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+/*--------------------------------------------------------------------*/
+
+#define ASSURE(i) assure(i, __LINE__)
+
+/*--------------------------------------------------------------------*/
+
+/* A Point is a value that the tables below store inside themselves. */
+
+struct Point
+{
+   int iX;
+   int iY;
+};
+
+/* A hash function that sends every key to the same slot, so that
+   every binding of a table collides with every other. */
+
+#define collideAll(uKey) ((size_t)((uKey) & 0) + 42)
+
+/* A table of Points keyed by integer IDs, one of Points keyed by
+   strings, and one of IDs whose keys all collide. */
+
+SYMTABLE_DEFINE(IdTable, unsigned long, struct Point,
+   SymTable_hashInteger, SymTable_equalIntegers);
+SYMTABLE_DEFINE(NameTable, const char *, int, SymTable_hashText,
+   SymTable_equalText);
+SYMTABLE_DEFINE(CollisionTable, unsigned long, unsigned long,
+   collideAll, SymTable_equalIntegers);
+
+/*--------------------------------------------------------------------*/
+
+/* If !iSuccessful, print a message to stdout indicating that the
+   test at line iLineNum failed. */
+
+static void assure(int iSuccessful, int iLineNum)
+{
+   if (! iSuccessful)
+   {
+      printf("Test at line %d failed.\n", iLineNum);
+      fflush(stdout);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add the iX of the Point that psPoint points to, and 1, to the two
+   longs that pvExtra points to. uKey is unused. */
+
+static void sumPoint(unsigned long uKey, struct Point *psPoint,
+   void *pvExtra)
+{
+   long *plSums = (long*)pvExtra;
+
+   assert(psPoint != NULL);
+   assert(pvExtra != NULL);
+   (void)uKey;
+
+   plSums[0] += psPoint->iX;
+   plSums[1]++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Double the int that piValue points to. pcKey and pvExtra are
+   unused. */
+
+static void doubleValue(const char *pcKey, int *piValue, void *pvExtra)
+{
+   assert(pcKey != NULL);
+   assert(piValue != NULL);
+   (void)pvExtra;
+
+   *piValue *= 2;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the functions that SYMTABLE_DEFINE() defines, with string
+   keys. */
+
+static void testNames(void)
+{
+   NameTable_T oNameTable;
+   char acRuth[] = "Ruth";
+   char acGehrig[] = "Gehrig";
+   char acCopy[] = "Ruth";
+   int *piValue;
+   int iValue;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a table with string keys.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oNameTable = NameTable_new();
+   ASSURE(oNameTable != NULL);
+   ASSURE(NameTable_getLength(oNameTable) == 0);
+   ASSURE(NameTable_get(oNameTable, acRuth) == NULL);
+   ASSURE(! NameTable_remove(oNameTable, acRuth, &iValue));
+
+   iSuccessful = NameTable_put(oNameTable, acRuth, 3);
+   ASSURE(iSuccessful);
+   iSuccessful = NameTable_put(oNameTable, acGehrig, 4);
+   ASSURE(iSuccessful);
+   ASSURE(NameTable_getLength(oNameTable) == 2);
+
+   /* Keys are compared by their characters, not their addresses. */
+   iSuccessful = NameTable_put(oNameTable, acCopy, 5);
+   ASSURE(! iSuccessful);
+   piValue = NameTable_get(oNameTable, acCopy);
+   ASSURE(piValue != NULL && *piValue == 3);
+   ASSURE(NameTable_contains(oNameTable, "Gehrig"));
+   ASSURE(! NameTable_contains(oNameTable, "Mantle"));
+
+   /* A value may be changed where it is stored. */
+   *piValue = 7;
+   NameTable_map(oNameTable, doubleValue, NULL);
+   ASSURE(*NameTable_get(oNameTable, acRuth) == 14);
+   ASSURE(*NameTable_get(oNameTable, acGehrig) == 8);
+
+   iValue = 0;
+   ASSURE(NameTable_remove(oNameTable, "Ruth", &iValue));
+   ASSURE(iValue == 14);
+   ASSURE(! NameTable_contains(oNameTable, acRuth));
+   ASSURE(NameTable_remove(oNameTable, acGehrig, NULL));
+   ASSURE(NameTable_getLength(oNameTable) == 0);
+
+   NameTable_free(oNameTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the functions that SYMTABLE_DEFINE() defines, with iKeyCount
+   integer keys. */
+
+static void testIds(int iKeyCount)
+{
+   IdTable_T oIdTable;
+   struct Point sPoint;
+   struct Point *psPoint;
+   long alSums[2];
+   long lExpected;
+   int iSuccessful;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a table with integer keys.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oIdTable = IdTable_new();
+   ASSURE(oIdTable != NULL);
+
+   /* Keys that are multiples of a power of two must still spread. */
+   for (i = 0; i < iKeyCount; i++)
+   {
+      sPoint.iX = i;
+      sPoint.iY = -i;
+      iSuccessful = IdTable_put(oIdTable, (unsigned long)i << 12,
+         sPoint);
+      ASSURE(iSuccessful);
+   }
+   ASSURE(IdTable_getLength(oIdTable) == (size_t)iKeyCount);
+   for (i = 0; i < iKeyCount; i++)
+   {
+      psPoint = IdTable_get(oIdTable, (unsigned long)i << 12);
+      ASSURE(psPoint != NULL);
+      ASSURE(psPoint->iX == i && psPoint->iY == -i);
+      ASSURE(! IdTable_contains(oIdTable, ((unsigned long)i << 12) + 1));
+   }
+
+   /* Removing every other key must leave the rest reachable. */
+   for (i = 0; i < iKeyCount; i += 2)
+   {
+      sPoint.iX = -1;
+      ASSURE(IdTable_remove(oIdTable, (unsigned long)i << 12, &sPoint));
+      ASSURE(sPoint.iX == i);
+   }
+   lExpected = 0;
+   for (i = 0; i < iKeyCount; i++)
+   {
+      psPoint = IdTable_get(oIdTable, (unsigned long)i << 12);
+      if (i % 2 == 0)
+         ASSURE(psPoint == NULL);
+      else
+      {
+         ASSURE(psPoint != NULL && psPoint->iX == i);
+         lExpected += i;
+      }
+   }
+   alSums[0] = 0;
+   alSums[1] = 0;
+   IdTable_map(oIdTable, sumPoint, alSums);
+   ASSURE(alSums[0] == lExpected);
+   ASSURE(alSums[1] == (long)IdTable_getLength(oIdTable));
+   ASSURE(IdTable_getLength(oIdTable) == (size_t)(iKeyCount / 2));
+
+   IdTable_free(oIdTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test removals from a table of iKeyCount keys that all collide, in
+   an order that leaves gaps all through their run of slots. */
+
+static void testCollisions(int iKeyCount)
+{
+   CollisionTable_T oCollisionTable;
+   unsigned long uValue;
+   int iSuccessful;
+   int iRound;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a table whose keys all collide.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oCollisionTable = CollisionTable_new();
+   ASSURE(oCollisionTable != NULL);
+   for (i = 0; i < iKeyCount; i++)
+   {
+      iSuccessful = CollisionTable_put(oCollisionTable,
+         (unsigned long)i, (unsigned long)i * 3);
+      ASSURE(iSuccessful);
+   }
+
+   /* Each round removes the keys that are 0 modulo a prime, and puts
+      them back. */
+   for (iRound = 2; iRound < 8; iRound++)
+   {
+      for (i = 0; i < iKeyCount; i += iRound)
+      {
+         uValue = 0;
+         ASSURE(CollisionTable_remove(oCollisionTable,
+            (unsigned long)i, &uValue));
+         ASSURE(uValue == (unsigned long)i * 3);
+      }
+      for (i = 0; i < iKeyCount; i++)
+         ASSURE(CollisionTable_contains(oCollisionTable,
+            (unsigned long)i) == (i % iRound != 0));
+      for (i = 0; i < iKeyCount; i += iRound)
+      {
+         iSuccessful = CollisionTable_put(oCollisionTable,
+            (unsigned long)i, (unsigned long)i * 3);
+         ASSURE(iSuccessful);
+      }
+   }
+   ASSURE(CollisionTable_getLength(oCollisionTable) ==
+      (size_t)iKeyCount);
+   for (i = iKeyCount - 1; i >= 0; i--)
+      ASSURE(CollisionTable_remove(oCollisionTable, (unsigned long)i,
+         NULL));
+   ASSURE(CollisionTable_getLength(oCollisionTable) == 0);
+
+   CollisionTable_free(oCollisionTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+   int iKeyCount = 100000;
+
+   if (argc == 2 && sscanf(argv[1], "%d", &iKeyCount) != 1)
+   {
+      fprintf(stderr, "key count must be numeric\n");
+      exit(EXIT_FAILURE);
+   }
+
+   testNames();
+   testIds(iKeyCount);
+   testCollisions(iKeyCount < 1000 ? iKeyCount : 1000);
+
+   printf("------------------------------------------------------\n");
+   printf("End of %s.\n", argv[0]);
+   return 0;
+}